@@ -2,7 +2,7 @@ from ctypes import *
 from collections import OrderedDict
 from json import dumps
 from copy import deepcopy
-from numpy import copyto
+from numpy import copyto, array, frombuffer, uint32, uint64, float32, int32
 from numpy.ctypeslib import as_array
 
 """ Wrapper for C Array Structure """
@@ -148,8 +148,22 @@ _syn.get_connection_data.argtypes = (c_void_p, c_char_p, c_char_p)
 _syn.get_weight_matrix.restype = CArray
 _syn.get_weight_matrix.argtypes = (c_void_p, c_char_p, c_char_p)
 
+_syn.estimate_memory.restype = c_void_p
+_syn.estimate_memory.argtypes = (c_void_p, c_void_p)
+_syn.get_memory_report.restype = c_void_p
+_syn.get_memory_report.argtypes = (c_void_p,)
+_syn.estimate_partition.restype = c_void_p
+_syn.estimate_partition.argtypes = (c_void_p, c_int, c_bool)
+_syn.get_partition_report.restype = c_void_p
+_syn.get_partition_report.argtypes = (c_void_p, c_int)
+
 _syn.run.restype = c_void_p
 _syn.run.argtypes = (c_void_p, c_void_p, c_void_p, c_void_p)
+_syn.open_session.restype = c_void_p
+_syn.open_session.argtypes = (c_void_p, c_void_p, c_void_p, c_void_p)
+_syn.step_session.restype = c_void_p
+_syn.step_session.argtypes = (c_void_p, c_void_p)
+_syn.close_session.argtypes = (c_void_p,)
 
 _syn.destroy.argtypes = (c_void_p,)
 _syn.destroy_network.argtypes = (c_void_p,)
@@ -170,6 +184,8 @@ _syn.add_weight_callback.argtypes = (c_char_p, c_longlong)
 _syn.add_indices_weight_callback.argtypes = (c_char_p, c_longlong)
 _syn.add_distance_weight_callback.argtypes = (c_char_p, c_longlong)
 _syn.add_delay_weight_callback.argtypes = (c_char_p, c_longlong)
+_syn.get_io_view.restype = CArray
+_syn.get_io_view.argtypes = (c_char_p, c_int, c_char_p)
 
 _syn.get_mpi_rank.restype = c_int
 _syn.get_mpi_size.restype = c_int
@@ -490,6 +506,29 @@ class Network:
                 connection.encode('utf-8'),
                 key.encode('utf-8')))
 
+    def estimate_memory(self, environment=None):
+        report = _syn.estimate_memory(self.obj,
+            None if environment is None else environment.obj)
+        if report is None: print("Failed to estimate memory!")
+        return Properties(report)
+
+    def estimate_partition(self, num_devices, refine=True):
+        report = _syn.estimate_partition(self.obj, num_devices, refine)
+        if report is None: print("Failed to estimate partition!")
+        return Properties(report)
+
+    def get_partition_report(self, num_devices):
+        if self.state is None: self.build_state()
+        report = _syn.get_partition_report(self.state, num_devices)
+        if report is None: print("Failed to get partition report!")
+        return Properties(report)
+
+    def get_memory_report(self):
+        if self.state is None: self.build_state()
+        report = _syn.get_memory_report(self.state)
+        if report is None: print("Failed to get memory report!")
+        return Properties(report)
+
     def run(self, environment, args=dict()):
         # Build state
         if self.state is None: self.build_state()
@@ -506,6 +545,141 @@ class Network:
         if report is None: print("Failed to run network!")
         return Properties(report)
 
+    def open_session(self, environment, args=dict()):
+        return Session(self, environment, args)
+
+
+""" Session Wrapper
+Keeps the engine built between runs, for drivers that run many short steps.
+Step args override the session args (eg. iterations, learning flag).
+Pass "rebuild" to rebuild the engine and thread pool (eg. after editing
+the environment).  The network state is kept, so network edits need a
+new session.
+Sessions close when used as a context manager, or when collected. """
+class Session:
+    def __init__(self, network, environment, args=dict()):
+        self.obj = None
+
+        # Build state
+        if network.state is None: network.build_state()
+
+        # Build environment
+        if not isinstance(environment, Environment):
+            environment = Environment(environment)
+
+        # Build args
+        if not isinstance(args, Properties):
+            args = Properties(args)
+
+        # Keep the network and environment alive with the session
+        self.network = network
+        self.environment = environment
+        self.obj = _syn.open_session(
+            network.obj, environment.obj, network.state, args.obj)
+        if self.obj is None: print("Failed to open session!")
+
+    def step(self, args=dict()):
+        if not isinstance(args, Properties):
+            args = Properties(args)
+
+        report = _syn.step_session(self.obj, args.obj)
+        if report is None: print("Failed to step session!")
+        return Properties(report)
+
+    def close(self):
+        if _syn is not None and self.obj is not None:
+            _syn.close_session(self.obj)
+        self.obj = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+        return False
+
+    def __del__(self):
+        self.close()
+
+
+""" Output Recording Reader
+Reads a trace written by the record_output module.
+Returns a dictionary mapping (structure, layer) to a dictionary with:
+  "iterations": module iteration of each frame
+  "frames": 2D array of outputs, typed by output type, or a list of
+            spike index arrays if spikes were recorded
+  "rows", "columns"
+Traces without an index (eg. from an interrupted process) are read
+sequentially up to the last complete frame. """
+def read_recording(filename):
+    with open(filename, "rb") as f:
+        data = f.read()
+
+    if data[:8] != b"SYNREC1\0":
+        raise ValueError("Not an output recording: " + filename)
+
+    def word(offset):
+        return int(frombuffer(data, dtype=uint32, count=1, offset=offset)[0])
+
+    def string(offset):
+        length = word(offset)
+        return data[offset+4:offset+4+length].decode(), offset + 4 + length
+
+    # Header
+    layers = []
+    offset = 12
+    for i in range(word(8)):
+        structure, offset = string(offset)
+        layer, offset = string(offset)
+        rows, columns, output_type, spikes = \
+            [word(offset + 4*j) for j in range(4)]
+        offset += 16
+        layers.append({
+            "key" : (structure, layer),
+            "rows" : rows,
+            "columns" : columns,
+            "dtype" : float32 if output_type == 0 else
+                (uint32 if output_type == 1 else int32),
+            "spikes" : spikes == 1 })
+
+    # Frame offsets from the index, or by scanning
+    if len(data) >= 24 and data[-8:] == b"SYNIDX1\0":
+        index_offset, num_frames = frombuffer(data, dtype=uint64,
+            count=2, offset=len(data)-24)
+        offsets = frombuffer(data, dtype=uint64,
+            count=int(num_frames), offset=int(index_offset))
+        end = int(index_offset)
+    else:
+        offsets = []
+        end = len(data)
+        while offset + 12 <= end and offset + 12 + 4*word(offset+8) <= end:
+            offsets.append(offset)
+            offset += 12 + 4*word(offset+8)
+
+    # Gather frames by layer
+    recording = OrderedDict()
+    frames = [[] for l in layers]
+    iterations = [[] for l in layers]
+    for offset in offsets:
+        offset = int(offset)
+        index, iteration, count = [word(offset + 4*j) for j in range(3)]
+        l = layers[index]
+        frames[index].append(frombuffer(data,
+            dtype=uint32 if l["spikes"] else l["dtype"],
+            count=count, offset=offset+12))
+        iterations[index].append(iteration)
+
+    for l, f, i in zip(layers, frames, iterations):
+        if not l["spikes"]:
+            f = array(f, dtype=l["dtype"]).reshape(
+                (len(f), l["rows"] * l["columns"]))
+        recording[l["key"]] = {
+            "iterations" : array(i, dtype=uint32),
+            "frames" : f,
+            "rows" : l["rows"],
+            "columns" : l["columns"] }
+    return recording
+
 
 def fill_in(defaults, props):
     new_props = deepcopy(props)
@@ -564,45 +738,81 @@ class ConnectionFactory(PropertiesFactory):
 
 
 """ Callback module builders """
-def make_custom_input_module(structure, layer_names, name, cb, clear=True):
+def get_io_view(name, ID, key, batch=1):
+    """ Wraps a stable callback module view as a NumPy array
+    Batched views are shaped (batch, layer size) """
+    arr = _syn.get_io_view(name.encode('utf-8'), ID, key.encode('utf-8'))
+    if arr.size == 0:
+        return None
+    view = FloatArray(arr.size, arr.data).to_np_array()
+    return view if batch == 1 else view.reshape((batch, -1))
+
+def make_custom_input_module(structure, layer_names, name, cb,
+        clear=True, batch=1, key="input"):
+    """ Auxiliary input keys (eg. for dendrites) are set with |key| """
+    views = dict()
 
     def custom_callback(ID, size, ptr):
-        cb(layer_names[ID], FloatArray(size,ptr).to_np_array())
+        # Views are rebuilt with the engine, so check the address
+        if (ID, key) not in views or views[(ID, key)][0] != ptr:
+            views[(ID, key)] = (ptr, get_io_view(name, ID, key, batch))
+        cb(layer_names[ID], views[(ID, key)][1])
 
     create_io_callback(name, custom_callback)
 
+    layers = [
+        {
+            "structure" : structure,
+            "layer" : layer_name,
+            "input" : True,
+            "function" : name,
+            "id" : i
+        } for i,layer_name in enumerate(layer_names)
+    ]
+    if key != "input":
+        for layer in layers: layer["input keys"] = [key]
+
     return {
         "type" : "callback",
         "clear" : clear,
-        "layers" : [
-            {
-                "structure" : structure,
-                "layer" : layer_name,
-                "input" : True,
-                "function" : name,
-                "id" : i
-            } for i,layer_name in enumerate(layer_names)
-        ]
+        "batch" : batch,
+        "layers" : layers
     }
 
-def make_custom_output_module(structure, layer_names, name, cb):
+def make_custom_output_module(structure, layer_names, name, cb,
+        batch=1, key="output"):
+    """ Auxiliary output keys (eg. layer state) are read with |key| """
+    views = dict()
 
     def custom_callback(ID, size, ptr):
-        cb(layer_names[ID], FloatArray(size,ptr).to_np_array())
+        # Views are rebuilt with the engine, so check the address
+        if (ID, key) not in views or views[(ID, key)][0] != ptr:
+            views[(ID, key)] = (ptr, get_io_view(name, ID, key, batch))
+        view = views[(ID, key)][1]
+
+        # The final batch of a run may be partially filled
+        if batch > 1 and size < view.size:
+            view = view[:size // view.shape[1]]
+        cb(layer_names[ID], view)
 
     create_io_callback(name, custom_callback)
 
+    layers = [
+        {
+            "structure" : structure,
+            "layer" : layer_name,
+            "output" : True,
+            "function" : name,
+            "id" : i
+        } for i,layer_name in enumerate(layer_names)
+    ]
+    if key != "output":
+        for layer in layers: layer["output keys"] = [key]
+
     return {
         "type" : "callback",
-        "layers" : [
-            {
-                "structure" : structure,
-                "layer" : layer_name,
-                "output" : True,
-                "function" : name,
-                "id" : i
-            } for i,layer_name in enumerate(layer_names)
-        ]
+        "batch" : batch,
+        "layers" : layers
     }
 
 
@@ -0,0 +1,155 @@
+from syngen import Network, Environment, get_cpu
+from syngen import get_mpi_size, get_mpi_rank
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks that overlapped and compressed MPI transfers match blocking mode
+# Each rank drives a rate layer and a spiking (BIT) layer, and sends both
+#   to the other rank, where ghost copies drive receiving layers
+# Run with: mpirun -np 2 python mpi_overlap_test.py
+
+iterations = 50
+
+def build_network(rank, other):
+    name = "s%d" % rank
+    layers = [
+        { "name" : "r", "neural model" : "rate_encoding",
+          "rows" : 10, "columns" : 10 },
+        { "name" : "a", "neural model" : "izhikevich",
+          "rows" : 20, "columns" : 20 },
+        { "name" : "recv_r", "neural model" : "relay",
+          "rows" : 10, "columns" : 10 },
+        { "name" : "recv_a", "neural model" : "izhikevich",
+          "rows" : 20, "columns" : 20 },
+    ]
+
+    # Ghost copies of the other rank's sending layers
+    ghost_layers = []
+    for l in layers[:2]:
+        gl = dict(l)
+        gl["name"] = "s%d_%s" % (other, l["name"])
+        gl["ghost"] = True
+        ghost_layers.append(gl)
+
+    connections = [
+        {
+            "from structure" : "ghost",
+            "from layer" : "s%d_r" % other,
+            "to structure" : name,
+            "to layer" : "recv_r",
+            "type" : "one to one",
+            "opcode" : "add",
+            "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 1.0 }
+        },
+        {
+            "from structure" : "ghost",
+            "from layer" : "s%d_a" % other,
+            "to structure" : name,
+            "to layer" : "recv_a",
+            "type" : "one to one",
+            "opcode" : "add",
+            "direct" : True,
+            "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 100.0 }
+        },
+    ]
+
+    return Network(
+        {"structures" : [
+            {"name" : name, "type" : "parallel", "layers" : layers},
+            {"name" : "ghost", "type" : "parallel", "layers" : ghost_layers}],
+         "connections" : connections})
+
+def run(rank, other, overlap, compress):
+    name = "s%d" % rank
+    network = build_network(rank, other)
+
+    # Seeded inputs, so that every mode sees the same stimuli
+    rng = np.random.RandomState(rank)
+    def input_callback(layer_name, view):
+        if layer_name == "r":
+            view[:] = rng.uniform(0.0, 1.0, view.size)
+        else:
+            view[:] = (rng.uniform(0.0, 1.0, view.size) < 0.1) * 30.0
+
+    outputs = dict()
+    def output_callback(layer_name, view):
+        outputs.setdefault(layer_name, []).append(
+            np.array(view, copy=True).view(np.uint32))
+
+    modules = [
+        make_custom_input_module(name, ["r", "a"],
+            "mpi_test_input", input_callback),
+        make_custom_output_module(name, ["r", "a", "recv_r", "recv_a"],
+            "mpi_test_output", output_callback),
+        {
+            "type" : "mpi lockstep",
+            "overlap" : overlap,
+            "compress" : compress,
+            "layers" : [
+                {
+                    "structure" : "ghost",
+                    "layer" : "s%d_%s" % (other, l),
+                    "input" : True,
+                    "mpi source" : other,
+                    "mpi tag" : 2 * other + i,
+                } for i,l in enumerate(["r", "a"])
+            ] + [
+                {
+                    "structure" : name,
+                    "layer" : l,
+                    "output" : True,
+                    "mpi destinations" : [other],
+                    "mpi tag" : 2 * rank + i,
+                } for i,l in enumerate(["r", "a"])
+            ]
+        }
+    ]
+
+    env = Environment({"modules" : modules})
+    report = network.run(env, {"devices" : get_cpu(),
+                               "iterations" : iterations})
+    if report is None:
+        print("Engine failure.  Exiting...")
+        sys.exit(1)
+
+    del network
+    del env
+    return outputs
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    if get_mpi_size() != 2:
+        print("Run with: mpirun -np 2 python mpi_overlap_test.py")
+        sys.exit(1)
+
+    rank = get_mpi_rank()
+    other = 1 - rank
+
+    blocking = run(rank, other, False, False)
+    spikes = sum(int((x >> 31).sum()) for x in blocking["recv_a"])
+    if spikes == 0:
+        print("Rank %d: no spikes were received!" % rank)
+        sys.exit(1)
+
+    failed = False
+    for overlap, compress in [(True, False), (False, True), (True, True)]:
+        outputs = run(rank, other, overlap, compress)
+        for layer, frames in blocking.items():
+            same = len(frames) == len(outputs[layer]) and all(
+                np.array_equal(a, b) for a,b in zip(frames, outputs[layer]))
+            if not same:
+                print("Rank %d: %s differs (overlap=%s, compress=%s)"
+                    % (rank, layer, overlap, compress))
+                failed = True
+
+    if failed: sys.exit(1)
+    print("Rank %d: overlapped and compressed outputs match (%d spikes)"
+        % (rank, spikes))
@@ -119,7 +119,8 @@ def build_environment(structures, visualizer=False):
 def main(infile=None, outfile=None,
         visualizer=False, refresh_rate=0, device=None,
         iterations=1000000, worker_threads=4,
-        engine_multithreading=True, mode="all_4k"):
+        engine_multithreading=True, mode="all_4k",
+        mpi_overlap=False, mpi_compress=False):
 
     print("Mode: %s" % mode)
     if mode == "all_4k":
@@ -278,6 +279,8 @@ def main(infile=None, outfile=None,
     if len(from_ghosts) > 0 or len(to_ghosts) > 0:
         modules.append({
             "type" : "mpi lockstep",
+            "overlap" : mpi_overlap,
+            "compress" : mpi_compress,
             "layers" : [
                 {
                     "structure" : "ghost",
@@ -361,6 +364,10 @@ if __name__ == "__main__":
                         help='engine multithreading')
     parser.add_argument('-m', type=str, default="all_4k",
                         help='mode')
+    parser.add_argument('-overlap', action='store_true', default=False,
+                        help='overlap MPI receives with computation')
+    parser.add_argument('-compress', action='store_true', default=False,
+                        help='send spiking outputs as compressed spike lists')
     args = parser.parse_args()
 
     if args.host and args.gpus:
@@ -378,4 +385,5 @@ if __name__ == "__main__":
     set_warnings(False)
     set_debug(False)
 
-    main(args.i, args.o, args.visualizer, args.r, device, args.it, args.w, args.e, args.m)
+    main(args.i, args.o, args.visualizer, args.r, device, args.it, args.w, args.e, args.m,
+        args.overlap, args.compress)
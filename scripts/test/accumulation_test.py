@@ -0,0 +1,88 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks that output accumulation between environment iterations is the
+#   same for the single threaded and multithreaded engine loops
+# Each session starts with a step whose output is suppressed, which must
+#   not leave anything accumulated for the following step
+
+# Step args persist in the session, so each step sets suppression
+environment_rate = 4
+steps = [ { "iterations" : 6, "suppress output" : True },
+          { "iterations" : 18, "suppress output" : False },
+          { "iterations" : 7, "suppress output" : True },
+          { "iterations" : 13, "suppress output" : False } ]
+
+def run(accumulation, multithreaded):
+    network = Network(
+        {"structures" : [{"name" : "acc", "type" : "parallel",
+            "layers" : [
+                { "name" : "drive", "neural model" : "relay",
+                  "rows" : 10, "columns" : 10 },
+                { "name" : "spiking", "neural model" : "izhikevich",
+                  "rows" : 10, "columns" : 10 }]}],
+         "connections" : [{
+            "from layer" : "drive",
+            "to layer" : "spiking",
+            "type" : "one to one",
+            "opcode" : "add",
+            "direct" : True,
+            "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 20.0 }}]})
+
+    rng = np.random.RandomState(0)
+    def input_callback(layer_name, view):
+        view[:] = rng.uniform(0.0, 1.0, view.size)
+
+    outputs = dict()
+    def output_callback(layer_name, view):
+        outputs.setdefault(layer_name, []).append(np.array(view, copy=True))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("acc", ["drive"],
+            "acc_test_input", input_callback),
+        make_custom_output_module("acc", ["drive", "spiking"],
+            "acc_test_output", output_callback)]})
+
+    session = network.open_session(env, {
+        "devices" : get_cpu(),
+        "multithreaded" : multithreaded,
+        "environment rate" : environment_rate,
+        "output accumulation" : accumulation })
+    for step in steps:
+        session.step(step)
+    session.close()
+
+    del network
+    del env
+    return outputs
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for accumulation in ["none", "sum", "average", "count"]:
+        single = run(accumulation, False)
+        multi = run(accumulation, True)
+
+        if len(single.get("spiking", [])) == 0:
+            print("%s: no output was reported!" % accumulation)
+            failed = True
+            continue
+
+        for layer, frames in single.items():
+            same = len(frames) == len(multi.get(layer, [])) and all(
+                np.array_equal(a, b) for a,b in zip(frames, multi[layer]))
+            if not same:
+                print("%s: %s differs between engine loops"
+                    % (accumulation, layer))
+                failed = True
+
+    if failed: sys.exit(1)
+    print("Accumulated outputs match between engine loops")
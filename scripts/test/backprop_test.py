@@ -0,0 +1,132 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks backprop weight updates against a numpy reference
+# A two layer network is trained on random inputs and targets, with and
+#   without minibatches, and its weights are compared to the same updates
+#   computed in numpy.  Only fully connected connections on the host support
+#   backprop learning.
+
+iterations = 24
+learning_rate = 0.1
+sizes = { "in" : 6, "hidden" : 5, "out" : 3 }
+
+def activation(x):
+    return np.where(x > 0.0, np.tanh(x), 0.0)
+
+def reference(weights, inputs, targets, batch_size):
+    w1, w2 = [w.astype(np.float64) for w in weights]
+    batch = []
+    for x, target in zip(inputs, targets):
+        h = activation(w1.dot(x))
+        y = activation(w2.dot(h))
+
+        d_out = np.where(y > 0.0, (target - y) * (1.0 - y * y), 0.0)
+        d_hidden = np.where(h > 0.0, w2.T.dot(d_out) * (1.0 - h * h), 0.0)
+        batch.append((x, h, d_hidden, d_out))
+
+        if len(batch) == batch_size:
+            scale = learning_rate / batch_size
+            w2 += scale * sum(np.outer(d, s) for _, s, _, d in batch)
+            w1 += scale * sum(np.outer(d, s) for s, _, d, _ in batch)
+            batch = []
+    return w1, w2
+
+def run(weights, inputs, targets, batch_size):
+    def connection(name, src, dest, w):
+        return {
+            "name" : name,
+            "from layer" : src,
+            "to layer" : dest,
+            "type" : "fully connected",
+            "opcode" : "add",
+            "plastic" : True,
+            "learning rate" : learning_rate,
+            "batch size" : batch_size,
+            "weight config" : {
+                "type" : "specified",
+                "weight string" : " ".join(str(x) for x in w.flatten()) }
+        }
+
+    network = Network(
+        {"structures" : [{"name" : "bp", "type" : "feedforward",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 1, "columns" : sizes["in"] },
+                { "name" : "hidden", "neural model" : "backprop_rate_encoding",
+                  "rows" : 1, "columns" : sizes["hidden"] },
+                { "name" : "out", "neural model" : "backprop_rate_encoding",
+                  "rows" : 1, "columns" : sizes["out"] }]}],
+         "connections" : [
+            connection("in_hidden", "in", "hidden", weights[0]),
+            connection("hidden_out", "hidden", "out", weights[1])]})
+
+    state = { "input" : 0, "targets" : 0 }
+    def input_callback(layer_name, view):
+        view[:] = inputs[state["input"]]
+        state["input"] += 1
+    def target_callback(layer_name, view):
+        view[:] = targets[state["targets"]]
+        state["targets"] += 1
+
+    env = Environment({"modules" : [
+        make_custom_input_module("bp", ["in"],
+            "bp_test_input", input_callback),
+        make_custom_input_module("bp", ["out"],
+            "bp_test_targets", target_callback, key="targets")]})
+
+    network.run(env, {"devices" : get_cpu(),
+                      "iterations" : iterations})
+
+    trained = [
+        np.array(network.get_weight_matrix(name).to_np_array(), copy=True)
+            .reshape(sizes[dest], sizes[src])
+        for name, src, dest in [("in_hidden", "in", "hidden"),
+                                ("hidden_out", "hidden", "out")]]
+
+    del network
+    del env
+    return trained, state["input"]
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    rng = np.random.RandomState(0)
+    weights = [
+        rng.uniform(-0.3, 0.6, (sizes["hidden"], sizes["in"])),
+        rng.uniform(-0.3, 0.6, (sizes["out"], sizes["hidden"]))]
+    weights = [w.astype(np.float32) for w in weights]
+    inputs = rng.uniform(0.0, 1.0, (iterations, sizes["in"]))
+    targets = rng.uniform(0.0, 0.9, (iterations, sizes["out"]))
+    inputs = inputs.astype(np.float32)
+    targets = targets.astype(np.float32)
+
+    failed = False
+    for batch_size in [1, 4]:
+        trained, steps = run(weights, inputs, targets, batch_size)
+        expected = reference(weights, inputs, targets, batch_size)
+
+        if steps != iterations:
+            print("batch %d: ran %d of %d iterations"
+                % (batch_size, steps, iterations))
+            failed = True
+            continue
+
+        for name, w, t, e in zip(["in_hidden", "hidden_out"],
+                weights, trained, expected):
+            error = np.abs(t - e).max()
+            print("batch %d %-10s max change %8.5f, max error %g"
+                % (batch_size, name, np.abs(e - w).max(), error))
+            if np.abs(e - w).max() < 1e-3 or not np.allclose(
+                    t, e, rtol=1e-4, atol=1e-5):
+                print("  Weights do not match the reference!")
+                failed = True
+
+    if failed: sys.exit(1)
+    print("Backprop weight updates match numpy reference")
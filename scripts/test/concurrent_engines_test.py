@@ -0,0 +1,141 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import time
+import threading
+import numpy as np
+
+# Checks that engines running concurrently in one process match their
+#   sequential runs
+# Three different networks run in Python threads, each with its own seeded
+#   inputs, and their outputs and learned weights must be the same as when
+#   each network runs alone.
+
+iterations = 200
+
+def build(index):
+    name = "conc%d" % index
+    structure = "parallel"
+    if index == 0:
+        structure = "feedforward"
+        layers = [
+            { "name" : "in", "neural model" : "relay",
+              "rows" : 8, "columns" : 8 },
+            { "name" : "out", "neural model" : "backprop_rate_encoding",
+              "rows" : 6, "columns" : 6 }]
+        connection = { "type" : "fully connected", "plastic" : True,
+            "learning rate" : 0.01,
+            "weight config" : { "type" : "flat", "weight" : 0.01 }}
+    elif index == 1:
+        layers = [
+            { "name" : "in", "neural model" : "relay",
+              "rows" : 16, "columns" : 16 },
+            { "name" : "out", "neural model" : "izhikevich",
+              "rows" : 16, "columns" : 16 }]
+        connection = { "type" : "convergent", "plastic" : False,
+            "direct" : True,
+            "arborized config" : { "field size" : 3, "stride" : 1 },
+            "weight config" : { "type" : "flat", "weight" : 5.0 }}
+    else:
+        layers = [
+            { "name" : "in", "neural model" : "relay",
+              "rows" : 12, "columns" : 12 },
+            { "name" : "out", "neural model" : "rate_encoding",
+              "rows" : 12, "columns" : 12 }]
+        connection = { "type" : "one to one", "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 1.0 }}
+
+    connection = dict(connection, name="%s_conn" % name,
+        opcode="add", **{ "from layer" : "in", "to layer" : "out" })
+    network = Network(
+        {"structures" : [{"name" : name, "type" : structure,
+                          "layers" : layers}],
+         "connections" : [connection]})
+    return network, name
+
+def run(index, results):
+    network, name = build(index)
+
+    rng = np.random.RandomState(index)
+    def input_callback(layer_name, view):
+        view[:] = rng.uniform(0.0, 4.0, view.size)
+
+    outputs = []
+    def output_callback(layer_name, view):
+        outputs.append(np.array(view, copy=True))
+
+    # Callback names are process-wide, so each engine registers its own
+    modules = [
+        make_custom_input_module(name, ["in"],
+            "%s_input" % name, input_callback),
+        make_custom_output_module(name, ["out"],
+            "%s_output" % name, output_callback)]
+
+    # The learning network is trained toward seeded targets
+    if index == 0:
+        targets = np.random.RandomState(10)
+        def target_callback(layer_name, view):
+            view[:] = targets.uniform(0.0, 0.9, view.size)
+        modules.append(make_custom_input_module(name, ["out"],
+            "%s_targets" % name, target_callback, key="targets"))
+
+    env = Environment({"modules" : modules})
+
+    start = time.time()
+    network.run(env, {"devices" : get_cpu(),
+                      "multithreaded" : index != 2,
+                      "iterations" : iterations})
+    span = (start, time.time())
+
+    weights = np.array(network.get_weight_matrix(
+        "%s_conn" % name).to_np_array(), copy=True)
+    results[index] = (np.array(outputs), weights, span)
+
+    del network
+    del env
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    sequential = dict()
+    for index in range(3):
+        run(index, sequential)
+
+    concurrent = dict()
+    threads = [threading.Thread(target=run, args=(index, concurrent))
+        for index in range(3)]
+    for thread in threads: thread.start()
+    for thread in threads: thread.join()
+
+    failed = False
+    spans = [concurrent[i][2] for i in concurrent]
+    if len(spans) == 3 and max(s[0] for s in spans) >= min(s[1] for s in spans):
+        print("Engines did not run at the same time!")
+        failed = True
+
+    for index in range(3):
+        if index not in concurrent:
+            print("Engine %d did not finish!" % index)
+            failed = True
+            continue
+
+        outputs, weights, _ = sequential[index]
+        if outputs.shape[0] != iterations or not outputs.any():
+            print("Engine %d produced no output!" % index)
+            failed = True
+        if index == 0 and np.all(weights == weights[0]):
+            print("Engine %d did not learn!" % index)
+            failed = True
+        if not np.array_equal(outputs, concurrent[index][0]):
+            print("Engine %d outputs differ when run concurrently!" % index)
+            failed = True
+        if not np.array_equal(weights, concurrent[index][1]):
+            print("Engine %d weights differ when run concurrently!" % index)
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Concurrent engines match their sequential runs")
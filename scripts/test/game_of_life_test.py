@@ -0,0 +1,97 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks game_of_life layers on known patterns
+# A blinker and a glider are seeded through the input on the first
+#   iteration, and every following board must match numpy.  The neighborhood
+#   includes the cell itself, so Conway's rules survive on 3-4 live cells.
+#   The glider crosses the 64 cell words of the bit parallel counter, and
+#   both the bit parallel and generic kernels are checked.
+
+iterations = 40
+
+def step(board):
+    count = sum(np.roll(np.roll(board, dr, 0), dc, 1)
+        for dr in [-1, 0, 1] for dc in [-1, 0, 1])
+    return np.where(board, (count >= 3) & (count <= 4), count == 3)
+
+def reference(initial):
+    boards = [initial]
+    for _ in range(iterations - 1):
+        boards.append(step(boards[-1]))
+    return np.array(boards)
+
+def run(initial, bit_parallel):
+    rows, columns = initial.shape
+    network = Network(
+        {"structures" : [{"name" : "life", "type" : "parallel",
+            "layers" : [{ "name" : "board", "neural model" : "game_of_life",
+                "rows" : rows, "columns" : columns,
+                "survival_min" : 3, "survival_max" : 4,
+                "birth_min" : 3, "birth_max" : 3,
+                "bit parallel" : bit_parallel }]}],
+         "connections" : [{
+            "from layer" : "board", "to layer" : "board",
+            "type" : "convergent", "opcode" : "add", "plastic" : False,
+            "arborized config" : { "field size" : 3, "stride" : 1,
+                                   "wrap" : True },
+            "weight config" : { "type" : "flat", "weight" : 1.0 }}]})
+
+    # Live cells are born from the seeded input
+    state = { "step" : 0 }
+    def input_callback(layer_name, view):
+        view[:] = (initial.flatten() * 3.0) if state["step"] == 0 else 0.0
+        state["step"] += 1
+
+    boards = []
+    def output_callback(layer_name, view):
+        words = np.array(view, copy=True).view(np.uint32)
+        boards.append((words >> 31).reshape(rows, columns).astype(bool))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("life", ["board"],
+            "life_test_input", input_callback),
+        make_custom_output_module("life", ["board"],
+            "life_test_output", output_callback)]})
+
+    network.run(env, {"devices" : get_cpu(), "iterations" : iterations})
+    del network
+    del env
+    return np.array(boards)
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    blinker = np.zeros((8, 8), dtype=bool)
+    blinker[3, 2:5] = True
+
+    glider = np.zeros((12, 80), dtype=bool)
+    glider[1, 61] = glider[2, 62] = True
+    glider[3, 60:63] = True
+
+    failed = False
+    for name, initial in [("blinker", blinker), ("glider", glider)]:
+        expected = reference(initial)
+        for bit_parallel in [True, False]:
+            boards = run(initial, bit_parallel)
+            if boards.shape != expected.shape:
+                print("%s: expected %d boards, got %d"
+                    % (name, len(expected), len(boards)))
+                failed = True
+                continue
+
+            wrong = [i for i in range(iterations)
+                if not np.array_equal(boards[i], expected[i])]
+            if wrong:
+                print("%s (bit parallel %s): board %d differs"
+                    % (name, bit_parallel, wrong[0]))
+                failed = True
+
+    if failed: sys.exit(1)
+    print("Game of life patterns match numpy")
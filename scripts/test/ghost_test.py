@@ -0,0 +1,85 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks ghost layers for every output type
+# Ghost inputs hold the raw output words of the source layer, as sent by the
+#   MPI modules.  Feeding a ghost layer the words of a source layer must
+#   reproduce the source outputs, including bit histories.
+
+iterations = 80
+neurons = 32
+
+def run(layers, inputs):
+    network = Network(
+        {"structures" : [{"name" : "gh", "type" : "parallel",
+            "layers" : [dict(layer, rows=1, columns=neurons)
+                for layer in layers]}],
+         "connections" : []})
+    names = [layer["name"] for layer in layers]
+
+    step = { name : 0 for name in names }
+    def input_callback(layer_name, view):
+        view[:] = inputs[layer_name][step[layer_name]]
+        step[layer_name] += 1
+
+    outputs = dict()
+    def output_callback(layer_name, view):
+        outputs.setdefault(layer_name, []).append(
+            np.array(view, copy=True).view(np.uint32))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("gh", names,
+            "ghost_test_input", input_callback),
+        make_custom_output_module("gh", names,
+            "ghost_test_output", output_callback)]})
+
+    network.run(env, {"devices" : get_cpu(),
+                      "iterations" : iterations})
+    del network
+    del env
+    return { name : np.array(frames) for name, frames in outputs.items() }
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    rng = np.random.RandomState(0)
+
+    # Source layers (FLOAT and BIT outputs)
+    source = run(
+        [{ "name" : "float", "neural model" : "relay" },
+         { "name" : "bit", "neural model" : "izhikevich" }],
+        { "float" : rng.uniform(-1.0, 1.0, (iterations, neurons)),
+          "bit" : (rng.uniform(0.0, 1.0, (iterations, neurons)) < 0.2) * 30.0 })
+
+    if not (source["bit"] >> 31).any():
+        print("Source layer did not spike!")
+        sys.exit(1)
+
+    # No neural model has INT outputs, so ghost ints get arbitrary words
+    ints = rng.randint(-2**31, 2**31, (iterations, neurons)).astype(np.int32)
+
+    # Ghost copies receive the source words, reinterpreted as floats
+    ghosts = run(
+        [{ "name" : "float", "neural model" : "relay", "ghost" : True },
+         { "name" : "bit", "neural model" : "izhikevich", "ghost" : True },
+         { "name" : "int", "neural model" : "ghost int", "ghost" : True }],
+        { "float" : source["float"].view(np.float32),
+          "bit" : source["bit"].view(np.float32),
+          "int" : ints.view(np.float32) })
+
+    failed = False
+    expected = dict(source, int=ints.view(np.uint32))
+    for name, words in expected.items():
+        received = ghosts.get(name, np.zeros(0))
+        if received.shape != words.shape or not np.array_equal(received, words):
+            print("Ghost %s outputs differ from the source!" % name)
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Ghost layers reproduce float, bit and int outputs")
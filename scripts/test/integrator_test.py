@@ -0,0 +1,112 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks that the exponential integrator stays close to Euler integration
+# The same izhikevich layer is driven with the same noisy currents under
+#   both integrators, and firing rates and spike timing are compared
+
+iterations = 2000
+neurons = 100
+
+# Tolerances, relative to the Euler statistics
+rate_tolerance = 0.1
+first_spike_tolerance = 2.0
+isi_tolerance = 0.1
+
+def run(integrator, params):
+    network = Network(
+        {"structures" : [{"name" : "iz", "type" : "parallel",
+            "layers" : [{
+                "name" : "pop",
+                "neural model" : "izhikevich",
+                "params" : params,
+                "integrator" : integrator,
+                "rows" : 1, "columns" : neurons }]}],
+         "connections" : []})
+
+    # Neurons receive increasing mean currents plus seeded noise
+    rng = np.random.RandomState(0)
+    means = np.linspace(2.0, 20.0, neurons).astype(np.float32)
+    def input_callback(layer_name, view):
+        view[:] = means + rng.normal(0.0, 2.0, neurons)
+
+    spikes = []
+    def output_callback(layer_name, view):
+        spikes.append(np.array(view, copy=True).view(np.uint32) >> 31)
+
+    env = Environment({"modules" : [
+        make_custom_input_module("iz", ["pop"],
+            "iz_test_input", input_callback),
+        make_custom_output_module("iz", ["pop"],
+            "iz_test_output", output_callback)]})
+
+    report = network.run(env, {"devices" : get_cpu(),
+                               "iterations" : iterations})
+    if report is None:
+        print("Engine failure.  Exiting...")
+        sys.exit(1)
+
+    del network
+    del env
+    return np.array(spikes).reshape(iterations, neurons)
+
+def statistics(spikes):
+    rates = spikes.sum(axis=0) * 1000.0 / iterations
+
+    # First spike time and mean inter-spike interval of each spiking neuron
+    first = []
+    isis = []
+    for n in range(neurons):
+        times = np.nonzero(spikes[:,n])[0]
+        if len(times) > 0: first.append(times[0])
+        if len(times) > 1: isis.append(np.diff(times).mean())
+    return rates, np.array(first), np.array(isis)
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for params in ["regular", "fast", "bursting"]:
+        euler_rates, euler_first, euler_isis = \
+            statistics(run("euler", params))
+        exp_rates, exp_first, exp_isis = \
+            statistics(run("exponential", params))
+
+        if euler_rates.sum() == 0:
+            print("%s: no spikes were produced!" % params)
+            failed = True
+            continue
+
+        rate_error = abs(exp_rates.mean() - euler_rates.mean()) \
+            / euler_rates.mean()
+        first_error = abs(exp_first.mean() - euler_first.mean())
+        isi_error = abs(exp_isis.mean() - euler_isis.mean()) \
+            / euler_isis.mean()
+
+        print("%-8s rate %6.2f / %6.2f Hz (%5.3f), "
+              "first spike %6.2f / %6.2f ms, ISI %6.2f / %6.2f ms (%5.3f)"
+            % (params, euler_rates.mean(), exp_rates.mean(), rate_error,
+               euler_first.mean(), exp_first.mean(),
+               euler_isis.mean(), exp_isis.mean(), isi_error))
+
+        if len(exp_first) != len(euler_first):
+            print("  Number of spiking neurons differs!")
+            failed = True
+        if rate_error > rate_tolerance:
+            print("  Firing rates exceed tolerance!")
+            failed = True
+        if first_error > first_spike_tolerance:
+            print("  First spike times exceed tolerance!")
+            failed = True
+        if isi_error > isi_tolerance:
+            print("  Inter-spike intervals exceed tolerance!")
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Exponential integrator matches Euler within tolerance")
@@ -0,0 +1,123 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks the packed izhikevich neuron parameters
+# A layer mixing two neuron classes must spike exactly like separate layers
+#   of each class driven by the same currents, its per-neuron parameters must
+#   remain available, and edits to them must reach the kernel.
+
+iterations = 200
+neurons = 64
+
+regular = [0.02, 0.2, -65.0, 8.0]
+fast = [0.1, 0.2, -65.0, 2.0]
+
+def build(layers):
+    return Network(
+        {"structures" : [{"name" : "iz", "type" : "parallel",
+            "layers" : [{ "name" : name, "neural model" : "izhikevich",
+                          "params" : params,
+                          "rows" : 1, "columns" : neurons }
+                        for name, params in layers]}],
+         "connections" : []})
+
+def run(network, names):
+    # Every layer receives the same seeded currents
+    means = np.linspace(2.0, 20.0, neurons).astype(np.float32)
+    rngs = { name : np.random.RandomState(0) for name in names }
+    def input_callback(layer_name, view):
+        view[:] = means + rngs[layer_name].normal(0.0, 2.0, neurons)
+
+    spikes = dict()
+    def output_callback(layer_name, view):
+        spikes.setdefault(layer_name, []).append(
+            np.array(view, copy=True).view(np.uint32) >> 31)
+
+    env = Environment({"modules" : [
+        make_custom_input_module("iz", names,
+            "iz_params_input", input_callback),
+        make_custom_output_module("iz", names,
+            "iz_params_output", output_callback)]})
+
+    network.run(env, {"devices" : get_cpu(),
+                      "iterations" : iterations})
+    del env
+    return { name : np.array(spikes.get(name, []))
+        for name in names }
+
+def get_params(network, layer):
+    return np.array([
+        network.get_neuron_data("iz", layer, key).to_np_array()
+        for key in ["a", "b", "c", "d"]]).T
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+
+    # Reference layers of a single class
+    network = build([("regular", "regular"), ("fast", "fast")])
+    initial = { key : np.array(
+        network.get_neuron_data("iz", "fast", key).to_np_array(), copy=True)
+        for key in ["voltage", "recovery"] }
+    reference = run(network, ["regular", "fast"])
+    del network
+    if reference["regular"].size == 0 or not reference["regular"].any():
+        print("Reference layers did not spike!")
+        sys.exit(1)
+
+    # Mixed layer, split by class
+    network = build([("mixed", "regular:0.5, fast:0.5")])
+    params = get_params(network, "mixed")
+    is_fast = np.all(np.isclose(params, fast), axis=1)
+    is_regular = np.all(np.isclose(params, regular), axis=1)
+    types = network.get_neuron_data("iz", "mixed", "neuron type").to_np_array()
+
+    if not np.all(is_fast | is_regular) or is_fast.all() or is_regular.all():
+        print("Mixed layer parameters are not split between classes!")
+        failed = True
+    if len(set(types)) != 2 or not np.all(
+            (types == types[is_fast][0]) == is_fast):
+        print("Mixed layer neuron types do not match classes!")
+        failed = True
+
+    mixed = run(network, ["mixed"])["mixed"]
+    expected = np.where(is_fast, reference["fast"], reference["regular"])
+    if mixed.shape != expected.shape or not np.array_equal(mixed, expected):
+        print("Mixed layer does not match single class layers!")
+        failed = True
+
+    del network
+
+    # Edited parameters must reach the kernel
+    # The initial state depends on the parameters, so it is edited as well
+    network = build([("mixed", "regular:0.5, fast:0.5")])
+    for i, key in enumerate(["a", "b", "c", "d"]):
+        network.get_neuron_data("iz", "mixed", key).copy_from(
+            np.full(neurons, fast[i], dtype=np.float32))
+    for key, values in initial.items():
+        network.get_neuron_data("iz", "mixed", key).copy_from(values)
+    edited = run(network, ["mixed"])["mixed"]
+    types = network.get_neuron_data("iz", "mixed", "neuron type").to_np_array()
+    if np.any(types != 0) or not np.array_equal(edited, reference["fast"]):
+        print("Edited parameters were not repacked!")
+        failed = True
+    del network
+
+    # Randomized layers give every neuron its own type
+    network = build([("random", "random negative")])
+    spikes = run(network, ["random"])["random"]
+    types = network.get_neuron_data("iz", "random", "neuron type").to_np_array()
+    if not np.array_equal(types, np.arange(neurons)) or not spikes.any():
+        print("Randomized layer was not packed per neuron!")
+        failed = True
+    del network
+
+    if failed: sys.exit(1)
+    print("Packed izhikevich parameters match per-class layers")
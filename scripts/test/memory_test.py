@@ -0,0 +1,92 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+
+# Checks memory estimates against the built state
+# Layer and connection entries must match the memory report exactly, and the
+#   engine buffer estimate must match the size reported by a run.
+
+def build():
+    network = Network(
+        {"structures" : [{"name" : "mem", "type" : "parallel",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 12, "columns" : 12 },
+                { "name" : "iz", "neural model" : "izhikevich",
+                  "rows" : 12, "columns" : 12 },
+                { "name" : "mixed", "neural model" : "izhikevich",
+                  "params" : "regular:0.8, fast:0.2",
+                  "rows" : 8, "columns" : 8 },
+                { "name" : "rate", "neural model" : "rate_encoding",
+                  "rows" : 10, "columns" : 10 }]}],
+         "connections" : [
+            { "from layer" : "in", "to layer" : "iz",
+              "type" : "convergent",
+              "arborized config" : { "field size" : 3, "stride" : 1 },
+              "opcode" : "add", "plastic" : True,
+              "weight config" : { "type" : "flat", "weight" : 0.5 }},
+            { "from layer" : "iz", "to layer" : "mixed",
+              "type" : "fully connected",
+              "opcode" : "add", "plastic" : True,
+              "weight config" : { "type" : "flat", "weight" : 0.5 }},
+            { "from layer" : "in", "to layer" : "rate",
+              "type" : "fully connected",
+              "opcode" : "add", "plastic" : False,
+              "weight config" : { "type" : "flat", "weight" : 0.1 }}]})
+
+    env = Environment({"modules" : [
+        make_custom_input_module("mem", ["in"],
+            "mem_test_input", lambda name, view: None),
+        make_custom_output_module("mem", ["iz", "rate"],
+            "mem_test_output", lambda name, view: None)]})
+    return network, env
+
+def compare(kind, estimates, reports, key_fields):
+    # Reports also list the device of each entry
+    failed = False
+    for estimate, report in zip(estimates, reports):
+        report = { k : v for k,v in report.items() if k != "device" }
+        name = " ".join(estimate[k] for k in key_fields)
+        if estimate != report:
+            print("%s %s estimate differs:" % (kind, name))
+            for k in sorted(set(estimate) | set(report)):
+                if estimate.get(k) != report.get(k):
+                    print("  %s: %s / %s" % (k, estimate.get(k), report.get(k)))
+            failed = True
+    if len(estimates) != len(reports):
+        print("%s counts differ!" % kind)
+        failed = True
+    return failed
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    network, env = build()
+    estimate = network.estimate_memory(env)
+    report = network.get_memory_report()
+
+    failed = compare("Layer",
+        [e.properties for e in estimate.child_arrays["layers"]],
+        [r.properties for r in report.child_arrays["layers"]],
+        ["structure", "layer"])
+    failed |= compare("Connection",
+        [e.properties for e in estimate.child_arrays["connections"]],
+        [r.properties for r in report.child_arrays["connections"]],
+        ["connection"])
+
+    run = network.run(env, {"devices" : get_cpu(), "iterations" : 1})
+    engine_buffer = run.properties.get("engine buffer bytes")
+    if estimate.properties.get("engine buffer") != engine_buffer:
+        print("Engine buffer estimate %s differs from %s"
+            % (estimate.properties.get("engine buffer"), engine_buffer))
+        failed = True
+
+    del network
+    del env
+
+    if failed: sys.exit(1)
+    print("Memory estimates match the built state")
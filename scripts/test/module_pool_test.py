@@ -0,0 +1,123 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import shutil
+import tempfile
+import numpy as np
+from os import path
+
+# Checks that environment modules produce the same results whether they
+#   run sequentially or concurrently on the module pool
+# Layers are driven by a mix of CSV, periodic, and callback modules, some of
+#   which are thread safe, and every layer is read by its own output module
+
+iterations = 40
+dim = 8
+num_rows = 10
+
+def write_csv(filename, rng):
+    data = rng.uniform(0.0, 1.0, (num_rows, dim * dim))
+    np.savetxt(filename, data, delimiter=",", fmt="%.6f")
+
+def run(data_path, io_threads):
+    names = ["csv", "csv_slow", "cb", "cb_safe", "cyclic", "relay"]
+    layers = [{ "name" : name, "neural model" : "relay",
+                "rows" : dim, "columns" : dim } for name in names]
+    connections = [{
+        "from layer" : "csv",
+        "to layer" : "relay",
+        "type" : "one to one",
+        "opcode" : "add",
+        "plastic" : False,
+        "weight config" : { "type" : "flat", "weight" : 1.0 }
+    }]
+    network = Network(
+        {"structures" : [{"name" : "pool", "type" : "parallel",
+                          "layers" : layers}],
+         "connections" : connections})
+
+    # Each callback has its own seeded generator
+    rngs = { "cb" : np.random.RandomState(0),
+             "cb_safe" : np.random.RandomState(1) }
+    def input_callback(layer_name, view):
+        view[:] = rngs[layer_name].uniform(0.0, 1.0, view.size)
+
+    outputs = dict()
+    def output_callback(layer_name, view):
+        outputs.setdefault(layer_name, []).append(np.array(view, copy=True))
+
+    cb_input = make_custom_input_module("pool", ["cb"],
+        "pool_test_input", input_callback)
+    cb_safe_input = make_custom_input_module("pool", ["cb_safe"],
+        "pool_test_safe_input", input_callback)
+    cb_safe_input["thread safe"] = True
+
+    modules = [
+        { "type" : "csv_input",
+          "filename" : path.join(data_path, "input.csv"),
+          "layers" : [{ "structure" : "pool", "layer" : "csv" }] },
+        { "type" : "csv_input",
+          "filename" : path.join(data_path, "slow.csv"),
+          "exposure" : 3,
+          "layers" : [{ "structure" : "pool", "layer" : "csv_slow" }] },
+        cb_input,
+        cb_safe_input,
+        { "type" : "one_hot_cyclic_input",
+          "layers" : [{ "structure" : "pool", "layer" : "cyclic" }] },
+    ]
+
+    # One output module per layer, so that each can run on its own
+    for i,name in enumerate(names):
+        module = make_custom_output_module("pool", [name],
+            "pool_test_output_%d" % i, output_callback)
+        module["thread safe"] = (i % 2 == 0)
+        modules.append(module)
+
+    env = Environment({"modules" : modules})
+    report = network.run(env, {"devices" : get_cpu(),
+                               "io threads" : io_threads,
+                               "iterations" : iterations})
+    if report is None:
+        print("Engine failure.  Exiting...")
+        sys.exit(1)
+
+    del network
+    del env
+    return outputs
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    data_path = tempfile.mkdtemp()
+    try:
+        rng = np.random.RandomState(2)
+        write_csv(path.join(data_path, "input.csv"), rng)
+        write_csv(path.join(data_path, "slow.csv"), rng)
+
+        expected = run(data_path, 0)
+
+        failed = False
+        if len(expected) != 6 or any(
+                len(frames) != iterations for frames in expected.values()):
+            print("Sequential run did not report every layer!")
+            failed = True
+
+        for trial in range(3):
+            outputs = run(data_path, 4)
+            for layer, frames in expected.items():
+                same = len(frames) == len(outputs[layer]) and all(
+                    np.array_equal(a, b)
+                    for a,b in zip(frames, outputs[layer]))
+                if not same:
+                    print("Trial %d: %s differs from sequential run"
+                        % (trial, layer))
+                    failed = True
+    finally:
+        shutil.rmtree(data_path)
+
+    if failed: sys.exit(1)
+    print("Concurrent module outputs match sequential run")
@@ -0,0 +1,103 @@
+from syngen import Network
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+
+# Checks that the layer partitioner never needs more inter-device transfers
+#   than the original greedy assignment or a round-robin assignment
+# Transfers are counted as the instructions an engine would build for a state
+#   on virtual devices, so this runs without multiple GPUs
+
+def build_network(round_robin=None):
+    # A chain of layers with skip connections, and a second parallel chain
+    #   that only meets the first at the end
+    layers = []
+    for chain in ["a", "b"]:
+        for i in range(6):
+            layers.append({
+                "name" : "%s%d" % (chain, i),
+                "neural model" : "relay",
+                "rows" : 10 * (i % 3 + 1),
+                "columns" : 10 })
+    layers.append({
+        "name" : "out", "neural model" : "relay", "rows" : 10, "columns" : 10 })
+
+    # Round-robin baseline pins each layer to a device
+    if round_robin is not None:
+        for i,layer in enumerate(layers):
+            layer["device"] = i % round_robin
+
+    def connect(src, dst):
+        return {
+            "from structure" : "main",
+            "from layer" : src,
+            "to structure" : "main",
+            "to layer" : dst,
+            "type" : "fully connected",
+            "opcode" : "add",
+            "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 0.1 }
+        }
+
+    connections = []
+    for chain in ["a", "b"]:
+        for i in range(5):
+            connections.append(connect("%s%d" % (chain, i), "%s%d" % (chain, i+1)))
+        for i in range(0, 4, 2):
+            connections.append(connect("%s%d" % (chain, i), "%s%d" % (chain, i+2)))
+        connections.append(connect("%s5" % chain, "out"))
+
+    return Network(
+        {"structures" : [{"name" : "main", "type" : "parallel", "layers" : layers}],
+         "connections" : connections})
+
+def get_transfers(network, num_devices):
+    report = network.get_partition_report(num_devices)
+    instructions = int(report.properties["transfer instructions"])
+    estimated = int(report.properties["inter-device transfers"])
+    return report, instructions, estimated
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for num_devices in [2, 3, 4]:
+        network = build_network()
+        greedy = int(network.estimate_partition(num_devices, refine=False)
+            .properties["inter-device transfers"])
+        report, partitioned, estimated = get_transfers(network, num_devices)
+        del network
+
+        if partitioned != estimated:
+            print("Partition estimated %d transfers, but needs %d!"
+                % (estimated, partitioned))
+            failed = True
+
+        network = build_network(num_devices)
+        report, round_robin, estimated = get_transfers(network, num_devices)
+
+        # Make sure the baseline actually respected the pinned devices
+        for i,entry in enumerate(report.child_arrays["layers"]):
+            if int(entry.properties["device"]) != i % num_devices:
+                print("Round-robin layer %s was not pinned!"
+                    % entry.properties["layer"])
+                failed = True
+        if round_robin != estimated:
+            print("Round-robin estimated %d transfers, but needs %d!"
+                % (estimated, round_robin))
+            failed = True
+        del network
+
+        print("%d devices: %d partitioned, %d greedy, %d round-robin transfers"
+            % (num_devices, partitioned, greedy, round_robin))
+        if partitioned > greedy:
+            print("Partitioner exceeded greedy transfers!")
+            failed = True
+        if partitioned > round_robin:
+            print("Partitioner exceeded round-robin transfers!")
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Partitioned transfers never exceed greedy or round-robin")
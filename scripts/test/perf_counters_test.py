@@ -0,0 +1,80 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import os
+import sys
+import subprocess
+
+# Checks that perf counters include the OpenMP team threads
+# The same workload is run in child processes with one and four OpenMP
+#   threads.  The work done is the same, so the counted task clock must be
+#   too, rather than only the share of the thread that ran the kernel.
+# Kernels only use OpenMP teams in OPENMP=1 builds; otherwise both runs are
+#   serial and trivially match.  Passive waiting keeps idle team threads
+#   from adding spin time on machines with few cores.
+
+iterations = 20
+
+def run():
+    network = Network(
+        {"structures" : [{"name" : "perf", "type" : "parallel",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 64, "columns" : 64 },
+                { "name" : "out", "neural model" : "rate_encoding",
+                  "rows" : 32, "columns" : 32 }]}],
+         "connections" : [{
+            "from layer" : "in",
+            "to layer" : "out",
+            "type" : "fully connected",
+            "opcode" : "add",
+            "plastic" : False,
+            "weight config" : { "type" : "flat", "weight" : 0.01 }}]})
+
+    def input_callback(layer_name, view):
+        view[:] = 1.0
+
+    env = Environment({"modules" : [
+        make_custom_input_module("perf", ["in"],
+            "perf_test_input", input_callback)]})
+
+    report = network.run(env, {"devices" : get_cpu(),
+                               "multithreaded" : False,
+                               "iterations" : iterations,
+                               "perf counters" : "phases"})
+    del network
+    del env
+    return sum(float(entry.properties["task clock"])
+        for entry in report.child_arrays["perf counters"])
+
+def run_child(threads):
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads),
+        OMP_WAIT_POLICY="passive")
+    output = subprocess.check_output(
+        [sys.executable, os.path.abspath(__file__), "child"], env=env)
+    return float(output.decode().strip().split()[-1])
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    if sys.argv[1:] == ["child"]:
+        print(run())
+        sys.exit(0)
+
+    single = run_child(1)
+    team = run_child(4)
+    print("Task clock: %f s with one thread, %f s with four"
+        % (single, team))
+
+    if single <= 0.0:
+        print("No task clock was counted!")
+        sys.exit(1)
+
+    # Without the team threads, four threads would count about a quarter
+    if team < 0.6 * single:
+        print("Team threads were not counted!")
+        sys.exit(1)
+    print("Perf counters include OpenMP team threads")
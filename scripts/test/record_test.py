@@ -0,0 +1,111 @@
+from syngen import Network, Environment, get_cpu, read_recording
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import os
+import sys
+import shutil
+import tempfile
+import numpy as np
+
+# Checks that output recordings read back as the outputs that were written
+# A relay layer drives an izhikevich layer, and every output is captured by
+#   a callback alongside two record_output modules: one with raw words from
+#   both layers, and one with spike indices from the izhikevich layer.
+#   read_recording() must return the same frames for every iteration.
+
+iterations = 50
+rows, columns = 8, 8
+
+def run(directory):
+    network = Network(
+        {"structures" : [{"name" : "rec", "type" : "parallel",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : rows, "columns" : columns },
+                { "name" : "out", "neural model" : "izhikevich",
+                  "rows" : rows, "columns" : columns }]}],
+         "connections" : [{
+            "from layer" : "in", "to layer" : "out",
+            "type" : "one to one", "opcode" : "add",
+            "plastic" : False, "direct" : True,
+            "weight config" : { "type" : "flat", "weight" : 10.0 }}]})
+
+    rng = np.random.RandomState(0)
+    def input_callback(layer_name, view):
+        view[:] = rng.uniform(0.0, 2.0, view.size)
+
+    outputs = { "in" : [], "out" : [] }
+    def output_callback(layer_name, view):
+        outputs[layer_name].append(np.array(view, copy=True))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("rec", ["in"],
+            "record_test_input", input_callback),
+        make_custom_output_module("rec", ["in", "out"],
+            "record_test_output", output_callback),
+        { "type" : "record_output",
+          "filename" : os.path.join(directory, "raw.rec"),
+          "layers" : [ { "structure" : "rec", "layer" : "in" },
+                       { "structure" : "rec", "layer" : "out" } ]},
+        { "type" : "record_output",
+          "filename" : os.path.join(directory, "spikes.rec"),
+          "spikes" : True,
+          "layers" : [ { "structure" : "rec", "layer" : "out" } ]}]})
+
+    report = network.run(env, {"devices" : get_cpu(), "iterations" : iterations})
+    del network
+    del env
+    return report, dict((k, np.array(v)) for k,v in outputs.items())
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    directory = tempfile.mkdtemp()
+    try:
+        report, outputs = run(directory)
+        raw = read_recording(os.path.join(directory, "raw.rec"))
+        spikes = read_recording(os.path.join(directory, "spikes.rec"))
+    finally:
+        shutil.rmtree(directory)
+
+    failed = False
+
+    # Writer counters are reported once per module
+    module_reports = report.child_arrays.get("module reports", [])
+    if len(module_reports) != 2 or any(
+            int(r.properties["dropped frames"]) != 0 for r in module_reports):
+        print("Expected one report per recording module without drops!")
+        failed = True
+
+    out_words = outputs["out"].view(np.uint32)
+    if not (out_words >> 31).any():
+        print("Output layer never spiked!")
+        failed = True
+
+    for layer, dtype in [("in", np.float32), ("out", np.uint32)]:
+        recorded = raw[("rec", layer)]
+        expected = outputs[layer].view(dtype)
+        if len(recorded["iterations"]) != iterations or \
+                recorded["iterations"].tolist() != sorted(recorded["iterations"]):
+            print("%s: expected %d ordered frames, got %d"
+                % (layer, iterations, len(recorded["iterations"])))
+            failed = True
+        elif recorded["frames"].dtype != dtype or \
+                not np.array_equal(recorded["frames"], expected):
+            print("%s: recorded words differ from the outputs!" % layer)
+            failed = True
+
+    # Spike frames hold the neurons whose newest bit is set
+    recorded = spikes[("rec", "out")]
+    expected = [np.nonzero(words >> 31)[0] for words in out_words]
+    if len(recorded["frames"]) != iterations or any(
+            not np.array_equal(r, e)
+            for r, e in zip(recorded["frames"], expected)):
+        print("Recorded spikes differ from the outputs!")
+        failed = True
+
+    if failed: sys.exit(1)
+    print("Output recordings read back as written")
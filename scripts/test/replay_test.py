@@ -0,0 +1,115 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import os
+import sys
+import shutil
+import tempfile
+import numpy as np
+
+# Checks that replayed input logs reproduce the recorded run
+# A backprop network learns from seeded inputs and targets while the engine
+#   records its inputs.  Stimuli are held for a few iterations and are
+#   partly sparse, so the log holds both changed and unchanged runs.  The
+#   same network then runs from a replay_input module for as many iterations
+#   as it reports, and its outputs and learned weights must be identical.
+
+iterations = 60
+
+def build():
+    return Network(
+        {"structures" : [{"name" : "rep", "type" : "feedforward",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 8, "columns" : 8 },
+                { "name" : "out", "neural model" : "backprop_rate_encoding",
+                  "rows" : 4, "columns" : 4 }]}],
+         "connections" : [{
+            "name" : "replay_weights",
+            "from layer" : "in", "to layer" : "out",
+            "type" : "fully connected", "opcode" : "add",
+            "plastic" : True, "learning rate" : 0.05,
+            "weight config" : { "type" : "flat", "weight" : 0.01 }}]})
+
+def run(modules, args):
+    network = build()
+
+    outputs = []
+    def output_callback(layer_name, view):
+        outputs.append(np.array(view, copy=True))
+
+    env = Environment({"modules" : modules + [
+        make_custom_output_module("rep", ["out"],
+            "replay_test_output", output_callback)]})
+
+    network.run(env, dict(args, devices=get_cpu()))
+    weights = np.array(network.get_weight_matrix(
+        "replay_weights").to_np_array(), copy=True)
+    del network
+    del env
+    return np.array(outputs), weights
+
+def record(filename):
+    rng = np.random.RandomState(0)
+    stimulus = { "in" : None, "out" : None }
+    state = { "in" : 0, "out" : 0 }
+
+    # New stimuli every few iterations, with half the inputs zeroed
+    def input_callback(layer_name, view):
+        if state[layer_name] % 4 == 0:
+            values = rng.uniform(0.0, 1.0, view.size)
+            values[rng.uniform(size=view.size) < 0.5] = 0.0
+            stimulus[layer_name] = values
+        view[:] = stimulus[layer_name]
+        state[layer_name] += 1
+
+    modules = [
+        make_custom_input_module("rep", ["in"],
+            "replay_test_input", input_callback),
+        make_custom_input_module("rep", ["out"],
+            "replay_test_targets", input_callback, key="targets")]
+
+    return run(modules, { "iterations" : iterations,
+                          "record input" : filename })
+
+def replay(filename):
+    return run([{ "type" : "replay_input", "filename" : filename,
+                  "layers" : [ { "structure" : "rep", "layer" : "in" },
+                               { "structure" : "rep", "layer" : "out" } ]}],
+               { })
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    directory = tempfile.mkdtemp()
+    try:
+        filename = os.path.join(directory, "inputs.log")
+        recorded_outputs, recorded_weights = record(filename)
+        replayed_outputs, replayed_weights = replay(filename)
+    finally:
+        shutil.rmtree(directory)
+
+    failed = False
+    if recorded_outputs.shape[0] != iterations or not recorded_outputs.any():
+        print("Recorded run produced no output!")
+        failed = True
+    if np.all(recorded_weights == recorded_weights[0]):
+        print("Recorded run did not learn!")
+        failed = True
+
+    if replayed_outputs.shape != recorded_outputs.shape:
+        print("Replay ran %d iterations, expected %d"
+            % (replayed_outputs.shape[0], recorded_outputs.shape[0]))
+        failed = True
+    elif not np.array_equal(replayed_outputs, recorded_outputs):
+        print("Replayed outputs differ from the recorded run!")
+        failed = True
+    if not np.array_equal(replayed_weights, recorded_weights):
+        print("Replayed weights differ from the recorded run!")
+        failed = True
+
+    if failed: sys.exit(1)
+    print("Replayed inputs reproduce the recorded run")
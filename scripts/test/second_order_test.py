@@ -0,0 +1,148 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks second order dendrites against equivalent first order connections
+# Fully connected slaves read the host weights in place, while
+#   convolutional slaves operate on a copy of them.  In both cases, the
+#   host connection should behave as if its weights were:
+#     host * (gate1 * slave1) + (gate2 * slave2)
+
+iterations = 5
+dim = 8
+field = 3
+
+def weight_string(weights):
+    return " ".join(str(w) for w in weights.flatten())
+
+def build_network(conn_type, second_order, rng):
+    convolutional = conn_type == "convolutional"
+    if convolutional:
+        num_weights = field * field
+        gate_dim = field
+        arborized = { "field size" : field, "stride" : 1, "wrap" : False }
+    else:
+        num_weights = dim * dim * dim * dim
+        gate_dim = dim
+
+    host = rng.uniform(0.0, 1.0, num_weights).astype(np.float32)
+    slave1 = rng.uniform(0.0, 1.0, num_weights).astype(np.float32)
+    slave2 = rng.uniform(0.0, 0.1, num_weights).astype(np.float32)
+    gate1 = rng.uniform(0.5, 1.0, gate_dim * gate_dim).astype(np.float32)
+    gate2 = np.float32(0.5)
+
+    # Each convolutional slave weight reads its own gate neuron, while
+    #   fully connected slaves read gate neurons by column
+    if convolutional:
+        effective = host * (gate1 * slave1) + (gate2 * slave2)
+    else:
+        g = np.tile(gate1, dim * dim)
+        effective = host * (g * slave1) + (gate2 * slave2)
+
+    def connection(src, weights, opcode):
+        conn = {
+            "from layer" : src,
+            "to layer" : "receiver",
+            "opcode" : opcode,
+            "plastic" : False,
+            "weight config" : {
+                "type" : "specified",
+                "weight string" : weight_string(weights) }
+        }
+        if convolutional:
+            conn["type"] = "convergent"
+            conn["convolutional"] = True
+            conn["arborized config"] = dict(arborized)
+        else:
+            conn["type"] = "fully connected"
+        return conn
+
+    layers = [
+        { "name" : "receiver", "neural model" : "relay",
+          "rows" : dim, "columns" : dim },
+        { "name" : "in", "neural model" : "relay",
+          "rows" : dim, "columns" : dim },
+        { "name" : "gate1", "neural model" : "relay",
+          "rows" : gate_dim, "columns" : gate_dim },
+        { "name" : "gate2", "neural model" : "relay",
+          "rows" : gate_dim, "columns" : gate_dim },
+    ]
+
+    if second_order:
+        layers[0]["dendrites"] = [{ "name" : "so", "second order" : True }]
+        connections = [
+            connection("in", host, "add"),
+            connection("gate1", slave1, "mult"),
+            connection("gate2", slave2, "add"),
+        ]
+        for conn in connections: conn["dendrite"] = "so"
+
+        # Slave fields span the whole gate layer
+        if convolutional:
+            for conn in connections[1:]:
+                conn["arborized config"] = {
+                    "field size" : field, "stride" : 0, "offset" : 0 }
+    else:
+        connections = [ connection("in", effective, "add") ]
+
+    network = Network(
+        {"structures" : [{"name" : "so_test", "type" : "parallel",
+                          "layers" : layers}],
+         "connections" : connections})
+    return network, gate1, gate2
+
+def run(conn_type, second_order):
+    network, gate1, gate2 = build_network(
+        conn_type, second_order, np.random.RandomState(0))
+
+    rng = np.random.RandomState(1)
+    def input_callback(layer_name, view):
+        if layer_name == "in":
+            view[:] = rng.uniform(0.0, 1.0, view.size)
+        elif layer_name == "gate1":
+            view[:] = gate1
+        else:
+            view[:] = gate2
+
+    outputs = []
+    def output_callback(layer_name, view):
+        outputs.append(np.array(view, copy=True))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("so_test", ["in", "gate1", "gate2"],
+            "so_test_input", input_callback),
+        make_custom_output_module("so_test", ["receiver"],
+            "so_test_output", output_callback)]})
+
+    report = network.run(env, {"devices" : get_cpu(),
+                               "iterations" : iterations})
+    if report is None:
+        print("Engine failure.  Exiting...")
+        sys.exit(1)
+
+    del network
+    del env
+    return np.array(outputs)
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for conn_type in ["fully connected", "convolutional"]:
+        expected = run(conn_type, False)
+        actual = run(conn_type, True)
+
+        error = np.abs(expected - actual).max()
+        print("%-16s max error %g" % (conn_type, error))
+        if not np.any(expected) or not np.allclose(expected, actual,
+                rtol=1e-4, atol=1e-4):
+            print("  Second order output does not match!")
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Second order dendrites match first order equivalents")
@@ -0,0 +1,88 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import os
+import sys
+import signal
+import numpy as np
+
+# Checks that an interrupted session step keeps the environment rate phase
+# The input is the global iteration count, so reported outputs show which
+#   iterations the environment saw.  The first step is interrupted, and the
+#   following steps must pick up where it actually stopped.
+
+environment_rate = 4
+interrupt_at = 5
+
+def build():
+    network = Network(
+        {"structures" : [{"name" : "sess", "type" : "parallel",
+            "layers" : [{ "name" : "count", "neural model" : "relay",
+                          "rows" : 1, "columns" : 1 }]}],
+         "connections" : []})
+
+    state = { "iteration" : 0, "interrupt" : False }
+    def input_callback(layer_name, view):
+        view[:] = state["iteration"]
+        if state["interrupt"] and state["iteration"] == interrupt_at:
+            os.kill(os.getpid(), signal.SIGINT)
+        state["iteration"] += 1
+
+    reported = []
+    def output_callback(layer_name, view):
+        reported.append(int(view[0]))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("sess", ["count"],
+            "sess_test_input", input_callback),
+        make_custom_output_module("sess", ["count"],
+            "sess_test_output", output_callback)]})
+    return network, env, state, reported
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for multithreaded in [False, True]:
+        network, env, state, reported = build()
+        args = { "devices" : get_cpu(),
+                 "multithreaded" : multithreaded,
+                 "environment rate" : environment_rate }
+
+        with network.open_session(env, args) as session:
+            state["interrupt"] = True
+            report = session.step({ "iterations" : 100 })
+            state["interrupt"] = False
+            executed = state["iteration"]
+
+            if report.properties["interrupted"] != "true":
+                print("Step was not interrupted!")
+                failed = True
+            if int(report.properties["iterations"]) != executed:
+                print("Interrupted step reported %s of %d iterations"
+                    % (report.properties["iterations"], executed))
+                failed = True
+
+            session.step({ "iterations" : 3 * environment_rate })
+            session.step({ "iterations" : 2 * environment_rate })
+        if session.obj is not None:
+            print("Session was not closed on exit!")
+            failed = True
+
+        # Environment iterations are multiples of the rate, however the
+        #   steps are split
+        expected = [t for t in range(state["iteration"])
+            if t % environment_rate == 0]
+        if reported != expected:
+            print("multithreaded=%s: reported %s, expected %s"
+                % (multithreaded, reported, expected))
+            failed = True
+
+        del network
+        del env
+
+    if failed: sys.exit(1)
+    print("Interrupted session steps keep the environment phase")
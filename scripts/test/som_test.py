@@ -0,0 +1,120 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module, make_custom_output_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks the SOM layer against a numpy reference
+# Each iteration, the neuron whose weights are closest to the input wins,
+#   and only neurons within the (manhattan) neighborhood of the winner move
+#   toward the input.  A constant gate layer enables learning through the
+#   modulatory connection.
+
+iterations = 100
+input_size = 4
+rows, columns = 6, 6
+rbf_scale = 2.0
+learning_rate = 0.1
+neighbor_learning_rate = 0.02
+
+def reference(weights, inputs, neighborhood):
+    w = weights.astype(np.float64)
+    grid = np.indices((rows, columns)).reshape(2, -1).T
+    outputs = []
+    for x in inputs:
+        distance = ((x - w) ** 2).sum(axis=1)
+        winner = np.argmin(distance)
+        outputs.append(np.exp(-rbf_scale * distance * distance))
+
+        manhattan = np.abs(grid - grid[winner]).sum(axis=1)
+        rate = np.where(manhattan <= neighborhood, neighbor_learning_rate, 0.0)
+        rate[winner] = learning_rate
+        w += rate[:, None] * (x - w)
+    return w, np.array(outputs)
+
+def run(weights, inputs, neighborhood):
+    network = Network(
+        {"structures" : [{"name" : "som", "type" : "feedforward",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 1, "columns" : input_size },
+                { "name" : "gate", "neural model" : "relay",
+                  "rows" : 1, "columns" : 1 },
+                { "name" : "map", "neural model" : "som",
+                  "rbf scale" : rbf_scale,
+                  "rows" : rows, "columns" : columns }]}],
+         "connections" : [
+            { "name" : "som_weights",
+              "from layer" : "in", "to layer" : "map",
+              "type" : "fully connected", "opcode" : "add",
+              "plastic" : True,
+              "learning rate" : learning_rate,
+              "neighbor learning rate" : neighbor_learning_rate,
+              "neighborhood size" : neighborhood,
+              "weight config" : {
+                  "type" : "specified",
+                  "weight string" : " ".join(str(x) for x in weights.flatten()) }},
+            { "from layer" : "gate", "to layer" : "map",
+              "type" : "fully connected", "opcode" : "modulate",
+              "plastic" : False,
+              "weight config" : { "type" : "flat", "weight" : 1.0 }}]})
+
+    state = { "step" : 0 }
+    def input_callback(layer_name, view):
+        if layer_name == "gate":
+            view[:] = 1.0
+        else:
+            view[:] = inputs[state["step"]]
+            state["step"] += 1
+
+    outputs = []
+    def output_callback(layer_name, view):
+        outputs.append(np.array(view, copy=True))
+
+    env = Environment({"modules" : [
+        make_custom_input_module("som", ["in", "gate"],
+            "som_test_input", input_callback),
+        make_custom_output_module("som", ["map"],
+            "som_test_output", output_callback)]})
+
+    network.run(env, {"devices" : get_cpu(), "iterations" : iterations})
+
+    trained = np.array(
+        network.get_weight_matrix("som_weights").to_np_array(), copy=True)
+    del network
+    del env
+    return trained.reshape(rows * columns, input_size), np.array(outputs)
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    rng = np.random.RandomState(0)
+    weights = rng.uniform(0.0, 1.0,
+        (rows * columns, input_size)).astype(np.float32)
+    inputs = rng.uniform(0.0, 1.0,
+        (iterations, input_size)).astype(np.float32)
+
+    failed = False
+    for neighborhood in [0, 1, 2]:
+        trained, outputs = run(weights, inputs, neighborhood)
+        expected, expected_outputs = reference(weights, inputs, neighborhood)
+
+        if np.abs(trained - weights).max() < 1e-3:
+            print("Neighborhood %d: weights did not learn!" % neighborhood)
+            failed = True
+
+        if not np.allclose(trained, expected, rtol=1e-4, atol=1e-5):
+            print("Neighborhood %d: weights differ from the reference "
+                "(max error %g)" % (neighborhood, np.abs(trained - expected).max()))
+            failed = True
+        if outputs.shape != expected_outputs.shape or not np.allclose(
+                outputs, expected_outputs, rtol=1e-4, atol=1e-5):
+            print("Neighborhood %d: outputs differ from the reference"
+                % neighborhood)
+            failed = True
+
+    if failed: sys.exit(1)
+    print("SOM updates match numpy reference")
@@ -0,0 +1,72 @@
+from syngen import Network, Environment, get_cpu
+from syngen import make_custom_input_module
+from syngen import set_suppress_output, set_warnings, set_debug
+
+import sys
+import numpy as np
+
+# Checks host matrix transposes against numpy
+# Backprop connections between hidden layers keep a transposed copy of their
+#   weights, refreshed by a transpose instruction every iteration.  Shapes
+#   cover whole tiles and blocks as well as ragged edges.  A zero learning
+#   rate leaves the weights unchanged, so the copy must match exactly.
+
+shapes = [(3, 5), (8, 8), (64, 64), (70, 150), (130, 64), (200, 9)]
+
+def run(rows, columns):
+    network = Network(
+        {"structures" : [{"name" : "tr", "type" : "feedforward",
+            "layers" : [
+                { "name" : "in", "neural model" : "relay",
+                  "rows" : 1, "columns" : 4 },
+                { "name" : "hidden", "neural model" : "backprop_rate_encoding",
+                  "rows" : 1, "columns" : columns },
+                { "name" : "out", "neural model" : "backprop_rate_encoding",
+                  "rows" : 1, "columns" : rows }]}],
+         "connections" : [
+            { "from layer" : "in", "to layer" : "hidden",
+              "type" : "fully connected", "opcode" : "add",
+              "plastic" : True, "learning rate" : 0.0,
+              "weight config" : { "type" : "flat", "weight" : 0.1 }},
+            { "name" : "transposed",
+              "from layer" : "hidden", "to layer" : "out",
+              "type" : "fully connected", "opcode" : "add",
+              "plastic" : True, "learning rate" : 0.0,
+              "weight config" : {
+                  "type" : "random", "min weight" : -1.0, "max weight" : 1.0 }}]})
+
+    env = Environment({"modules" : [
+        make_custom_input_module("tr", ["in"],
+            "transpose_test_input", lambda name, view: None),
+        make_custom_input_module("tr", ["out"],
+            "transpose_test_targets", lambda name, view: None,
+            key="targets")]})
+
+    network.run(env, {"devices" : get_cpu(), "iterations" : 2})
+
+    weights, transposed = [
+        np.array(network.get_weight_matrix("transposed", key).to_np_array(),
+            copy=True)
+        for key in ["weights", "weights transposed"]]
+
+    del network
+    del env
+    return weights.reshape(rows, columns), transposed.reshape(columns, rows)
+
+if __name__ == "__main__":
+    set_suppress_output(True)
+    set_warnings(False)
+    set_debug(False)
+
+    failed = False
+    for rows, columns in shapes:
+        weights, transposed = run(rows, columns)
+        if not weights.any():
+            print("%dx%d: weights were not initialized!" % (rows, columns))
+            failed = True
+        elif not np.array_equal(transposed, weights.T):
+            print("%dx%d: transpose does not match numpy!" % (rows, columns))
+            failed = True
+
+    if failed: sys.exit(1)
+    print("Host transposes match numpy")
@@ -0,0 +1,374 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "context.h"
+#include "report.h"
+#include "network/network.h"
+#include "state/state.h"
+#include "io/environment.h"
+#include "engine/engine.h"
+#include "util/property_config.h"
+#include "util/tools.h"
+#include "util/resources/resource_manager.h"
+#include "mpi_wrap.h"
+
+/* Benchmark suite
+ *
+ * Builds a set of canonical networks in-process and runs each of them over a
+ *   sweep of sizes and thread counts.  Results are printed as CSV so that runs
+ *   from different releases can be compared directly.
+ *
+ * Sizes are scale factors applied to the base dimensions of each workload.
+ * Synapse counts are stored weights, so convolutional (shared) weights are
+ *   only counted once.  Time per synapse is computed over the synapses that
+ *   are evaluated, which counts shared weights once per destination neuron.
+ * Networks are built from a fixed seed (-r, printed with each row), so that
+ *   random weight sparsity is the same from run to run.
+ */
+
+typedef NetworkConfig* (*WorkloadBuilder)(int scale);
+
+static PropertyConfig layer_config(std::string name, std::string model,
+        int rows, int columns) {
+    return PropertyConfig({
+        {"name", name},
+        {"neural model", model},
+        {"rows", std::to_string(rows)},
+        {"columns", std::to_string(columns)}});
+}
+
+static PropertyConfig connection_config(std::string from, std::string to,
+        std::string type, std::string structure="bench") {
+    return PropertyConfig({
+        {"from structure", structure},
+        {"to structure", structure},
+        {"from layer", from},
+        {"to layer", to},
+        {"type", type},
+        {"opcode", "add"},
+        {"plastic", "false"}});
+}
+
+static PropertyConfig random_weights(float min, float max,
+        float fraction=1.0) {
+    return PropertyConfig({
+        {"type", "random"},
+        {"min weight", std::to_string(min)},
+        {"max weight", std::to_string(max)},
+        {"fraction", std::to_string(fraction)}});
+}
+
+static PropertyConfig arborized(int field_size, int stride, bool wrap) {
+    return PropertyConfig({
+        {"field size", std::to_string(field_size)},
+        {"stride", std::to_string(stride)},
+        {"wrap", wrap ? "true" : "false"}});
+}
+
+/* Fully connected feedforward rate network */
+static NetworkConfig* build_dense_rate(int scale) {
+    int dim = 16 * scale;
+    auto network_config = new NetworkConfig();
+    auto structure = new StructureConfig("bench", PARALLEL);
+
+    auto input = layer_config("input", "relay", dim, dim);
+    auto init = PropertyConfig({{"type", "uniform"}, {"min", "0"}, {"max", "1"}});
+    input.set_child("init config", &init);
+    auto hidden = layer_config("hidden", "rate_encoding", dim, dim);
+    auto output = layer_config("output", "rate_encoding", dim, dim);
+    structure->add_layer(&input);
+    structure->add_layer(&hidden);
+    structure->add_layer(&output);
+    network_config->add_structure(structure);
+
+    auto weights = random_weights(0.0, 1.0 / (dim * dim));
+    auto in_hid = connection_config("input", "hidden", "fully connected");
+    in_hid.set_child("weight config", &weights);
+    auto hid_out = connection_config("hidden", "output", "fully connected");
+    hid_out.set_child("weight config", &weights);
+    network_config->add_connection(&in_hid);
+    network_config->add_connection(&hid_out);
+
+    return network_config;
+}
+
+/* Sparse recurrent nvm (tanh) reservoir */
+static NetworkConfig* build_sparse_reservoir(int scale) {
+    int dim = 16 * scale;
+    auto network_config = new NetworkConfig();
+    auto structure = new StructureConfig("bench", PARALLEL);
+
+    auto reservoir = layer_config("reservoir", "nvm", dim, dim);
+    auto init = PropertyConfig(
+        {{"type", "uniform"}, {"min", "-1"}, {"max", "1"}});
+    reservoir.set_child("init config", &init);
+    structure->add_layer(&reservoir);
+    network_config->add_structure(structure);
+
+    auto weights = random_weights(-1.0, 1.0, 0.1);
+    auto recurrent =
+        connection_config("reservoir", "reservoir", "fully connected");
+    recurrent.set("sparse", true);
+    recurrent.set_child("weight config", &weights);
+    network_config->add_connection(&recurrent);
+
+    return network_config;
+}
+
+/* Izhikevich spiking network with distance-based axonal delays */
+static NetworkConfig* build_izhikevich(int scale) {
+    int dim = 32 * scale;
+    auto network_config = new NetworkConfig();
+    auto structure = new StructureConfig("bench", PARALLEL);
+
+    auto exc = layer_config("exc", "izhikevich", dim, dim);
+    exc.set("neuron spacing", 0.5f);
+    auto init = PropertyConfig(
+        {{"type", "poisson"}, {"value", "20"}, {"rate", "10"}});
+    exc.set_child("init config", &init);
+    structure->add_layer(&exc);
+    network_config->add_structure(structure);
+
+    auto weights = random_weights(0.0, 0.5, 0.5);
+    auto field = arborized(15, 1, true);
+    auto recurrent = connection_config("exc", "exc", "convergent");
+    recurrent.set("sparse", true);
+    recurrent.set("cap delay", true);
+    recurrent.set_child("weight config", &weights);
+    recurrent.set_child("arborized config", &field);
+    network_config->add_connection(&recurrent);
+
+    return network_config;
+}
+
+/* Conway's game of life on a wrapped grid */
+static NetworkConfig* build_game_of_life(int scale) {
+    int dim = 128 * scale;
+    auto network_config = new NetworkConfig();
+    auto structure = new StructureConfig("bench", PARALLEL);
+
+    auto board = layer_config("board", "game_of_life", dim, dim);
+    structure->add_layer(&board);
+    network_config->add_structure(structure);
+
+    auto weights = PropertyConfig({{"type", "flat"}, {"weight", "1"}});
+    auto field = arborized(3, 1, true);
+    auto neighbors = connection_config("board", "board", "convergent");
+    neighbors.set_child("weight config", &weights);
+    neighbors.set_child("arborized config", &field);
+    network_config->add_connection(&neighbors);
+
+    return network_config;
+}
+
+/* Stack of convolutional convergent layers */
+static NetworkConfig* build_convolution_stack(int scale) {
+    const int depth = 3;
+    const int field_size = 5;
+    int dim = 64 * scale;
+
+    auto network_config = new NetworkConfig();
+    auto structure = new StructureConfig("bench", PARALLEL);
+
+    auto input = layer_config("conv0", "relay", dim, dim);
+    auto init = PropertyConfig({{"type", "uniform"}, {"min", "0"}, {"max", "1"}});
+    input.set_child("init config", &init);
+    structure->add_layer(&input);
+
+    for (int i = 1 ; i <= depth ; ++i) {
+        dim -= field_size - 1;
+        auto layer = layer_config(
+            "conv" + std::to_string(i), "rate_encoding", dim, dim);
+        structure->add_layer(&layer);
+    }
+    network_config->add_structure(structure);
+
+    auto weights = random_weights(0.0, 1.0 / (field_size * field_size));
+    auto field = PropertyConfig({
+        {"field size", std::to_string(field_size)},
+        {"stride", "1"},
+        {"offset", "0"}});
+    for (int i = 1 ; i <= depth ; ++i) {
+        auto conv = connection_config(
+            "conv" + std::to_string(i-1), "conv" + std::to_string(i),
+            "convergent");
+        conv.set("convolutional", true);
+        conv.set_child("weight config", &weights);
+        conv.set_child("arborized config", &field);
+        network_config->add_connection(&conv);
+    }
+
+    return network_config;
+}
+
+static const std::vector<std::pair<std::string, WorkloadBuilder>> workloads = {
+    {"dense_rate", build_dense_rate},
+    {"sparse_reservoir", build_sparse_reservoir},
+    {"izhikevich_delays", build_izhikevich},
+    {"game_of_life", build_game_of_life},
+    {"convolution_stack", build_convolution_stack},
+};
+
+static std::vector<std::string> split(std::string list) {
+    std::vector<std::string> out;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (item.size() > 0) out.push_back(item);
+    return out;
+}
+
+static std::vector<int> split_ints(std::string list) {
+    std::vector<int> out;
+    for (auto item : split(list)) out.push_back(std::stoi(item));
+    return out;
+}
+
+static void print_usage(const char* name) {
+    printf("Usage: %s [-w workloads] [-s scales] [-t threads] [-i iterations]"
+        " [-r seed]\n", name);
+    printf("  -w  comma separated workloads (default: all)\n");
+    printf("  -s  comma separated size scale factors (default: 1,2)\n");
+    printf("  -t  comma separated worker thread counts (default: 1,2,4)\n");
+    printf("  -i  iterations per run (default: 100)\n");
+    printf("  -r  random seed for network construction (default: 0)\n");
+    printf("\nWorkloads:\n");
+    for (auto pair : workloads)
+        printf("  %s\n", pair.first.c_str());
+}
+
+static void run_workload(std::string name, WorkloadBuilder builder,
+        int scale, int threads, int iterations, unsigned int seed) {
+    // Weights are initialized on one thread, so that the seed determines them
+    // The generator is shared by every translation unit (util/tools.h), and
+    //   is local to this thread
+#ifdef _OPENMP
+    omp_set_num_threads(1);
+#endif
+    generator.seed(seed);
+
+    auto network = new Network(builder(scale));
+    auto environment = new Environment();
+    auto state = new State(network);
+    auto engine = new Engine(Context(network, environment, state));
+
+#ifdef _OPENMP
+    omp_set_num_threads(threads);
+#endif
+
+    auto host_id = ResourceManager::get_instance()->get_host_id();
+    Report* report = engine->run(PropertyConfig({
+        {"iterations", std::to_string(iterations)},
+        {"worker threads", std::to_string(threads)},
+        {"multithreaded", "false"},
+        {"devices", std::to_string(host_id)},
+        {"verbose", "false"}}));
+
+    float total_time = report->get_float("total time", 0.0);
+    size_t synapses = network->get_num_weights();
+    size_t evaluated = network->get_num_compute_weights();
+    size_t network_bytes = std::stoll(report->get("network bytes"));
+    size_t buffer_bytes = std::stoll(report->get("state buffer bytes"))
+        + std::stoll(report->get("engine buffer bytes"));
+
+    printf("%s,%d,%d,%d,%zu,%d,%f,%f,%f,%zu,%zu,%u\n",
+        name.c_str(), scale, threads,
+        network->get_num_neurons(), synapses,
+        iterations, total_time,
+        (total_time > 0) ? iterations / total_time : 0.0,
+        (evaluated > 0)
+            ? (1e9 * total_time) / ((double)iterations * evaluated) : 0.0,
+        network_bytes, buffer_bytes, seed);
+    fflush(stdout);
+
+    delete report;
+    delete engine;
+    delete state;
+    delete environment;
+    delete network;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> names;
+    std::vector<int> scales = { 1, 2 };
+    std::vector<int> thread_counts = { 1, 2, 4 };
+    int iterations = 100;
+    unsigned int seed = 0;
+
+    try {
+        for (int i = 1 ; i < argc ; ++i) {
+            std::string arg = argv[i];
+            if (arg == "-h") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (i + 1 == argc) {
+                throw std::invalid_argument(arg);
+            } else if (arg == "-w") {
+                names = split(argv[++i]);
+            } else if (arg == "-s") {
+                scales = split_ints(argv[++i]);
+            } else if (arg == "-t") {
+                thread_counts = split_ints(argv[++i]);
+            } else if (arg == "-i") {
+                iterations = std::stoi(argv[++i]);
+            } else if (arg == "-r") {
+                seed = std::stoul(argv[++i]);
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+    } catch (const std::invalid_argument&) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Validate workload names
+    std::vector<std::pair<std::string, WorkloadBuilder>> selected;
+    for (auto name : names) {
+        bool found = false;
+        for (auto pair : workloads)
+            if (pair.first == name) {
+                selected.push_back(pair);
+                found = true;
+            }
+        if (not found) {
+            printf("Unrecognized workload: %s\n", name.c_str());
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (names.size() == 0) selected = workloads;
+
+    Logger::warnings = false;
+    Logger::suppress_output = true;
+
+    printf("workload,scale,threads,neurons,synapses,iterations,"
+           "seconds,iterations_per_sec,ns_per_synapse,"
+           "network_bytes,buffer_bytes,seed\n");
+
+    // Engines synchronize ranks in MPI builds
+    mpi_wrap_init();
+
+    int status = 0;
+    try {
+        for (auto pair : selected)
+            for (auto scale : scales)
+                for (auto threads : thread_counts)
+                    run_workload(pair.first, pair.second,
+                        scale, threads, iterations, seed);
+    } catch (const std::runtime_error&) {
+        printf("Fatal error -- exiting...\n");
+        status = 1;
+    }
+
+    mpi_wrap_finalize();
+    return status;
+}
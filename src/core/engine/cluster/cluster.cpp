@@ -45,6 +45,11 @@ void Cluster::launch_output() {
         node->activate_output();
 }
 
+void Cluster::launch_output_accumulation() {
+    for (auto& node : nodes)
+        node->accumulate_output();
+}
+
 void Cluster::wait_for_input() {
     for (auto& node : nodes)
         node->synchronize_input();
@@ -31,6 +31,7 @@ class Cluster {
 
         void launch_input();
         void launch_output();
+        void launch_output_accumulation();
 
         virtual void launch_pre_input_calculations() { };
         virtual void launch_post_input_calculations() = 0;
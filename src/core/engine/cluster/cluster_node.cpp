@@ -64,7 +64,7 @@ ClusterNode::ClusterNode(Layer *layer, State *state, Engine *engine,
     // Perform DFS on dendritic tree
     // Do this after so that the state learning instruction comes first
     //   in the update_instructions list
-    dendrite_DFS(to_layer->get_dendritic_root());
+    dendrite_DFS(to_layer->get_dendritic_root(), to_layer->get_dendritic_root());
 
     // Add output transfer instruction
     if (engine->is_output(layer)) {
@@ -112,12 +112,62 @@ int ClusterNode::get_ghost_inst_index() const {
     else return ghost_inst_index;
 }
 
-void ClusterNode::dendrite_DFS(DendriticNode *curr) {
-    // Second order connections need a transfer to copy the host weights
-    if (curr->second_order)
-        activate_instructions.push_back(
-            new SecondOrderWeightTransferInstruction(
-                curr, state, compute_stream));
+/* Returns whether a dendritic subtree reduces to a plain sum of its
+ *   connections.  Such subtrees have no gating, so their connections can
+ *   aggregate directly into the register of the parent node, saving the
+ *   pass that aggregates and resets the subtree's register. */
+static bool is_additive(DendriticNode *node) {
+    if (node->is_leaf())
+        return node->conn->opcode == ADD or node->conn->opcode == SUB;
+
+    if (node->second_order or node->opcode != ADD or node->init_val != 0.0)
+        return false;
+
+    for (auto& child : node->get_children())
+        if (not is_additive(child)) return false;
+    return true;
+}
+
+/* Returns whether a second order slave can read the host weights in place
+ *   rather than from a copy.  This requires the base second order kernel,
+ *   and a connection type that writes every weight each timestep.
+ * Convolutional slaves always use the copy, since their kernels iterate
+ *   over weights rather than destination neurons (see connection.cpp). */
+static bool reads_every_weight(Connection *conn, State *state) {
+    auto activators = state->get_activators(conn);
+    if (activators.size() != 1
+            or not (activators[0] == get_base_activator_kernel(conn)))
+        return false;
+
+    switch (conn->get_type()) {
+        case FULLY_CONNECTED:
+        case SUBSET:
+        case ONE_TO_ONE:
+            return true;
+        case CONVERGENT:
+            return not conn->convolutional
+                and conn->get_config()->get_arborized_config().wrap;
+        default:
+            return false;
+    }
+}
+
+/* |target| is the node whose register connections aggregate into.
+ * This is |curr| unless |curr| is part of an additive subtree. */
+void ClusterNode::dendrite_DFS(DendriticNode *curr, DendriticNode *target) {
+    // Second order connections need a transfer to copy the host weights,
+    //   unless the first slave connection can read them in place
+    bool second_order_in_place = false;
+    if (curr->second_order) {
+        auto children = curr->get_children();
+        second_order_in_place = children.size() > 0
+            and reads_every_weight(children[0]->conn, state);
+
+        if (not second_order_in_place)
+            activate_instructions.push_back(
+                new SecondOrderWeightTransferInstruction(
+                    curr, state, compute_stream));
+    }
     // During propagation up the dendritic tree, internal nodes will be set to
     //   their initialization value upon exit.  Thus, we need to initialize the
     //   values for the first round.  Create a temporary instruction and do it.
@@ -125,7 +175,7 @@ void ClusterNode::dendrite_DFS(DendriticNode *curr) {
     //   this initialization instruction is completed.
     // This doesn't get run for root because it cannot have an init_value, and
     //   because it can get init applied to it that should not be overwritten
-    else if (curr->name != "root")
+    else if (curr->name != "root" and curr == target)
         (SetInstruction(curr, state, compute_stream, curr->init_val)).activate();
 
     for (auto& child : curr->get_children()) {
@@ -145,7 +195,12 @@ void ClusterNode::dendrite_DFS(DendriticNode *curr) {
                 ghost_inst_index = activate_instructions.size();
 
             auto syn_inst = new SynapseActivateInstruction(
-                curr, conn, state, compute_stream);
+                target, conn, state, compute_stream);
+
+            // The first slave reads the second order host weights in place
+            if (second_order_in_place and child == curr->get_children()[0])
+                syn_inst->set_second_order_source(
+                    state->get_weights(curr->get_second_order_connection()));
 
             // Create the instruction and add it to the synapse instuction list
             synapse_activate_instructions.push_back(syn_inst);
@@ -163,16 +218,19 @@ void ClusterNode::dendrite_DFS(DendriticNode *curr) {
                 update_instructions.push_back(syn_update_inst);
                 synapse_update_instructions.push_back(syn_update_inst);
             }
+        } else if (is_additive(child)) {
+            // Additive subtrees aggregate into this node's target directly
+            this->dendrite_DFS(child, target);
         } else {
-            this->dendrite_DFS(child);
+            this->dendrite_DFS(child, child);
 
             // If the registers do not match, add a transfer instruction
             // Second order connections won't reach here
             //   because they can't have internal children
-            if (curr->register_index != child->register_index)
+            if (target->register_index != child->register_index)
                 activate_instructions.push_back(
                     new DendriticInstruction(
-                        curr, child, state, compute_stream));
+                        target, child, state, compute_stream));
         }
     }
 
@@ -229,6 +287,12 @@ void ClusterNode::activate_output() {
         inst->activate();
 }
 
+void ClusterNode::accumulate_output() {
+    // Auxiliary outputs are only sampled
+    if (output_instruction != nullptr)
+        output_instruction->accumulate();
+}
+
 void ClusterNode::synchronize_input() {
     if (input_instruction != nullptr)
         input_instruction->synchronize();
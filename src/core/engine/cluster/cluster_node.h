@@ -13,6 +13,7 @@ class State;
 class Engine;
 class Instruction;
 class SynapseInstruction;
+class OutputTransferInstruction;
 typedef std::vector<Instruction*> InstructionList;
 typedef std::vector<SynapseInstruction*> SynapseInstructionList;
 
@@ -27,6 +28,7 @@ class ClusterNode {
         void activate_input();
         void activate_state();
         void activate_output();
+        void accumulate_output();
 
         void synchronize_input();
         void synchronize_output();
@@ -49,7 +51,7 @@ class ClusterNode {
         Engine* const engine;
 
     private:
-        void dendrite_DFS(DendriticNode *curr);
+        void dendrite_DFS(DendriticNode *curr, DendriticNode *target);
 
         // Index of first instruction with a ghost source (-1 default)
         int ghost_inst_index;
@@ -65,7 +67,7 @@ class ClusterNode {
         Instruction *input_instruction;
         std::vector<Instruction*> input_auxiliary_instructions;
 
-        Instruction *output_instruction;
+        OutputTransferInstruction *output_instruction;
         std::vector<Instruction*> output_auxiliary_instructions;
 };
 
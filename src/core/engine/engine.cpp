@@ -7,6 +7,8 @@
 #include "network/network.h"
 #include "io/buffer.h"
 #include "io/environment.h"
+#include "io/module_pool.h"
+#include "io/input_recorder.h"
 #include "state/state.h"
 #include "state/attributes.h"
 #include "report.h"
@@ -23,21 +25,19 @@ static void handle_interrupt(int param) {
     Engine::interrupt();
 }
 
-/* Keep thread-safe signal flag */
+/* Keep thread-safe signal flags */
 std::mutex Engine::global_engine_lock;
-bool Engine::interrupt_signaled = false;
-bool Engine::interrupt_from_gui = false;
-bool Engine::running = false;
+std::set<Engine*> Engine::open_engines;
 
 /* Signals interrupt to all active engines */
 void Engine::interrupt(bool from_gui) {
-    {
-        std::unique_lock<std::mutex> lock(global_engine_lock);
+    std::unique_lock<std::mutex> lock(global_engine_lock);
 
+    for (auto engine : Engine::open_engines) {
         // Avoid double signalling
-        if (Engine::interrupt_signaled or not Engine::running) return;
-        Engine::interrupt_signaled = true;
-        Engine::interrupt_from_gui = from_gui;
+        if (engine->interrupt_signaled) continue;
+        engine->interrupt_signaled = true;
+        engine->interrupt_from_gui = from_gui;
     }
 }
 
@@ -46,14 +46,28 @@ Engine::Engine(Context context)
         : context(context),
           learning_flag(true),
           suppress_output(false),
+          output_accumulation(NO_ACCUMULATION),
           refresh_rate(FLT_MAX),
           time_limit(0),
+          pacing_spin(0.0001),
           environment_rate(1),
           iterations(0),
+          expected_iterations(0),
           verbose(false),
           buffer(nullptr),
+          module_pool(nullptr),
+          input_recorder(nullptr),
           report(nullptr),
-          multithreaded(false) { }
+          session_open(false),
+          session_args(nullptr),
+          iteration_offset(0),
+          holds_rand(false),
+          scheduler(new Scheduler()),
+          multithreaded(false),
+          interrupt_signaled(false),
+          interrupt_from_gui(false) {
+    for (int i = 0 ; i < NUM_ENGINE_PHASES ; ++i) perf_phases[i] = nullptr;
+}
 
 void Engine::build_environment(PropertyConfig args) {
     if (context.environment == nullptr) return;
@@ -70,8 +84,12 @@ void Engine::build_environment(PropertyConfig args) {
         if (config->get_bool("skip", false)) continue;
 
         // Build module
+        // Modules read accumulated outputs with the accumulated output type
+        auto module_config = new ModuleConfig(config);
+        module_config->set("output accumulation",
+            args.get("output accumulation", "none"));
         Module *module = Module::build_module(
-            context.network, new ModuleConfig(config));
+            context.network, module_config);
 
         // If module has no layers, it will not be built, so skip it
         if (module == nullptr) continue;
@@ -172,15 +190,45 @@ void Engine::build_clusters(PropertyConfig args) {
             }
         }
     }
+    if (inter_device_transfers.size() > 0)
+        LOG_DEBUG("Built " + std::to_string(inter_device_transfers.size())
+            + " inter-device transfer instructions\n");
 }
 
 void Engine::rebuild(PropertyConfig args) {
+    // Streams and events created while building belong to this engine
+    SchedulerScope scope(scheduler);
+
     clear();
+    this->output_accumulation = ::get_output_accumulation(
+        args.get("output accumulation", "none"));
     build_environment(args);
     build_clusters(args);
+
+    // Default iteration count for steps, from the new modules
+    this->expected_iterations = 0;
+    for (auto module : modules)
+        this->expected_iterations = std::max(
+            this->expected_iterations, module->get_expected_iterations());
+
+    // Independent modules run concurrently on a pool of IO threads
+    module_pool = new ModulePool(modules,
+        std::max(0, args.get_int("io threads", 4)));
+
+    // Record inputs for replay_input modules, if requested
+    if (args.get("record input", "") != "") {
+        LayerKeyMap keys;
+        for (auto pair : io_types)
+            if (pair.second & INPUT)
+                keys[pair.first] = input_keys[pair.first];
+        input_recorder = new InputRecorder(
+            args.get("record input"), buffer, keys);
+    }
 }
 
 void Engine::clear() {
+    clear_perf_regions();
+
     // Clear clusters
     for (auto cluster : clusters) delete cluster;
     clusters.clear();
@@ -194,19 +242,97 @@ void Engine::clear() {
     }
 
     // Clear modules and IO types
+    if (input_recorder != nullptr) {
+        delete input_recorder;
+        input_recorder = nullptr;
+    }
+    if (module_pool != nullptr) {
+        delete module_pool;
+        module_pool = nullptr;
+    }
     for (auto module : modules) delete module;
     modules.clear();
     io_types.clear();
     input_keys.clear();
     output_keys.clear();
 
-    // Clear resources
-    ResourceManager::get_instance()->delete_streams();
-    ResourceManager::get_instance()->delete_events();
+    // Clear resources, leaving those of other engines
+    ResourceManager::get_instance()->delete_streams(scheduler);
+    ResourceManager::get_instance()->delete_events(scheduler);
 }
 
 Engine::~Engine() {
+    close();
     clear();
+    delete scheduler;
+}
+
+static const char* const phase_names[] = {
+    "pre input calculations",
+    "post input calculations",
+    "state update",
+    "weight update"
+};
+
+void Engine::build_perf_regions(std::string mode) {
+    clear_perf_regions();
+    if (mode == "" or mode == "none") return;
+    if (mode != "phases" and mode != "instructions")
+        LOG_ERROR("Unrecognized perf counters mode: " + mode);
+
+    for (int i = 0 ; i < NUM_ENGINE_PHASES ; ++i) {
+        perf_phases[i] = new PerfRegion(phase_names[i]);
+        perf_regions.push_back(perf_phases[i]);
+    }
+
+    if (mode == "instructions") {
+        for (auto& cluster : clusters) {
+            for (auto& node : cluster->get_nodes()) {
+                for (auto& inst : node->get_synapse_activate_instructions()) {
+                    auto region = new PerfRegion(
+                        inst->connection->str() + " activate");
+                    inst->set_perf_region(region);
+                    perf_regions.push_back(region);
+                }
+                for (auto& inst : node->get_synapse_update_instructions()) {
+                    auto region = new PerfRegion(
+                        inst->connection->str() + " update");
+                    inst->set_perf_region(region);
+                    perf_regions.push_back(region);
+                }
+                auto region = new PerfRegion(
+                    node->to_layer->str() + " state update");
+                node->get_state_update_instruction()->set_perf_region(region);
+                perf_regions.push_back(region);
+            }
+        }
+    }
+
+    if (verbose and not PerfCounters::has_hardware())
+        LOG_WARNING("Hardware performance counters are unavailable -- "
+            "reporting task clock only.");
+}
+
+void Engine::clear_perf_regions() {
+    for (auto& cluster : clusters) {
+        for (auto& node : cluster->get_nodes()) {
+            for (auto& inst : node->get_synapse_activate_instructions())
+                inst->set_perf_region(nullptr);
+            for (auto& inst : node->get_synapse_update_instructions())
+                inst->set_perf_region(nullptr);
+            node->get_state_update_instruction()->set_perf_region(nullptr);
+        }
+    }
+
+    for (auto region : perf_regions) delete region;
+    perf_regions.clear();
+    for (int i = 0 ; i < NUM_ENGINE_PHASES ; ++i) perf_phases[i] = nullptr;
+}
+
+/* Launches a cluster phase, counting its computations toward the phase */
+void Engine::launch_phase(EnginePhase phase, void (Cluster::*launch)()) {
+    PerfScope scope(perf_phases[phase]);
+    for (auto& c : clusters) (c->*launch)();
 }
 
 size_t Engine::get_buffer_bytes() const {
@@ -217,6 +343,13 @@ size_t Engine::get_buffer_bytes() const {
     return size;
 }
 
+size_t Engine::estimate_buffer_bytes(
+        Network *network, Environment *environment) {
+    Engine engine(Context(network, environment, nullptr));
+    engine.build_environment(PropertyConfig());
+    return engine.get_buffer_bytes();
+}
+
 
 /****************/
 /* Thread Mains */
@@ -227,56 +360,61 @@ void Engine::single_thread_loop() {
     // Synchronize MPI processes, if MPI is enabled (no-op otherwise)
     mpi_wrap_barrier();
     run_timer.reset();
+    if (time_limit > 0) pacer.start(time_limit, pacing_spin);
 
     for (size_t i = 0 ; iterations == 0 or i < iterations; ++i) {
-        // Reset iteration timer
-        if (time_limit > 0) iteration_timer.reset();
-
         /*************************************/
         /*** Launch pre-input computations ***/
         /*************************************/
-        for (auto& c : clusters) c->launch_pre_input_calculations();
+        launch_phase(PRE_INPUT_PHASE,
+            &Cluster::launch_pre_input_calculations);
 
         /**************************/
         /*** Read sensory input ***/
         /**************************/
         for (auto& c : clusters) c->wait_for_input();
-        for (auto& m : modules)  m->feed_input(buffer);
+        module_pool->feed_input(buffer);
+        if (input_recorder != nullptr) input_recorder->record();
         for (auto& c : clusters) c->launch_input();
 
         /***************************************/
         /*** Perform post-input computations ***/
         /***************************************/
-        for (auto& c : clusters) c->launch_post_input_calculations();
-        for (auto& c : clusters) c->launch_state_update();
+        launch_phase(POST_INPUT_PHASE,
+            &Cluster::launch_post_input_calculations);
+        launch_phase(STATE_UPDATE_PHASE, &Cluster::launch_state_update);
 
         if (learning_flag)
-            for (auto& c : clusters) c->launch_weight_update();
+            launch_phase(WEIGHT_UPDATE_PHASE, &Cluster::launch_weight_update);
 
         /**************************/
         /*** Write motor output ***/
         /**************************/
-        if (i % environment_rate == 0) {
+        if ((iteration_offset + i) % environment_rate == 0) {
             // Stream output
             if (not suppress_output) {
                 for (auto& c : clusters) c->launch_output();
                 for (auto& c : clusters) c->wait_for_output();
-                for (auto& m : modules)  m->report_output(buffer);
+                module_pool->report_output(buffer);
             }
 
             // Update UI
             GuiController::update();
+        } else if (output_accumulation != NO_ACCUMULATION
+                and not suppress_output) {
+            // Accumulate output until the next environment iteration
+            for (auto& c : clusters) c->launch_output_accumulation();
         }
 
         // Cycle modules
-        for (auto& m : modules) m->cycle();
+        module_pool->cycle();
 
         // Check for errors
         device_check_error(nullptr);
 
-        // If engine gets interrupted, break
-        if (Engine::interrupt_signaled) {
-            iterations = i;
+        // If engine gets interrupted, record the iterations run and break
+        if (this->interrupt_signaled) {
+            iterations = i + 1;
             break;
         }
 
@@ -286,11 +424,11 @@ void Engine::single_thread_loop() {
                 1000 / (run_timer.query(nullptr)));
 
         // Synchronize with the clock
-        if (time_limit > 0) iteration_timer.wait(time_limit);
+        if (time_limit > 0) pacer.wait();
     }
 
     // Wait for scheduler to complete
-    Scheduler::get_instance()->wait_for_completion();
+    scheduler->wait_for_completion();
 
     // Final device synchronize
     device_synchronize();
@@ -302,6 +440,11 @@ void Engine::single_thread_loop() {
     this->report = new Report(this, this->context.state,
         iterations, run_timer.query(nullptr));
 
+    // Report pacing statistics and performance counters
+    if (time_limit > 0) pacer.report(report);
+    for (auto region : perf_regions) region->report(report);
+    if (input_recorder != nullptr) input_recorder->report(report);
+
     // Allow modules to modify report
     for (auto& m : this->modules) m->report(report);
 
@@ -310,7 +453,7 @@ void Engine::single_thread_loop() {
 
     // If iterrupted by GUI controls, main thread will handle
     // Otherwise, shut down GUI
-    if (not Engine::interrupt_from_gui)
+    if (not this->interrupt_from_gui)
         GuiController::quit();
 }
 
@@ -320,13 +463,12 @@ void Engine::network_loop() {
     // Synchronize MPI processes, if MPI is enabled (no-op otherwise)
     mpi_wrap_barrier();
     run_timer.reset();
+    if (time_limit > 0) pacer.start(time_limit, pacing_spin);
 
     for (size_t i = 0 ; iterations == 0 or i < iterations; ++i) {
-        // Wait for timer, then start clearing inputs
-        if (time_limit > 0) iteration_timer.reset();
-
         // Launch pre-input calculations
-        for (auto& c : clusters) c->launch_pre_input_calculations();
+        launch_phase(PRE_INPUT_PHASE,
+            &Cluster::launch_pre_input_calculations);
 
         /**************************/
         /*** Read sensory input ***/
@@ -340,28 +482,35 @@ void Engine::network_loop() {
         /****************************/
         /*** Perform computations ***/
         /****************************/
-        for (auto& c : clusters) c->launch_post_input_calculations();
-        for (auto& c : clusters) c->launch_state_update();
+        launch_phase(POST_INPUT_PHASE,
+            &Cluster::launch_post_input_calculations);
+        launch_phase(STATE_UPDATE_PHASE, &Cluster::launch_state_update);
 
         if (learning_flag)
-            for (auto& c : clusters) c->launch_weight_update();
+            launch_phase(WEIGHT_UPDATE_PHASE, &Cluster::launch_weight_update);
 
         /**************************/
         /*** Write motor output ***/
         /**************************/
         motor_lock.wait(NETWORK_THREAD);
 
-        if (i % environment_rate == 0)
-            for (auto& c : clusters) c->launch_output();
+        // Output is neither streamed nor accumulated while suppressed,
+        //   matching single_thread_loop()
+        if (not suppress_output) {
+            if ((iteration_offset + i) % environment_rate == 0)
+                for (auto& c : clusters) c->launch_output();
+            else if (output_accumulation != NO_ACCUMULATION)
+                for (auto& c : clusters) c->launch_output_accumulation();
+        }
 
         motor_lock.pass(ENVIRONMENT_THREAD);
 
         // Check for errors
         device_check_error(nullptr);
 
-        // If engine gets interrupted, halt streams and break
-        if (Engine::interrupt_signaled) {
-            iterations = i;
+        // If engine gets interrupted, record the iterations run and break
+        if (this->interrupt_signaled) {
+            iterations = i + 1;
             break;
         }
 
@@ -372,14 +521,14 @@ void Engine::network_loop() {
 
 
         // Synchronize with the clock
-        if (time_limit > 0) iteration_timer.wait(time_limit);
+        if (time_limit > 0) pacer.wait();
     }
 
     // Wait for environment to terminate first
     term_lock.wait(NETWORK_THREAD);
 
     // Wait for scheduler to complete
-    Scheduler::get_instance()->wait_for_completion();
+    scheduler->wait_for_completion();
 
     // Final device synchronize
     device_synchronize();
@@ -391,6 +540,11 @@ void Engine::network_loop() {
     this->report = new Report(this, this->context.state,
         iterations, run_timer.query(nullptr));
 
+    // Report pacing statistics and performance counters
+    if (time_limit > 0) pacer.report(report);
+    for (auto region : perf_regions) region->report(report);
+    if (input_recorder != nullptr) input_recorder->report(report);
+
     // Allow modules to modify report
     for (auto& m : modules) m->report(report);
 
@@ -399,7 +553,7 @@ void Engine::network_loop() {
 
     // If iterrupted by GUI controls, main thread will handle
     // Otherwise, shut down GUI
-    if (not Engine::interrupt_from_gui)
+    if (not this->interrupt_from_gui)
         GuiController::quit();
 }
 
@@ -413,7 +567,8 @@ void Engine::environment_loop() {
         sensory_lock.wait(ENVIRONMENT_THREAD);
 
         for (auto& c : clusters) c->wait_for_input();
-        for (auto& m : modules)  m->feed_input(buffer);
+        module_pool->feed_input(buffer);
+        if (input_recorder != nullptr) input_recorder->record();
 
         sensory_lock.pass(NETWORK_THREAD);
 
@@ -423,22 +578,23 @@ void Engine::environment_loop() {
         motor_lock.wait(ENVIRONMENT_THREAD);
 
         // Stream output
-        if (i % environment_rate == 0 and not suppress_output) {
+        if ((iteration_offset + i) % environment_rate == 0
+                and not suppress_output) {
             for (auto& c : clusters) c->wait_for_output();
-            for (auto& m : modules)  m->report_output(buffer);
+            module_pool->report_output(buffer);
         }
 
         motor_lock.pass(NETWORK_THREAD);
 
         // Update environment
-        if (i % environment_rate == 0)
+        if ((iteration_offset + i) % environment_rate == 0)
             GuiController::update();
 
         // Cycle modules
-        for (auto& m : modules) m->cycle();
+        module_pool->cycle();
 
         // If engine gets interrupted, pass the locks and break
-        if (Engine::interrupt_signaled) {
+        if (this->interrupt_signaled) {
             sensory_lock.pass(NETWORK_THREAD);
             motor_lock.pass(NETWORK_THREAD);
             break;
@@ -449,28 +605,8 @@ void Engine::environment_loop() {
     term_lock.pass(NETWORK_THREAD);
 }
 
-/* Runs the engine:
- *   Determines active devices
- *   Builds state and transfers to devices
- *   Starts computation thread pool
- *   Extracts parameters
- *   Launches network/environment thread(s)
- *   Launches GUI
- *   Waits for threads
- *   Shuts down computation thread pool
- *   Generates report */
-Report* Engine::run(PropertyConfig args) {
-    // Register signal interrupt
-    signal(SIGINT, handle_interrupt);
-
-    {
-        std::unique_lock<std::mutex> lock(global_engine_lock);
-        if (Engine::running)
-            LOG_ERROR("Cannot run more than one engine at once!");
-        Engine::running = true;
-    }
-
-    // Determine device(s) to use
+/* Determines the device(s) to use from engine args */
+static std::set<DeviceID> get_devices(const PropertyConfig& args) {
     std::set<DeviceID> devices;
     try {
         if (args.has("devices"))
@@ -485,46 +621,177 @@ Report* Engine::run(PropertyConfig args) {
     } catch (...) {
         LOG_ERROR("Failed to extract devices from Engine args!");
     }
+    return devices;
+}
+
+/* Opens a session:
+ *   Determines active devices
+ *   Builds state and transfers to devices
+ *   Builds the engine
+ *   Starts computation thread pool
+ * Several engines may hold sessions at once, each with its own thread pool
+ * Interrupts signaled between steps halt the next step */
+void Engine::open(const PropertyConfig& args) {
+    // Register signal interrupt
+    signal(SIGINT, handle_interrupt);
+
+    {
+        std::unique_lock<std::mutex> lock(global_engine_lock);
+        Engine::open_engines.insert(this);
+    }
+    this->session_open = true;
+    this->session_args = new PropertyConfig(&args);
+
+    try {
+        // Build state and transfer
+        // This renders the engine outdated, so the engine must be rebuilt
+        this->devices = get_devices(args);
+        context.state->build(devices);
+        context.state->transfer_to_device();
+        this->rebuild(PropertyConfig(session_args));
+        this->iteration_offset = 0;
+
+        // Print network
+        if (args.get_bool("verbose", false)) context.network->print();
+
+        // Launch Scheduler thread pool
+        scheduler->start_thread_pool(
+            std::max(0, args.get_int("worker threads", 4)));
+
+        // Initialize parallel random states
+        init_rand(context.network->get_max_layer_size());
+        this->holds_rand = true;
+    } catch (...) {
+        this->close();
+        throw;
+    }
+}
+
+/* Closes the session:
+ *   Shuts down computation thread pool
+ *   Releases random states shared with other engines
+ * The engine itself stays built until it is cleared or destroyed */
+void Engine::close() {
+    if (not session_open) return;
+
+    // Shutdown the Scheduler thread pool
+    bool verbose = session_args->get_bool("verbose", false);
+    scheduler->shutdown_thread_pool(verbose);
+
+    // Clean up
+    if (holds_rand) free_rand();
+    this->holds_rand = false;
+    delete session_args;
+    session_args = nullptr;
+    session_open = false;
+
+    {
+        std::unique_lock<std::mutex> lock(global_engine_lock);
+        this->interrupt_signaled = false;
+        Engine::open_engines.erase(this);
+    }
+}
 
-    // Build state and transfer
-    // This renders the engine outdated, so the engine must be rebuilt as well
-    context.state->build(devices);
-    context.state->transfer_to_device();
-    this->rebuild(args);
+/* Steps the session:
+ *   Merges args into the session args
+ *   Rebuilds whatever the new args invalidate
+ *     - Devices: state, engine, and thread pool
+ *     - IO threads, input recording, output accumulation, or "rebuild"
+ *       (eg. after environment edits): engine and thread pool
+ *     - Worker threads: thread pool
+ *   Extracts parameters
+ *   Launches network/environment thread(s)
+ *   Launches GUI
+ *   Waits for threads
+ *   Generates report
+ * Modules, buffers, and iteration phase carry over from the previous step,
+ *   so consecutive steps behave like one long run */
+Report* Engine::step(const PropertyConfig& args) {
+    if (not session_open)
+        LOG_ERROR("Cannot step an engine without an open session!");
+
+    // Merge args, replacing devices as a whole
+    PropertyConfig *prev_args = session_args;
+    this->session_args = new PropertyConfig(prev_args);
+    if (args.has("devices") or args.has_array("devices")) {
+        if (session_args->has("devices"))
+            session_args->remove_property("devices");
+        if (session_args->has_array("devices"))
+            session_args->remove_array("devices");
+    }
+    for (auto pair : args.get())
+        session_args->set(pair.first, pair.second);
+    for (auto pair : args.get_arrays())
+        session_args->set_array(pair.first, pair.second);
+    if (session_args->has("rebuild"))
+        session_args->remove_property("rebuild");
+
+    // Determine what needs to be rebuilt
+    auto new_devices = get_devices(*session_args);
+    bool build_state = new_devices != devices;
+    bool build_engine = build_state
+        or args.get_bool("rebuild", false)
+        or session_args->get_int("io threads", 4)
+            != prev_args->get_int("io threads", 4)
+        or session_args->get("record input", "")
+            != prev_args->get("record input", "")
+        or session_args->get("output accumulation", "none")
+            != prev_args->get("output accumulation", "none");
+    bool build_pool = build_engine
+        or session_args->get_int("worker threads", 4)
+            != prev_args->get_int("worker threads", 4);
+    delete prev_args;
+
+    // The thread pool refers to engine streams, so it goes down first
+    if (build_pool)
+        scheduler->shutdown_thread_pool();
+
+    if (build_state) {
+        this->devices = new_devices;
+        context.state->build(devices);
+        context.state->transfer_to_device();
+    }
 
-    // Launch Scheduler thread pool
-    Scheduler::get_instance()->start_thread_pool(
-        std::max(0, args.get_int("worker threads", 4)));
+    if (build_engine) {
+        this->rebuild(PropertyConfig(session_args));
+        this->iteration_offset = 0;
+    }
+
+    if (build_pool) {
+        scheduler->start_thread_pool(
+            std::max(0, session_args->get_int("worker threads", 4)));
 
-    // Initialize parallel random states
-    init_rand(context.network->get_max_layer_size());
+        // Release this engine's random states before reacquiring them
+        if (holds_rand) free_rand();
+        init_rand(context.network->get_max_layer_size());
+        this->holds_rand = true;
+    }
 
     // Extract parameters
-    this->verbose = args.get_bool("verbose", false);
-    this->learning_flag = args.get_bool("learning flag", true);
-    this->suppress_output = args.get_bool("suppress output", false);
-    this->environment_rate = args.get_int("environment rate", 1);
-    this->refresh_rate = args.get_float("refresh rate", FLT_MAX);
+    this->verbose = session_args->get_bool("verbose", false);
+    build_perf_regions(session_args->get("perf counters", "none"));
+    this->learning_flag = session_args->get_bool("learning flag", true);
+    this->suppress_output = session_args->get_bool("suppress output", false);
+    this->environment_rate = session_args->get_int("environment rate", 1);
+    this->refresh_rate = session_args->get_float("refresh rate", FLT_MAX);
     if (this->refresh_rate == 0) this->refresh_rate = FLT_MAX;
     this->time_limit = (refresh_rate == FLT_MAX)
         ? 0 : (1.0 / this->refresh_rate);
+    this->pacing_spin = session_args->get_float("pacing spin", 0.0001);
 
     // If iterations is explicitly provided, use it
-    if (args.has("iterations"))
-        this->iterations = args.get_int("iterations", 1);
+    if (session_args->has("iterations"))
+        this->iterations = session_args->get_int("iterations", 1);
     else {
         // Otherwise, use the max of the expected iterations
-        this->iterations = 0;
-        for (auto module : modules)
-            this->iterations =
-                std::max(this->iterations, module->get_expected_iterations());
+        this->iterations = this->expected_iterations;
         if (this->iterations == 0)
             LOG_WARNING(
                 "Unspecified number of iterations -- running indefinitely.");
     }
 
     // Print network
-    if (this->verbose) context.network->print();
+    if (this->verbose and build_engine) context.network->print();
 
 
     // Ensure device is synchronized without errors
@@ -535,14 +802,14 @@ Report* Engine::run(PropertyConfig args) {
     auto mems = ResourceManager::get_instance()->get_memory_usage(verbose);
 
     // Launch threads
-    if (not Engine::interrupt_signaled) {
+    if (not this->interrupt_signaled) {
         // Set locks
         sensory_lock.set_owner(ENVIRONMENT_THREAD);
         motor_lock.set_owner(NETWORK_THREAD);
         term_lock.set_owner(ENVIRONMENT_THREAD);
 
         std::vector<std::thread> threads;
-        if (args.get_bool("multithreaded", true)) {
+        if (session_args->get_bool("multithreaded", true)) {
             // Separate engine & environment threads
             if (verbose) printf("\nLaunching multithreaded...\n\n");
             threads.push_back(std::thread(&Engine::network_loop, this));
@@ -560,32 +827,31 @@ Report* Engine::run(PropertyConfig args) {
         // Wait for threads
         for (auto& thread : threads)
             thread.join();
+    } else {
+        this->iterations = 0;
     }
 
-    bool interrupted = Engine::interrupt_signaled;
+    bool interrupted = this->interrupt_signaled;
     {
         std::unique_lock<std::mutex> lock(global_engine_lock);
         // If interrupted by GUI controls, the main thread must terminate GUI
-        if (Engine::interrupt_from_gui) {
+        if (this->interrupt_from_gui) {
             // signal=false
             GuiController::quit(false);
-            Engine::interrupt_from_gui = false;
+            this->interrupt_from_gui = false;
         }
-        Engine::interrupt_signaled = false;
-        Engine::running = false;
+        this->interrupt_signaled = false;
     }
 
-    // Shutdown the Scheduler thread pool
-    Scheduler::get_instance()->shutdown_thread_pool(verbose);
-
-    // Clean up
-    free_rand();
+    // Keep the environment rate phase for the next step
+    // Interrupted loops record the iterations they actually ran
+    this->iteration_offset += this->iterations;
 
     // Generate report
     Report* r = (interrupted and this->report == nullptr)
         ? new Report(this, this->context.state, 0, 0.0)
         : this->report;
-    r->set_child("args", &args);
+    r->set_child("args", session_args);
     r->set("interrupted", interrupted);
     for (auto mem : mems) r->add_to_child_array("memory usage", &mem);
 
@@ -594,3 +860,17 @@ Report* Engine::run(PropertyConfig args) {
 
     return r;
 }
+
+/* Runs the engine in a single step session */
+Report* Engine::run(PropertyConfig args) {
+    this->open(args);
+
+    try {
+        Report* r = this->step();
+        this->close();
+        return r;
+    } catch (...) {
+        this->close();
+        throw;
+    }
+}
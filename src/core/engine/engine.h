@@ -13,6 +13,8 @@
 #include "io/module.h"
 #include "util/constants.h"
 #include "util/timer.h"
+#include "util/pacer.h"
+#include "util/perf_counters.h"
 
 class Layer;
 class Report;
@@ -20,6 +22,17 @@ class State;
 class Cluster;
 class ClusterNode;
 class InterDeviceTransferInstruction;
+class ModulePool;
+class InputRecorder;
+class Scheduler;
+
+enum EnginePhase {
+    PRE_INPUT_PHASE,
+    POST_INPUT_PHASE,
+    STATE_UPDATE_PHASE,
+    WEIGHT_UPDATE_PHASE,
+    NUM_ENGINE_PHASES
+};
 
 enum Thread_ID {
     NETWORK_THREAD,
@@ -66,16 +79,33 @@ class Engine {
         // Run the engine
         Report* run(PropertyConfig args=PropertyConfig());
 
+        // Sessions keep the engine built between runs
+        // open() builds the state and engine, and starts the worker threads
+        // step() runs the engine, rebuilding only what its args change
+        // close() shuts down the worker threads
+        void open(const PropertyConfig& args=PropertyConfig());
+        Report* step(const PropertyConfig& args=PropertyConfig());
+        void close();
+        bool is_open() const { return session_open; }
+
         Buffer* get_buffer() { return buffer; }
         IOTypeMask get_io_type(Layer *layer) { return io_types[layer]; }
         KeySet get_input_keys(Layer* layer) { return input_keys[layer]; }
         KeySet get_output_keys(Layer* layer) { return output_keys[layer]; }
         bool is_input(Layer *layer) { return get_io_type(layer) & INPUT; }
         bool is_output(Layer *layer) { return get_io_type(layer) & OUTPUT; }
+        OutputAccumulation get_output_accumulation() const
+            { return output_accumulation; }
 
         size_t get_buffer_bytes() const;
+        int get_num_inter_device_transfers() const
+            { return inter_device_transfers.size(); }
 
-        // Interrupts engine
+        // Builds the environment modules without a state to size the buffer
+        static size_t estimate_buffer_bytes(
+            Network *network, Environment *environment);
+
+        // Interrupts all open engines
         static void interrupt(bool from_gui=false);
 
     protected:
@@ -94,36 +124,64 @@ class Engine {
         // Environment data
         Buffer* buffer;
         ModuleList modules;
+        ModulePool* module_pool;
+        InputRecorder* input_recorder;
         std::map<Layer*, IOTypeMask> io_types;
         bool suppress_output;
+        OutputAccumulation output_accumulation;
         LayerKeyMap input_keys;
         LayerKeyMap output_keys;
 
+        // Session data
+        // Args carry over between steps unless overridden
+        bool session_open;
+        PropertyConfig *session_args;
+        std::set<DeviceID> devices;
+        size_t iteration_offset;
+        bool holds_rand;
+
+        // Each engine schedules its streams on its own worker thread pool,
+        //   so that engines can run concurrently in one process
+        Scheduler *scheduler;
+
         // Running data
         Lock sensory_lock;
         Lock motor_lock;
         Lock term_lock;
         Timer run_timer;
-        Timer iteration_timer;
-        float refresh_rate, time_limit;
+        Pacer pacer;
+        float refresh_rate, time_limit, pacing_spin;
         int environment_rate;
         bool learning_flag;
 
         size_t iterations;
+        size_t expected_iterations;
         bool verbose;
         Report *report;
 
+        // Performance counters ("perf counters" arg)
+        //   "phases" counts the cluster launch phases
+        //   "instructions" also counts synapse and state update
+        //     instructions separately, which are then excluded from phases
+        std::vector<PerfRegion*> perf_regions;
+        PerfRegion* perf_phases[NUM_ENGINE_PHASES];
+        void build_perf_regions(std::string mode);
+        void clear_perf_regions();
+        void launch_phase(EnginePhase phase, void (Cluster::*launch)());
+
         // Thread loops
         bool multithreaded;
         void single_thread_loop();
         void network_loop();
         void environment_loop();
 
+        // Interruption flags, set for all open engines by interrupt()
+        bool interrupt_signaled;
+        bool interrupt_from_gui;
+
         // Static infrastructure for interruption
         static std::mutex global_engine_lock;
-        static bool interrupt_signaled;
-        static bool interrupt_from_gui;
-        static bool running;
+        static std::set<Engine*> open_engines;
 };
 
 #endif
@@ -1,8 +1,10 @@
 #ifndef instruction_h
 #define instruction_h
 
+#include <set>
 #include <vector>
 
+#include "network/network.h"
 #include "network/connection.h"
 #include "state/state.h"
 #include "state/attributes.h"
@@ -13,6 +15,7 @@
 #include "engine/kernel/attribute_data.h"
 #include "util/resources/scheduler.h"
 #include "util/transpose.h"
+#include "util/perf_counters.h"
 
 class Instruction {
     public:
@@ -22,12 +25,18 @@ class Instruction {
                   blocks(calc_blocks(layer->size)),
                   stream(stream),
                   event(nullptr),
-                  child(nullptr) { }
+                  child(nullptr),
+                  perf_region(nullptr) { }
         virtual ~Instruction() { }
 
         void activate() {
             Instruction::wait_for_dependencies();
-            this->activate_impl();
+            if (perf_region != nullptr) {
+                PerfScope scope(perf_region);
+                this->activate_impl();
+            } else {
+                this->activate_impl();
+            }
             Instruction::record_event();
         }
         virtual void activate_impl() = 0;
@@ -44,10 +53,7 @@ class Instruction {
                     stream->get_device_id());
         }
         void record_event() { if (event != nullptr) stream->record(event); }
-        void synchronize() {
-            if (event != nullptr)
-                Scheduler::get_instance()->synchronize(event);
-        }
+        void synchronize() { if (event != nullptr) event->synchronize(); }
 
         void add_dependency(Instruction *inst) {
             // Only add dependencies for instructions on different streams
@@ -72,6 +78,10 @@ class Instruction {
             this->add_dependency(inst);
         }
 
+        /* Sets the region that counts this instruction's computations
+         *   (see PerfCounters), overriding the region of the caller */
+        void set_perf_region(PerfRegion *region) { perf_region = region; }
+
         Layer* const to_layer;
 
     protected:
@@ -80,6 +90,7 @@ class Instruction {
         std::vector<Event*> dependencies;
         dim3 blocks, threads;
         Instruction *child;
+        PerfRegion *perf_region;
 };
 
 /* Inter-device connections transfer instruction */
@@ -94,10 +105,9 @@ class InterDeviceTransferInstruction : public Instruction {
                     "  InterDeviceTransferInstruction should only be used with"
                     " inter-device synaptic connections!");
 
-            int word_index = get_word_index(
-                conn->delay, Attributes::get_output_type(conn->from_layer));
-            src = state->get_output(conn->from_layer, word_index);
-            dst = state->get_device_output_buffer(conn, word_index);
+            auto endpoints = get_endpoints(conn, state);
+            src = endpoints.first;
+            dst = endpoints.second;
 
             DeviceID source_device = state->get_device_id(conn->from_layer);
             stream = ResourceManager::get_instance()
@@ -112,16 +122,37 @@ class InterDeviceTransferInstruction : public Instruction {
         }
 
         bool matches(Connection *conn, State *state) {
-            int word_index = get_word_index(
-                conn->delay, Attributes::get_output_type(conn->from_layer));
-            auto other_src = state->get_output(conn->from_layer, word_index);
-            auto other_dst = state->get_device_output_buffer(conn, word_index);
-
-            return this->src == other_src and this->dst == other_dst;
+            auto endpoints = get_endpoints(conn, state);
+            return this->src == endpoints.first
+                and this->dst == endpoints.second;
+        }
+
+        /* Counts the instructions an engine builds for |state|
+         * Connections share an instruction if they copy the same source
+         *   output into the same device buffer (see matches()) */
+        static int count(State *state) {
+            std::set<std::pair<Output*, Output*>> transfers;
+            for (auto conn : state->network->get_connections()) {
+                if (not state->is_inter_device(conn)) continue;
+                auto endpoints = get_endpoints(conn, state);
+                transfers.insert(std::make_pair(
+                    endpoints.first.get(), endpoints.second.get()));
+            }
+            return transfers.size();
         }
 
     protected:
         Pointer<Output> src, dst;
+
+        // Source output word and destination device buffer of |conn|
+        static std::pair<Pointer<Output>, Pointer<Output>> get_endpoints(
+                Connection *conn, State *state) {
+            int word_index = get_word_index(
+                conn->delay, Attributes::get_output_type(conn->from_layer));
+            return std::make_pair(
+                state->get_output(conn->from_layer, word_index),
+                state->get_device_output_buffer(conn, word_index));
+        }
 };
 
 /* Instructions that initialize the input without connections */
@@ -323,6 +354,11 @@ class SynapseActivateInstruction : public SynapseInstruction {
                     synapse_data);
         }
 
+        // Second order slaves aggregate starting from this buffer
+        void set_second_order_source(Pointer<float> source) {
+            synapse_data.second_order_source = source;
+        }
+
     protected:
         KernelList<SYNAPSE_ARGS> activators;
 };
@@ -488,14 +524,65 @@ class InputTransferInstruction : public BufferedTransferInstruction<float> {
         }
 };
 
-/* Transfers output data */
+/* Transfers output data, optionally accumulating it between transfers */
 class OutputTransferInstruction : public TransferInstruction<Output> {
     public:
         OutputTransferInstruction(Layer *layer, State *state,
             Engine *engine, Stream *stream)
                 : TransferInstruction(layer, stream,
                       state->get_output(layer),
-                      engine->get_buffer()->get_output(layer)) { }
+                      engine->get_buffer()->get_output(layer)),
+                  output_type(Attributes::get_output_type(layer)),
+                  accumulation(engine->get_output_accumulation()),
+                  accumulate_kernel(get_accumulate_output()),
+                  steps(0),
+                  transfer(true) {
+            // Outputs are accumulated on the layer's device, so that only
+            //   the result is transferred to the buffer
+            if (accumulation != NO_ACCUMULATION)
+                accumulator = Pointer<Output>::device_pointer(
+                    state->get_device_id(layer), layer->size);
+        }
+
+        virtual ~OutputTransferInstruction() { accumulator.free(); }
+
+        /* Accumulates outputs without transferring them to the buffer
+         * The next activation transfers everything accumulated since the
+         *   previous transfer */
+        void accumulate() {
+            transfer = false;
+            activate();
+            transfer = true;
+        }
+
+        void activate_impl() {
+            if (accumulation == NO_ACCUMULATION) {
+                TransferInstruction<Output>::activate_impl();
+                return;
+            }
+
+            ++steps;
+            float scale = (transfer and accumulation == AVERAGE_ACCUMULATION)
+                ? (1.0 / steps) : 1.0;
+            accumulate_kernel.schedule(stream, blocks, threads,
+                src, accumulator, to_layer->size,
+                output_type, accumulation, steps == 1, scale);
+
+            if (transfer) {
+                get_copy_pointer_kernel<Output>().schedule(
+                    stream, 0, 0, accumulator, dst, stream);
+                steps = 0;
+            }
+        }
+
+    protected:
+        OutputType output_type;
+        OutputAccumulation accumulation;
+        Kernel<Pointer<Output>, Pointer<Output>, int,
+            OutputType, OutputAccumulation, bool, float> accumulate_kernel;
+        Pointer<Output> accumulator;
+        int steps;
+        bool transfer;
 };
 
 /* Transfers auxiliary input data */
@@ -157,6 +157,61 @@ Kernel<Pointer<float>, int, float, float, bool, Pointer<float>>
         randomize_data_poisson_SERIAL, randomize_data_poisson_PARALLEL);
 }
 
+/* Accumulates outputs
+ * The first accumulation overwrites the accumulator, and the result is
+ *   multiplied by |scale| (to take averages on the last iteration) */
+HOST DEVICE inline void accumulate_output(Output src, Output& acc,
+        OutputType type, OutputAccumulation accumulation,
+        bool first, float scale) {
+    // The newest spike is in the most significant bit
+    unsigned int spike = src.i >> 31;
+
+    if (accumulation == COUNT_ACCUMULATION) {
+        unsigned int active = (type == BIT) ? spike
+            : (type == FLOAT) ? (src.f != 0.0) : (src.i != 0);
+        acc.i = (first) ? active : acc.i + active;
+    } else if (accumulation == AVERAGE_ACCUMULATION or type == FLOAT) {
+        float val = (type == BIT) ? spike
+            : (type == FLOAT) ? src.f : src.i;
+        acc.f = ((first) ? val : acc.f + val) * scale;
+    } else {
+        unsigned int val = (type == BIT) ? spike : src.i;
+        acc.i = (first) ? val : acc.i + val;
+    }
+}
+
+void accumulate_output_SERIAL(Pointer<Output> src_ptr,
+        Pointer<Output> acc_ptr, int size, OutputType type,
+        OutputAccumulation accumulation, bool first, float scale) {
+    Output* src = src_ptr.get();
+    Output* acc = acc_ptr.get();
+
+    _Pragma("omp parallel for")
+    for (int nid = 0; nid < size; ++nid)
+        accumulate_output(src[nid], acc[nid],
+            type, accumulation, first, scale);
+}
+GLOBAL void accumulate_output_PARALLEL(Pointer<Output> src_ptr,
+        Pointer<Output> acc_ptr, int size, OutputType type,
+        OutputAccumulation accumulation, bool first, float scale) {
+#ifdef __CUDACC__
+    Output* src = src_ptr.get();
+    Output* acc = acc_ptr.get();
+
+    int nid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (nid < size)
+        accumulate_output(src[nid], acc[nid],
+            type, accumulation, first, scale);
+#endif
+}
+Kernel<Pointer<Output>, Pointer<Output>, int,
+        OutputType, OutputAccumulation, bool, float>
+        get_accumulate_output() {
+    return Kernel<Pointer<Output>, Pointer<Output>, int,
+        OutputType, OutputAccumulation, bool, float>(
+            accumulate_output_SERIAL, accumulate_output_PARALLEL);
+}
+
 /* Dendritic tree internal computation */
 void calc_internal_SERIAL(int size, Pointer<float> src_ptr,
         Pointer<float> dst_ptr, AGGREGATOR aggregate, float trail_value) {
@@ -189,13 +244,8 @@ Kernel<int, Pointer<float>, Pointer<float>, AGGREGATOR,
 void transpose_matrix_serial(
         const Pointer<float> idata, Pointer<float> odata,
         const int original_rows, const int original_columns) {
-    float* in = idata.get();
-    float* out = odata.get();
-
-    _Pragma("omp parallel for collapse(2)")
-    for (int i = 0 ; i < original_rows ; ++i)
-        for (int j = 0 ; j < original_columns ; ++j)
-            out[(j*original_rows) + i] = in[(i*original_columns) + j];
+    transpose_matrix_host<float>(idata.get(), odata.get(),
+        original_rows, original_columns);
 }
 
 Kernel<const Pointer<float>, Pointer<float>,
@@ -28,6 +28,12 @@ class Kernel {
         /* Checks if kernel is null (no serial kernel */
         bool is_null() { return serial_kernel == nullptr; }
 
+        /* Checks if two kernels run the same functions */
+        bool operator==(const Kernel<ARGS...>& other) const {
+            return serial_kernel == other.serial_kernel
+                and parallel_kernel == other.parallel_kernel;
+        }
+
 
         /* Serial/Parallel agnostic functions */
         void run(Stream *stream, dim3 blocks, dim3 threads, ARGS... args);
@@ -67,6 +73,10 @@ Kernel<Pointer<float>, int, float, float, bool> get_randomize_data_normal();
 Kernel<Pointer<float>, int, float, float, bool, Pointer<float>>
     get_randomize_data_poisson();
 
+/* Accumulates outputs (see OutputAccumulation) */
+Kernel<Pointer<Output>, Pointer<Output>, int,
+    OutputType, OutputAccumulation, bool, float> get_accumulate_output();
+
 /* Dendritic tree internal computation */
 Kernel<int, Pointer<float>, Pointer<float>, AGGREGATOR, float>
     get_calc_internal();
@@ -9,6 +9,7 @@
 SynapseData::SynapseData(DendriticNode *parent_node,
     Connection *conn, State *state, bool updater) :
         attributes(state->get_attributes_pointer(conn->to_layer)),
+        from_attributes(state->get_attributes_pointer(conn->from_layer)),
         extractor(state->get_connection_extractor(conn)),
         aggregator(state->get_connection_aggregator(conn)),
         subset_config(conn->get_config()->get_subset_config()),
@@ -27,6 +28,10 @@ SynapseData::SynapseData(DendriticNode *parent_node,
                     parent_node->get_second_order_connection())
                 : nullptr),
         num_weights(conn->get_num_weights()),
+        second_order_source(
+            (conn->second_order_slave)
+                ? state->get_second_order_weights(parent_node)
+                : Pointer<float>()),
         inputs(state->get_input(conn->to_layer, parent_node->register_index)),
         destination_outputs(state->get_output(conn->to_layer)) {
     // Updaters can only use outputs if they are within the same feedforward
@@ -52,6 +57,7 @@ SynapseData::SynapseData(DendriticNode *parent_node,
 }
 SynapseData::SynapseData(WeightMatrix *matrix, Connection *conn) :
         attributes(nullptr),
+        from_attributes(nullptr),
         extractor(nullptr),
         aggregator(nullptr),
         subset_config(conn->get_config()->get_subset_config()),
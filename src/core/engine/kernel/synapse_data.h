@@ -26,6 +26,9 @@ class SynapseData {
         /* Attributes pointer for to_layer */
         const Attributes * const attributes;
 
+        /* Attributes pointer for from_layer */
+        const Attributes * const from_attributes;
+
         /* Output extractor */
         const EXTRACTOR extractor;
 
@@ -43,6 +46,12 @@ class SynapseData {
         Pointer<float> weights;
         const int num_weights;
 
+        /* Second order slaves aggregate into the host's second order weights
+         *   starting from this buffer.  This is usually the second order
+         *   weights themselves, but the first slave can read the host
+         *   weights in place instead of from a copy. */
+        Pointer<float> second_order_source;
+
         /* Layer attributes */
         const Layer from_layer;
         const Layer to_layer;
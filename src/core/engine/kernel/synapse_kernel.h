@@ -5,6 +5,7 @@
 #include "engine/kernel/synapse_data.h"
 #include "engine/kernel/extractor.h"
 #include "engine/kernel/aggregator.h"
+#include "state/weight_matrix.h"
 #include "util/parallel.h"
 #include "util/constants.h"
 #include "util/resources/pointer.h"
@@ -420,7 +421,71 @@ DEF_KERNELS(SPARSE, FUNC_NAME, EXTRACTIONS, \
     } \
 }
 
+/* Serial version using the boundary tables of the weight matrix
+ * Interior destinations use constant strides without any bounds checks.
+ * Border destinations look up wrapped source rows and columns. */
+#define CONVERGENT_TABLE_WEIGHT_LOOP(WEIGHT_INIT, WEIGHT_OP) \
+{ \
+    /* Determine starting row and column for source neurons */ \
+    int s_row = to_row * row_stride + (row_spacing * row_offset); \
+    int s_col = to_column * column_stride + (column_spacing * column_offset); \
+\
+    if (to_row >= interior_row_start and to_row < interior_row_end \
+            and to_column >= interior_column_start \
+            and to_column < interior_column_end) { \
+        for (int k_row = 0 ; k_row < row_field_size ; ++k_row) { \
+            int from_row = s_row + (k_row * row_spacing); \
+            int pre_wrap_from_row = from_row; \
+            int row_index = from_row * from_columns; \
+\
+            for (int k_col = 0 ; k_col < column_field_size ; ++k_col) { \
+                int k_index = k_row * column_field_size + k_col; \
+                int from_column = s_col + (k_col * column_spacing); \
+                int pre_wrap_from_column = from_column; \
+                int from_index = row_index + from_column; \
+\
+                WEIGHT_INIT; \
+\
+                WEIGHT_OP; \
+            } \
+        } \
+    } else { \
+        const int *row_entries = \
+            convergent_row_table + to_row * row_field_size; \
+        const int *column_entries = \
+            convergent_column_table + to_column * column_field_size; \
+\
+        for (int k_row = 0 ; k_row < row_field_size ; ++k_row) { \
+            int from_row = row_entries[k_row]; \
+            if (from_row < 0) continue; \
+            int pre_wrap_from_row = s_row + (k_row * row_spacing); \
+            int row_index = from_row * from_columns; \
+\
+            for (int k_col = 0 ; k_col < column_field_size ; ++k_col) { \
+                int from_column = column_entries[k_col]; \
+                if (from_column < 0) continue; \
+                int k_index = k_row * column_field_size + k_col; \
+                int pre_wrap_from_column = s_col + (k_col * column_spacing); \
+                int from_index = row_index + from_column; \
+\
+                WEIGHT_INIT; \
+\
+                WEIGHT_OP; \
+            } \
+        } \
+    } \
+}
+
 #define CONVERGENT_SERIAL_LOOP_OPEN \
+const int *convergent_row_table = \
+    synapse_data.matrix->convergent_row_table.get(); \
+const int *convergent_column_table = \
+    synapse_data.matrix->convergent_column_table.get(); \
+const int interior_row_start = synapse_data.matrix->interior_row_start; \
+const int interior_row_end = synapse_data.matrix->interior_row_end; \
+const int interior_column_start = synapse_data.matrix->interior_column_start; \
+const int interior_column_end = synapse_data.matrix->interior_column_end; \
+\
 _Pragma("omp parallel for collapse(2)") \
 for (int to_row = 0 ; to_row < to_rows ; ++to_row) { \
     for (int to_column = 0 ; to_column < to_columns ; ++to_column) { \
@@ -439,7 +504,7 @@ DEF_KERNELS(CONVERGENT, FUNC_NAME, EXTRACTIONS, \
         /*   or the index of the destination neuron otherwise */ \
         int weight_offset = (convolutional) ? 0 : (to_index * kernel_size); \
 \
-        CONVERGENT_WEIGHT_LOOP( \
+        CONVERGENT_TABLE_WEIGHT_LOOP( \
             int weight_index = weight_offset + k_index;, \
             WEIGHT_OP); \
     NEURON_POST; \
@@ -465,11 +530,11 @@ DEF_KERNELS(CONVERGENT, FUNC_NAME, EXTRACTIONS, \
     NEURON_PRE; \
         int weight_offset = (convolutional) ? 0 : (to_index * kernel_size); \
 \
-        CONVERGENT_WEIGHT_LOOP( \
+        CONVERGENT_TABLE_WEIGHT_LOOP( \
             int weight_index = weight_offset + k_index;, \
             WEIGHT_OP_1); \
     NEURON_MID; \
-        CONVERGENT_WEIGHT_LOOP( \
+        CONVERGENT_TABLE_WEIGHT_LOOP( \
             int weight_index = weight_offset + k_index;, \
             WEIGHT_OP_2); \
     NEURON_POST; \
@@ -917,12 +982,14 @@ CALC_ALL( \
 
 #define EXTRACT_SECOND_ORDER \
     float * const second_order_weights = \
-        synapse_data.second_order_host_matrix->second_order_weights.get();
+        synapse_data.second_order_host_matrix->second_order_weights.get(); \
+    const float * const second_order_source = \
+        synapse_data.second_order_source.get();
 
 #define CALC_VAL_SECOND_ORDER \
     float val = extract(outputs[from_index], delay) * weights[weight_index]; \
     second_order_weights[weight_index] = \
-        aggregate(second_order_weights[weight_index], val);
+        aggregate(second_order_source[weight_index], val);
 
 #define ACTIVATE_ALL_SECOND_ORDER(FUNC_NAME, UPDATE_EXT, UPDATE_CALC) \
 CALC_ALL(FUNC_NAME, \
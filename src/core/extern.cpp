@@ -256,6 +256,38 @@ ARRAY get_weight_matrix(STATE state, char* conn_name, char* key) {
     }
 }
 
+PROPS estimate_memory(NETWORK net, ENVIRONMENT env) {
+    try {
+        return State::estimate_memory((Network*)net, (Environment*)env);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+PROPS estimate_partition(NETWORK net, int num_devices, bool refine) {
+    try {
+        return State::estimate_partition((Network*)net, num_devices, refine);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+PROPS get_partition_report(STATE state, int num_devices) {
+    try {
+        return ((State*)state)->get_partition_report(num_devices);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+PROPS get_memory_report(STATE state) {
+    try {
+        return ((State*)state)->get_memory_report();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
 
 PROPS run(NETWORK net, ENVIRONMENT env, STATE state, PROPS args) {
     if (net == nullptr or state == nullptr) return nullptr;
@@ -278,6 +310,49 @@ PROPS run(NETWORK net, ENVIRONMENT env, STATE state, PROPS args) {
 #endif
 }
 
+SESSION open_session(NETWORK net, ENVIRONMENT env, STATE state, PROPS args) {
+    if (net == nullptr or state == nullptr) return nullptr;
+
+    Engine *engine = new Engine(Context(
+        (Network*)net,
+        (Environment*)env,
+        (State*)state));
+
+// Do not catch exceptions in debug mode (so they can be traced in gdb)
+#ifndef DEBUG
+    try {
+#endif
+        PropertyConfig empty;
+        engine->open((args == nullptr) ? empty : *((PropertyConfig*)args));
+        return engine;
+#ifndef DEBUG
+    } catch(...) {
+        delete engine;
+        return nullptr;
+    }
+#endif
+}
+
+PROPS step_session(SESSION session, PROPS args) {
+    if (session == nullptr) return nullptr;
+
+#ifndef DEBUG
+    try {
+#endif
+        PropertyConfig empty;
+        return ((Engine*)session)->step(
+            (args == nullptr) ? empty : *((PropertyConfig*)args));
+#ifndef DEBUG
+    } catch(...) {
+        return nullptr;
+    }
+#endif
+}
+
+void close_session(SESSION session) {
+    delete (Engine*)session;
+}
+
 
 extern "C" void destroy(void* obj) {
     delete obj;
@@ -358,6 +433,12 @@ void add_delay_weight_callback(char* name, long long addr) {
         (void (*)(int, int, void*, void*))(addr));
 }
 
+ARRAY get_io_view(char* name, int id, char* key) {
+    auto ptr = CallbackManager::get_instance()->get_io_view(name, id, key);
+    if (ptr == nullptr) return null_array();
+    return build_array(ptr, false);
+}
+
 void initialize_mpi() {
     mpi_wrap_init();
 }
@@ -28,6 +28,7 @@ typedef void* NETWORK;
 typedef void* ENVIRONMENT;
 typedef void* STATE;
 typedef void* PROPS;
+typedef void* SESSION;
 
 extern "C" PROPS create_properties();
 extern "C" void add_property(PROPS properties, char* key, char* val);
@@ -66,8 +67,29 @@ extern "C" ARRAY get_layer_data(
 extern "C" ARRAY get_connection_data(STATE state, char* conn_name, char* key);
 extern "C" ARRAY get_weight_matrix(STATE state, char* conn_name, char* key=nullptr);
 
+/* Memory breakdown by layer, connection, and buffer
+ *   The estimate only needs the network, so it can be checked before
+ *   building a state that may not fit.  The environment is optional, and
+ *   sizes the engine buffer (see State::estimate_memory()). */
+extern "C" PROPS estimate_memory(NETWORK net, ENVIRONMENT env);
+extern "C" PROPS get_memory_report(STATE state);
+
+/* Layer partition over a number of virtual devices
+ *   The report variant builds the state over the virtual devices, and
+ *   also counts the transfer instructions an engine would build. */
+extern "C" PROPS estimate_partition(NETWORK net, int num_devices, bool refine);
+extern "C" PROPS get_partition_report(STATE state, int num_devices);
+
 extern "C" PROPS run(NETWORK net, ENVIRONMENT env, STATE state, PROPS args);
 
+/* Sessions keep the engine, its worker threads, and the built state alive
+ *   between runs.  Args passed to a step override those of the session.
+ *   The network, environment, and state must outlive the session. */
+extern "C" SESSION open_session(
+    NETWORK net, ENVIRONMENT env, STATE state, PROPS args);
+extern "C" PROPS step_session(SESSION session, PROPS args);
+extern "C" void close_session(SESSION session);
+
 extern "C" void destroy(void* obj);
 extern "C" void destroy_network(NETWORK net);
 extern "C" void destroy_environment(ENVIRONMENT env);
@@ -91,6 +113,11 @@ extern "C" void add_indices_weight_callback(char* name, long long addr);
 extern "C" void add_distance_weight_callback(char* name, long long addr);
 extern "C" void add_delay_weight_callback(char* name, long long addr);
 
+/* Callback modules publish each IO slot (or batch history block) once
+ *   as a stable view.  Views are valid until the engine is torn down,
+ *   so they can be wrapped once and reused across callbacks. */
+extern "C" ARRAY get_io_view(char* name, int id, char* key);
+
 extern "C" void initialize_mpi();
 extern "C" int get_mpi_rank();
 extern "C" int get_mpi_size();
@@ -202,6 +202,7 @@ bool Buffer::get_input_dirty(Layer *layer) const {
 }
 bool Buffer::set_input_dirty(Layer *layer, bool dirty) {
     input_dirty_map[layer] = dirty;
+    return dirty;
 }
 
 bool Buffer::get_auxiliary_dirty(Layer *layer, std::string key) const {
@@ -216,4 +217,5 @@ bool Buffer::get_auxiliary_dirty(Layer *layer, std::string key) const {
 bool Buffer::set_auxiliary_dirty(Layer *layer, std::string key,
         bool dirty) {
     auxiliary_dirty_map[layer][key] = dirty;
+    return dirty;
 }
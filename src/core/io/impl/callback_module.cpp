@@ -1,12 +1,19 @@
+#include <cstring>
+
 #include "io/impl/callback_module.h"
 #include "util/callback_manager.h"
 
 REGISTER_MODULE(CallbackModule, "callback");
 
 CallbackModule::CallbackModule(LayerList layers, ModuleConfig *config)
-        : Module(layers, config) {
+        : Module(layers, config), input_row(0), output_row(0) {
     enforce_specified_io_type("callback");
     this->clear_first = config->get_bool("clear", false);
+    this->batch = config->get_int("batch", 1);
+
+    if (this->batch < 1)
+        LOG_ERROR("Error in CallbackModule:\n"
+            "  Batch size must be >= 1!");
 
     for (auto layer : layers) {
         auto layer_config = config->get_layer(layer);
@@ -15,8 +22,9 @@ CallbackModule::CallbackModule(LayerList layers, ModuleConfig *config)
         if (not layer_config->has("function"))
             LOG_ERROR("Unspecified callback function for layer "
                 + layer->str() + " in CallbackModule!");
+        functions[layer] = layer_config->get("function");
         callbacks[layer] = CallbackManager::get_instance()->get_io_callback(
-            layer_config->get("function"));
+            functions[layer]);
 
         // Get id
         if (not layer_config->has("id"))
@@ -26,26 +34,99 @@ CallbackModule::CallbackModule(LayerList layers, ModuleConfig *config)
     }
 }
 
+CallbackModule::~CallbackModule() {
+    // Modules are destroyed when a run (or session) ends, or when the engine
+    //   is rebuilt, so this is where the last partial batch is delivered
+    flush_output();
+
+    auto manager = CallbackManager::get_instance();
+    for (auto pair : views)
+        for (auto key_view : pair.second)
+            manager->remove_io_view(
+                functions[pair.first], ids[pair.first], key_view.first);
+    for (auto block : blocks) {
+        block->free();
+        delete block;
+    }
+}
+
+/* Views are published once per layer/key, the first time they are used.
+ * With a batch size of one, the buffer slot itself is the view.  Otherwise,
+ *   a history block of |batch| rows is allocated, and rows are copied between
+ *   it and the buffer slot every iteration. */
+BasePointer* CallbackModule::get_view(Layer *layer, std::string key,
+        BasePointer *ptr) {
+    auto& layer_views = views[layer];
+    auto it = layer_views.find(key);
+    if (it != layer_views.end()) return it->second;
+
+    BasePointer* view = ptr;
+    if (batch > 1) {
+        view = new Pointer<float>(batch * ptr->get_size(), 0.0);
+        blocks.push_back(view);
+    }
+
+    layer_views[key] = view;
+    CallbackManager::get_instance()->add_io_view(
+        functions[layer], ids[layer], key, view);
+    return view;
+}
+
 void CallbackModule::feed_input_impl(Buffer *buffer) {
     for (auto layer : layers) {
         if (get_io_type(layer) & INPUT) {
             for (auto& key : get_input_keys(layer)) {
                 auto ptr = buffer->get_input_auxiliary(layer, key);
-                if (this->clear_first)
-                    fClear((float*)ptr->get(), ptr->get_size());
+                auto view = get_view(layer, key, ptr);
+
+                // Fill the whole block at the start of each batch
+                if (input_row == 0) {
+                    if (this->clear_first)
+                        fClear((float*)view->get(), view->get_size());
+                    callbacks[layer](ids[layer],
+                        view->get_size(), view->get());
+                }
 
-                callbacks[layer](ids[layer], layer->size, ptr->get());
+                if (view != ptr)
+                    memcpy(ptr->get(),
+                        (char*)view->get() + input_row * ptr->get_bytes(),
+                        ptr->get_bytes());
             }
         }
     }
+    input_row = (input_row + 1) % batch;
 }
 
 void CallbackModule::report_output_impl(Buffer *buffer) {
     for (auto layer : layers) {
         if (get_io_type(layer) & OUTPUT) {
-            for (auto& key : get_output_keys(layer))
-                callbacks[layer](ids[layer], layer->size,
-                    buffer->get_output_auxiliary(layer, key)->get());
+            for (auto& key : get_output_keys(layer)) {
+                auto ptr = buffer->get_output_auxiliary(layer, key);
+                auto view = get_view(layer, key, ptr);
+
+                if (view != ptr)
+                    memcpy((char*)view->get() + output_row * ptr->get_bytes(),
+                        ptr->get(), ptr->get_bytes());
+
+                // Hand over the block once it is full
+                if (output_row == batch - 1)
+                    callbacks[layer](ids[layer],
+                        view->get_size(), view->get());
+            }
         }
     }
+    output_row = (output_row + 1) % batch;
+}
+
+void CallbackModule::flush_output() {
+    if (output_row == 0) return;
+
+    for (auto layer : layers)
+        if (get_io_type(layer) & OUTPUT)
+            for (auto pair : views[layer])
+                if (get_output_keys(layer).count(pair.first))
+                    callbacks[layer](ids[layer],
+                        output_row * (pair.second->get_size() / batch),
+                        pair.second->get());
+    output_row = 0;
 }
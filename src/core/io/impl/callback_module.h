@@ -6,14 +6,31 @@
 class CallbackModule : public Module {
     public:
         CallbackModule(LayerList layers, ModuleConfig *config);
+        virtual ~CallbackModule();
+
+        // Callbacks may call into interpreters or other shared state,
+        //   so they only run concurrently when marked "thread safe"
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", false); }
 
         void feed_input_impl(Buffer *buffer);
         void report_output_impl(Buffer *buffer);
 
     protected:
+        BasePointer* get_view(Layer *layer, std::string key, BasePointer *ptr);
+
+        // Hands over partially filled output blocks
+        void flush_output();
+
         std::map<Layer*, void (*)(int, int, void*)> callbacks;
+        std::map<Layer*, std::string> functions;
         std::map<Layer*, int> ids;
+        std::map<Layer*, std::map<std::string, BasePointer*>> views;
+        std::vector<BasePointer*> blocks;
         bool clear_first;
+        int batch;
+        int input_row;
+        int output_row;
 
     MODULE_MEMBERS
 };
@@ -9,6 +9,9 @@ class CSVReaderModule : public Module {
         CSVReaderModule(LayerList layers, ModuleConfig *config);
         virtual ~CSVReaderModule();
 
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
         virtual size_t get_expected_iterations() const
             { return epochs * exposure * num_rows; }
 
@@ -40,6 +43,10 @@ class CSVExpectedModule : public CSVReaderModule {
     public:
         CSVExpectedModule(LayerList layers, ModuleConfig *config);
 
+        // Expected values are consumed by other modules (eg. evaluators)
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", false); }
+
         void feed_input_impl(Buffer *buffer);
 
     MODULE_MEMBERS
@@ -59,6 +66,10 @@ class CSVEvaluatorModule : public CSVExpectedModule {
     public:
         CSVEvaluatorModule(LayerList layers, ModuleConfig *config);
 
+        // Prints statistics to stdout
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", false); }
+
         void report_output_impl(Buffer *buffer);
         void report(Report *report);
 
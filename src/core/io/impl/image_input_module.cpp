@@ -5,6 +5,34 @@
 
 REGISTER_MODULE(ImageInputModule, "image_input");
 
+void convert_image(const unsigned char *data, int size, int spectrum,
+        float scale, float *gray, float *red, float *green, float *blue) {
+    const float factor = scale / 255.0;
+
+    if (spectrum < 3) {
+        float *planes[] = { gray, red, green, blue };
+        for (auto plane : planes)
+            if (plane != nullptr)
+                for (int i = 0 ; i < size ; ++i)
+                    plane[i] = factor * data[i];
+        return;
+    }
+
+    const unsigned char *r = data;
+    const unsigned char *g = data + size;
+    const unsigned char *b = data + 2 * size;
+
+    if (red != nullptr)
+        for (int i = 0 ; i < size ; ++i) red[i] = factor * r[i];
+    if (green != nullptr)
+        for (int i = 0 ; i < size ; ++i) green[i] = factor * g[i];
+    if (blue != nullptr)
+        for (int i = 0 ; i < size ; ++i) blue[i] = factor * b[i];
+    if (gray != nullptr)
+        for (int i = 0 ; i < size ; ++i)
+            gray[i] = factor * (0.299f * r[i] + 0.587f * g[i] + 0.114f * b[i]);
+}
+
 ImageInputModule::ImageInputModule(LayerList layers, ModuleConfig *config)
         : Module(layers, config), transferred(false) {
     enforce_equal_layer_sizes("image_input");
@@ -44,19 +72,8 @@ ImageInputModule::ImageInputModule(LayerList layers, ModuleConfig *config)
         this->blue = Pointer<float>(width * height);
 
         // Extract values from image
-        for (int r = 0; r < height; r++) {
-            for (int c = 0; c < width; c++) {
-                float red = scale * (float)img(c,r,0,0) / 255.0;
-                float green = scale * (float)img(c,r,0,1) / 255.0;
-                float blue = scale * (float)img(c,r,0,2) / 255.0;
-
-                int index = (r*width) + c;
-                this->gray[index] = (0.299*red + 0.587*green + 0.114*blue);
-                this->red[index] = red;
-                this->green[index] = green;
-                this->blue[index] = blue;
-            }
-        }
+        convert_image(img.data(), width * height, img.spectrum(), scale,
+            this->gray, this->red, this->green, this->blue);
     } catch (cimg_library::CImgIOException e) {
         LOG_ERROR(
             "Image " + filename + " could not be opened!\n");
@@ -67,10 +84,10 @@ void ImageInputModule::feed_input_impl(Buffer *buffer) {
     if (not this->transferred) {
         for (auto layer : layers) {
             switch (channel_map[layer]) {
-                case GRAY:  buffer->set_input(layer, this->gray);
-                case RED:   buffer->set_input(layer, this->red);
-                case GREEN: buffer->set_input(layer, this->green);
-                case BLUE:  buffer->set_input(layer, this->blue);
+                case GRAY:  buffer->set_input(layer, this->gray);  break;
+                case RED:   buffer->set_input(layer, this->red);   break;
+                case GREEN: buffer->set_input(layer, this->green); break;
+                case BLUE:  buffer->set_input(layer, this->blue);  break;
             }
             this->transferred = true;
         }
@@ -11,6 +11,12 @@ typedef enum Channel {
     GRAY
 } Channel;
 
+/* Converts a planar 8-bit image (as decoded by CImg) into float channel
+ *   planes scaled to [0, scale].  Null planes are skipped.
+ * Images with fewer than three channels are treated as gray.
+ * Each plane is a separate contiguous loop, so conversions vectorize. */
+void convert_image(const unsigned char *data, int size, int spectrum,
+    float scale, float *gray, float *red, float *green, float *blue);
 
 class ImageInputModule : public Module {
     public:
@@ -22,6 +28,9 @@ class ImageInputModule : public Module {
             this->blue.free();
         }
 
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
         void feed_input_impl(Buffer *buffer);
 
     private:
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <fstream>
+#include <dirent.h>
+#include <glob.h>
+
+#include "io/impl/image_sequence_input_module.h"
+
+#define cimg_display 0
+#include "CImg.h"
+
+REGISTER_MODULE(ImageSequenceInputModule, "image_sequence_input");
+
+static bool is_image_file(std::string name) {
+    static const std::vector<std::string> extensions =
+        { ".bmp", ".png", ".jpg", ".jpeg", ".gif",
+          ".ppm", ".pgm", ".pnm", ".tif", ".tiff" };
+
+    auto dot = name.rfind('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = name.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return std::find(extensions.begin(), extensions.end(), ext)
+        != extensions.end();
+}
+
+static std::vector<std::string> list_directory(std::string directory) {
+    std::vector<std::string> filenames;
+    DIR *dir = opendir(directory.c_str());
+    if (dir == nullptr)
+        LOG_ERROR(
+            "Could not open image directory: " + directory);
+
+    while (auto entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name[0] != '.' and is_image_file(name))
+            filenames.push_back(directory + "/" + name);
+    }
+    closedir(dir);
+
+    std::sort(filenames.begin(), filenames.end());
+    return filenames;
+}
+
+static std::vector<std::string> list_pattern(std::string pattern) {
+    std::vector<std::string> filenames;
+    glob_t results;
+
+    // Results are sorted by glob()
+    if (glob(pattern.c_str(), 0, nullptr, &results) == 0)
+        for (size_t i = 0 ; i < results.gl_pathc ; ++i)
+            filenames.push_back(results.gl_pathv[i]);
+    globfree(&results);
+    return filenames;
+}
+
+static std::vector<std::string> list_file(std::string list) {
+    std::vector<std::string> filenames;
+    std::ifstream file(list.c_str());
+    if (not file.good())
+        LOG_ERROR(
+            "Could not open image list: " + list);
+
+    auto slash = list.rfind('/');
+    std::string base = (slash == std::string::npos)
+        ? "" : list.substr(0, slash + 1);
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line == "" or line[0] == '#') continue;
+        filenames.push_back((line[0] == '/') ? line : base + line);
+    }
+    return filenames;
+}
+
+ImageSequenceInputModule::ImageSequenceInputModule(
+        LayerList layers, ModuleConfig *config)
+        : Module(layers, config),
+          next_decode(0),
+          next_feed(0),
+          stalls(0),
+          running(true) {
+    enforce_equal_layer_sizes("image_sequence_input");
+    set_io_type(INPUT);
+
+    this->exposure = config->get_int("exposure", 1);
+    this->epochs = config->get_int("epochs", 1);
+    this->scale = config->get_float("scale", 1);
+    this->resize = config->get_bool("resize", false);
+    int prefetch = config->get_int("prefetch", 8);
+    int num_threads = config->get_int("decode threads", 2);
+
+    if (config->has("directory"))
+        filenames = list_directory(config->get("directory"));
+    else if (config->has("pattern"))
+        filenames = list_pattern(config->get("pattern"));
+    else if (config->has("list"))
+        filenames = list_file(config->get("list"));
+    else
+        LOG_ERROR(
+            "Unspecified directory, pattern, or list for "
+            "image sequence input module!");
+
+    if (filenames.size() == 0)
+        LOG_ERROR(
+            "No images found for image sequence input module!");
+    if (exposure < 1)
+        LOG_ERROR(
+            "Bad exposure length in image sequence input module!");
+    if (prefetch < 1 or num_threads < 1)
+        LOG_ERROR(
+            "Bad prefetch parameters in image sequence input module!");
+
+    // Check layer rows/columns and assign channels
+    this->rows = layers.at(0)->rows;
+    this->columns = layers.at(0)->columns;
+    for (int i = 0 ; i < 4 ; ++i) channels[i] = false;
+    for (auto layer : layers) {
+        if (layer->rows != rows or layer->columns != columns)
+            LOG_ERROR(
+                "Layers in image sequence input module must have "
+                "equal dimensions!");
+
+        auto channel =
+            config->get_layer(layer)->get("channel", "gray");
+        if (channel == "gray")       channel_map[layer] = GRAY;
+        else if (channel == "red")   channel_map[layer] = RED;
+        else if (channel == "green") channel_map[layer] = GREEN;
+        else if (channel == "blue")  channel_map[layer] = BLUE;
+        else
+            LOG_ERROR(
+                "Unrecognized image channel: " + channel);
+        channels[channel_map[layer]] = true;
+    }
+
+    // Allocate frames and launch decoders
+    frames.resize(prefetch);
+    for (auto& frame : frames) {
+        frame.ready = false;
+        for (int i = 0 ; i < 4 ; ++i)
+            if (channels[i])
+                frame.planes[i] = Pointer<float>(rows * columns);
+    }
+
+    // Decode the first image here, so that configuration errors (eg. size
+    //   mismatches) are raised while the environment is built
+    decode(frames[0], filenames[0]);
+    if (frames[0].error != "") {
+        for (auto& frame : frames)
+            for (int i = 0 ; i < 4 ; ++i)
+                frame.planes[i].free();
+        LOG_ERROR(frames[0].error);
+    }
+    frames[0].sequence = 0;
+    frames[0].ready = true;
+    next_decode = 1;
+
+    for (int i = 0 ; i < num_threads ; ++i)
+        threads.push_back(
+            std::thread(&ImageSequenceInputModule::worker_loop, this));
+}
+
+ImageSequenceInputModule::~ImageSequenceInputModule() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        running = false;
+    }
+    free_cv.notify_all();
+    for (auto& thread : threads)
+        if (thread.joinable()) thread.join();
+
+    for (auto& frame : frames)
+        for (int i = 0 ; i < 4 ; ++i)
+            frame.planes[i].free();
+}
+
+void ImageSequenceInputModule::decode(Frame& frame, std::string filename) {
+    // Errors are reported when the frame is fed
+    frame.error = "";
+
+    try {
+        cimg_library::CImg<unsigned char> img(filename.c_str());
+
+        if (img.width() != columns or img.height() != rows) {
+            if (not resize) {
+                frame.error = "Image " + filename
+                    + " size does not match layer size!";
+                return;
+            }
+
+            // Linear interpolation
+            img.resize(columns, rows, -100, -100, 3);
+        }
+
+        convert_image(img.data(), rows * columns, img.spectrum(), scale,
+            frame.planes[GRAY], frame.planes[RED],
+            frame.planes[GREEN], frame.planes[BLUE]);
+    } catch (cimg_library::CImgException& e) {
+        frame.error = "Image " + filename + " could not be opened!";
+    }
+}
+
+void ImageSequenceInputModule::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (running) {
+        // Wait for a free frame
+        if (next_decode >= next_feed + frames.size()) {
+            free_cv.wait(lock);
+            continue;
+        }
+
+        // The previous user of the frame has been fed, so it can be reused
+        size_t sequence = next_decode++;
+        Frame& frame = frames[sequence % frames.size()];
+        lock.unlock();
+
+        decode(frame, filenames[sequence % filenames.size()]);
+
+        lock.lock();
+        frame.sequence = sequence;
+        frame.ready = true;
+        decoded_cv.notify_all();
+    }
+}
+
+void ImageSequenceInputModule::feed_input_impl(Buffer *buffer) {
+    if (curr_iteration % exposure != 0) return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    Frame& frame = frames[next_feed % frames.size()];
+    if (not (frame.ready and frame.sequence == next_feed)) {
+        ++stalls;
+        while (not (frame.ready and frame.sequence == next_feed))
+            decoded_cv.wait(lock);
+    }
+    lock.unlock();
+
+    // Later errors can't be raised on the environment thread, so the
+    //   previous image stays in place
+    if (frame.error != "")
+        LOG_WARNING(frame.error);
+    else
+        for (auto layer : layers)
+            buffer->set_input(layer, frame.planes[channel_map[layer]]);
+
+    // Release the frame to the decoders
+    lock.lock();
+    frame.ready = false;
+    ++next_feed;
+    free_cv.notify_all();
+}
+
+void ImageSequenceInputModule::report(Report *report) {
+    for (auto layer : layers) {
+        PropertyConfig props;
+        props.set("images", std::to_string(filenames.size()));
+        props.set("frames", std::to_string(next_feed));
+        props.set("stalls", std::to_string(stalls));
+        report->add_report(this, layer, props);
+    }
+}
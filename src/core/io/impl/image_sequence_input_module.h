@@ -0,0 +1,76 @@
+#ifndef image_sequence_input_module_h
+#define image_sequence_input_module_h
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "io/module.h"
+#include "io/impl/image_input_module.h"
+#include "util/resources/pointer.h"
+
+/* Presents a sequence of images, each for "exposure" iterations
+ * Images are listed by one of:
+ *   "directory"  image files in a directory, in sorted order
+ *   "pattern"    a glob pattern, in sorted order
+ *   "list"       a file with one path per line (relative to the list)
+ *
+ * Images are decoded, resized ("resize") and converted ahead of time by
+ *   "decode threads" workers into a ring of "prefetch" frames, so feeding
+ *   input only copies the converted channels.  The sequence repeats after
+ *   the last image; "epochs" only sets the expected iterations.
+ */
+class ImageSequenceInputModule : public Module {
+    public:
+        ImageSequenceInputModule(LayerList layers, ModuleConfig *config);
+        virtual ~ImageSequenceInputModule();
+
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
+        virtual size_t get_expected_iterations() const
+            { return epochs * exposure * filenames.size(); }
+
+        void feed_input_impl(Buffer *buffer);
+        void report(Report *report);
+
+    protected:
+        /* Decoded image, with a plane for each channel in use */
+        class Frame {
+            public:
+                size_t sequence;
+                bool ready;
+                std::string error;
+                Pointer<float> planes[4];
+        };
+
+        void decode(Frame& frame, std::string filename);
+        void worker_loop();
+
+        std::vector<std::string> filenames;
+        int exposure;
+        int epochs;
+        float scale;
+        bool resize;
+        int rows, columns;
+        bool channels[4];
+        std::map<Layer*, Channel> channel_map;
+
+        // Prefetch ring
+        // Workers decode sequence numbers up to |prefetch| ahead of the
+        //   next frame to be fed, possibly out of order
+        std::vector<Frame> frames;
+        size_t next_decode;
+        size_t next_feed;
+        size_t stalls;
+        bool running;
+        std::mutex mutex;
+        std::condition_variable decoded_cv;
+        std::condition_variable free_cv;
+        std::vector<std::thread> threads;
+
+    MODULE_MEMBERS
+};
+
+#endif
@@ -1,11 +1,119 @@
 #ifdef __MPI__
 
+#include <algorithm>
 #include <string>
 #include "io/impl/mpi_module.h"
 
 REGISTER_MODULE(MPIModule, "mpi");
 REGISTER_MODULE(MPILockstepModule, "mpi lockstep");
 
+/* Compressed message segments
+ * Each layer is packed into a segment with a four word header:
+ *   [tag] [encoding] [count] [steps]
+ *
+ * RAW segments contain |count| Output words.
+ * SPIKE segments contain the neurons whose |steps| most recent history bits
+ *   are nonzero.  If |steps| is one, only the neuron indices are sent.
+ *   Otherwise, index/bits pairs are sent.  The receiver shifts its copy of
+ *   the history by |steps| and merges in the new bits. */
+#define SEGMENT_HEADER_SIZE 4
+#define SEGMENT_RAW 0
+#define SEGMENT_SPIKES 1
+
+/* Maximum size of a segment (RAW is never larger than SPIKES) */
+static int get_max_segment_size(Layer *layer) {
+    return SEGMENT_HEADER_SIZE + layer->size;
+}
+
+/* Packs a layer's output into a segment, returning the segment size */
+static int pack_segment(unsigned int* dst, int tag, Layer *layer,
+        OutputType output_type, const Output* src, int steps) {
+    int size = layer->size;
+    unsigned int* payload = dst + SEGMENT_HEADER_SIZE;
+    dst[0] = tag;
+
+    // Spike histories can only be delta encoded for a partial word
+    //   of new history (first report sends full words)
+    // Fall back to raw words if the list would not be smaller
+    if (output_type == BIT and steps > 0 and steps < 32) {
+        const unsigned int mask = ~0u << (32 - steps);
+        const int entry_size = (steps == 1) ? 1 : 2;
+        int count = 0;
+        int payload_size = 0;
+        bool overflow = false;
+
+        for (int i = 0 ; i < size ; ++i) {
+            unsigned int bits = src[i].i & mask;
+            if (bits) {
+                if (payload_size + entry_size >= size) {
+                    overflow = true;
+                    break;
+                }
+                payload[payload_size] = i;
+                if (entry_size == 2) payload[payload_size + 1] = bits;
+                payload_size += entry_size;
+                ++count;
+            }
+        }
+
+        if (not overflow) {
+            dst[1] = SEGMENT_SPIKES;
+            dst[2] = count;
+            dst[3] = steps;
+            return SEGMENT_HEADER_SIZE + payload_size;
+        }
+    }
+
+    dst[1] = SEGMENT_RAW;
+    dst[2] = size;
+    dst[3] = 0;
+    if (src == nullptr)
+        for (int i = 0 ; i < size ; ++i) payload[i] = 0;
+    else
+        for (int i = 0 ; i < size ; ++i) payload[i] = src[i].i;
+    return SEGMENT_HEADER_SIZE + size;
+}
+
+/* Unpacks a segment into a layer's history, returning the segment size */
+static int unpack_segment(const unsigned int* src, Layer *layer,
+        Output* history) {
+    int size = layer->size;
+    const unsigned int* payload = src + SEGMENT_HEADER_SIZE;
+    int count = src[2];
+    int steps = src[3];
+
+    if (src[1] == SEGMENT_RAW) {
+        if (count != size)
+            LOG_ERROR("Mismatched MPI segment size for layer "
+                + layer->str() + " in MPIModule!");
+        for (int i = 0 ; i < size ; ++i) history[i].i = payload[i];
+        return SEGMENT_HEADER_SIZE + size;
+    } else if (src[1] == SEGMENT_SPIKES) {
+        if (steps > 0)
+            for (int i = 0 ; i < size ; ++i) history[i].i >>= steps;
+
+        if (steps == 1) {
+            for (int i = 0 ; i < count ; ++i)
+                history[payload[i]].i |= 0x80000000u;
+            return SEGMENT_HEADER_SIZE + count;
+        } else {
+            for (int i = 0 ; i < count ; ++i)
+                history[payload[2 * i]].i |= payload[2 * i + 1];
+            return SEGMENT_HEADER_SIZE + 2 * count;
+        }
+    }
+
+    LOG_ERROR("Unrecognized MPI segment encoding for layer "
+        + layer->str() + " in MPIModule!");
+}
+
+/* Checks whether |sub| appears as a contiguous run within |super| */
+static bool is_contiguous(const std::vector<int>& sub,
+        const std::vector<int>& super) {
+    return std::search(super.begin(), super.end(),
+        sub.begin(), sub.end()) != super.end();
+}
+
 /* Identifies keys where one value is a subset of the other */
 static std::map<int, int> find_subsets(std::map<int, std::vector<int>> tags) {
     auto output = std::map<int, int>();
@@ -63,11 +171,19 @@ static std::map<int, int> find_subsets(std::map<int, std::vector<int>> tags) {
 }
 
 MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
-        : Module(layers, config) {
+        : Module(layers, config),
+          last_report_iteration(-1),
+          words_sent(0),
+          messages_sent(0) {
     // Each layer should have a specified and unique IO type (input or output)
     enforce_specified_io_type("mpi");
     enforce_unique_io_type("mpi");
 
+    // Both options change the message protocol,
+    //   so all ranks must use the same settings
+    this->overlap = config->get_bool("overlap", false);
+    this->compress = config->get_bool("compress", false);
+
     this->mpi_rank = mpi_wrap_get_rank();
     int mpi_size = mpi_wrap_get_size();
 
@@ -122,10 +238,18 @@ MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
 
         // Create buffer for the source
         int size = 0;
-        for (auto& layer : ltags)
-            size += layer_tags[layer]->size;
+        for (auto& tag : ltags)
+            size += (compress)
+                ? get_max_segment_size(layer_tags[tag])
+                : layer_tags[tag]->size;
         input_buffers[source] = Pointer<float>(size, 0.0);
 
+        // Compressed spike segments are deltas of the sender's history
+        if (compress)
+            for (auto& tag : ltags)
+                spike_histories[tag] =
+                    Pointer<Output>(layer_tags[tag]->size, Output());
+
         // Sort layer tags (ensures consistency across ranks)
         std::sort(ltags.begin(), ltags.end());
     }
@@ -138,6 +262,14 @@ MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
     // This permits reuse of buffers
     this->buffer_indices = find_subsets(output_tags);
 
+    // Compressed messages are sent as a range of segments, so subsets
+    //   must be contiguous within their superset
+    if (compress)
+        for (auto& pair : buffer_indices)
+            if (not is_contiguous(output_tags[pair.first],
+                    output_tags[pair.second]))
+                pair.second = pair.first;
+
     // Create output buffers
     for (auto& pair : buffer_indices) {
         int sub_tag = pair.first;
@@ -147,16 +279,19 @@ MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
 
         // Compute buffer size
         int size = 0;
-        for (auto& layer : ltags)
-            size += layer_tags[layer]->size;
+        for (auto& tag : ltags)
+            size += (compress)
+                ? get_max_segment_size(layer_tags[tag])
+                : layer_tags[tag]->size;
         buffer_sizes[sub_tag] = size;
 
         // If superset, create buffer
         // Otherwise, determine offset
+        // Compressed offsets are determined when packing
         if (sub_tag == super_tag) {
             output_buffers[sub_tag] = Pointer<float>(size, 0.0);
             buffer_offsets[sub_tag] = 0;
-        } else {
+        } else if (not compress) {
             int stop = output_tags[super_tag][0];
             int index = 0;
             int offset = 0;
@@ -180,6 +315,8 @@ MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
     for (auto& pair : output_tags)
         send_requests[pair.first] = mpi_wrap_create_request();
 
+    // Post receives for the first iteration
+    if (overlap) post_receives();
 
     // Report total sizes
     int total_input = 0;
@@ -202,6 +339,9 @@ MPIModule::MPIModule(LayerList layers, ModuleConfig *config)
 
 MPILockstepModule::MPILockstepModule(LayerList layers, ModuleConfig *config)
         : MPIModule(layers, config) {
+    // Compressed messages must be well formed, so pack empty outputs
+    if (compress) pack_output(nullptr);
+
     // Perform initial sends
     for (auto& pair : output_tags) {
         int dest = pair.first;
@@ -215,11 +355,33 @@ MPILockstepModule::MPILockstepModule(LayerList layers, ModuleConfig *config)
     }
 }
 
-void MPIModule::feed_input_impl(Buffer *buffer) {
-    // Initiate message receive
+MPILockstepModule::~MPILockstepModule() {
+    // Lockstep modules send one more message than they receive
+    // The last messages are received here, so that they aren't mistaken for
+    //   the first messages of a later module (eg. in the next run)
+    if (not overlap) post_receives();
+    for (int i = 0 ; i < input_tags.size() ; ++i)
+        mpi_wrap_wait_any(input_tags.size(), recv_requests_array);
+
+    for (auto pair : send_requests)
+        mpi_wrap_wait(pair.second);
+}
+
+MPIModule::~MPIModule() {
+    // Overlapped receives are left pending after the last iteration
+    //   (lockstep modules complete them first)
+    // Output buffers are not freed, because sends may still be in flight
+    if (overlap)
+        for (auto& pair : recv_requests)
+            mpi_wrap_cancel(recv_requests_array, pair.second);
+
+    for (auto& pair : input_buffers) pair.second.free();
+    for (auto& pair : spike_histories) pair.second.free();
+}
+
+void MPIModule::post_receives() {
     for (auto& pair : input_tags) {
         int source = pair.first;
-        auto& ltags = pair.second;
         auto& buf = input_buffers[source];
 
         LOG_DEBUG("MPI receive in " + std::to_string(mpi_rank) +
@@ -227,6 +389,65 @@ void MPIModule::feed_input_impl(Buffer *buffer) {
         mpi_wrap_irecv(recv_requests_array, recv_requests[source],
             buf, buf.get_size(), source, 0);
     }
+}
+
+void MPIModule::pack_output(Buffer *buffer) {
+    int steps = (last_report_iteration < 0)
+        ? 0 : (curr_iteration - last_report_iteration);
+
+    for (auto& pair : output_buffers) {
+        unsigned int* buf = (unsigned int*)pair.second.get();
+        auto& offsets = segment_offsets[pair.first];
+        auto& ends = segment_ends[pair.first];
+
+        int index = 0;
+        for (auto& tag : output_tags[pair.first]) {
+            auto layer = layer_tags[tag];
+            const Output* src = (buffer == nullptr)
+                ? nullptr : buffer->get_output(layer).get();
+
+            offsets[tag] = index;
+            index += pack_segment(buf + index, tag, layer,
+                get_output_type(layer), src, steps);
+            ends[tag] = index;
+        }
+    }
+
+    // Destinations send the range of segments covering their layers
+    for (auto& pair : output_tags) {
+        int dest = pair.first;
+        auto& ltags = pair.second;
+        int index = buffer_indices[dest];
+        buffer_offsets[dest] = segment_offsets[index][ltags.front()];
+        buffer_sizes[dest] =
+            segment_ends[index][ltags.back()] - buffer_offsets[dest];
+    }
+}
+
+void MPIModule::unpack_input(int source, Buffer *buffer) {
+    const unsigned int* buf =
+        (const unsigned int*)input_buffers[source].get();
+
+    int index = 0;
+    for (auto& tag : input_tags[source]) {
+        if (buf[index] != tag)
+            LOG_ERROR("Unexpected MPI segment tag "
+                + std::to_string(buf[index]) + " (expected "
+                + std::to_string(tag) + ") in MPIModule!");
+
+        auto layer = layer_tags[tag];
+        auto& history = spike_histories[tag];
+        index += unpack_segment(buf + index, layer, history.get());
+
+        // Input buffers receive raw Output words (same as uncompressed)
+        history.cast<float>().copy_to(buffer->get_input(layer));
+    }
+}
+
+void MPIModule::feed_input_impl(Buffer *buffer) {
+    // Initiate message receive
+    // If overlapping, receives are already posted
+    if (not overlap) post_receives();
 
     // Wait for messages
     int req_size = input_tags.size();
@@ -236,13 +457,22 @@ void MPIModule::feed_input_impl(Buffer *buffer) {
         auto& buf = input_buffers[source];
 
         // Distribute message to layer buffers
-        int index = 0;
-        for (auto& tag : ltags) {
-            auto layer = layer_tags[tag];
-            buf.slice(index, layer->size).copy_to(buffer->get_input(layer));
-            index += layer->size;
+        if (compress) {
+            unpack_input(source, buffer);
+        } else {
+            int index = 0;
+            for (auto& tag : ltags) {
+                auto layer = layer_tags[tag];
+                buf.slice(index, layer->size).copy_to(buffer->get_input(layer));
+                index += layer->size;
+            }
         }
     }
+
+    // Post receives for the next iteration
+    // This is done after all messages are consumed so that
+    //   wait_any doesn't pick up a message from the next iteration
+    if (overlap) post_receives();
 }
 
 void MPIModule::report_output_impl(Buffer *buffer) {
@@ -254,16 +484,21 @@ void MPIModule::report_output_impl(Buffer *buffer) {
     }
 
     // Copy data from layer buffers
-    for (auto& pair : output_buffers) {
-        auto& buf = pair.second;
+    if (compress) {
+        pack_output(buffer);
+    } else {
+        for (auto& pair : output_buffers) {
+            auto& buf = pair.second;
 
-        int index = 0;
-        for (auto& layer_tag : output_tags[pair.first]) {
-            auto layer = layer_tags[layer_tag];
-            buffer->get_output(layer).cast<float>().copy_to(buf.slice(index, layer->size));
-            index += layer->size;
+            int index = 0;
+            for (auto& layer_tag : output_tags[pair.first]) {
+                auto layer = layer_tags[layer_tag];
+                buffer->get_output(layer).cast<float>().copy_to(buf.slice(index, layer->size));
+                index += layer->size;
+            }
         }
     }
+    last_report_iteration = curr_iteration;
 
     // Send messages
     for (auto& pair : output_tags) {
@@ -274,9 +509,25 @@ void MPIModule::report_output_impl(Buffer *buffer) {
         LOG_DEBUG("MPI send from " + std::to_string(mpi_rank) +
             " to " + std::to_string(dest));
         mpi_wrap_isend(req, buf + buffer_offsets[dest], buffer_sizes[dest], dest, 0);
+
+        words_sent += buffer_sizes[dest];
+        ++messages_sent;
     }
 }
 
-void MPIModule::report(Report* report) { }
+void MPIModule::report(Report* report) {
+    for (auto layer : layers) {
+        if (get_io_type(layer) & OUTPUT) {
+            report->add_report(this, layer,
+                PropertyConfig({
+                    { "Overlap", (overlap) ? "true" : "false" },
+                    { "Compress", (compress) ? "true" : "false" },
+                    { "Messages sent", std::to_string(messages_sent) },
+                    { "Words sent", std::to_string(words_sent) }
+                }));
+            break;
+        }
+    }
+}
 
 #endif
@@ -10,6 +10,7 @@
 class MPIModule : public Module {
     public:
         MPIModule(LayerList layers, ModuleConfig *config);
+        virtual ~MPIModule();
 
         void feed_input_impl(Buffer *buffer);
         void report_output_impl(Buffer *buffer);
@@ -19,6 +20,23 @@ class MPIModule : public Module {
     protected:
         int mpi_rank;
 
+        // Receives for the next iteration are posted as soon as the
+        //   current ones are consumed, overlapping with network computation
+        bool overlap;
+
+        // Messages are packed into tagged segments
+        // BIT layers are sent as lists of neurons with new spikes
+        bool compress;
+
+        // Posts receives for all sources
+        void post_receives();
+
+        // Packs output layers into compressed segments
+        void pack_output(Buffer *buffer);
+
+        // Unpacks a compressed message into input layers
+        void unpack_input(int source, Buffer *buffer);
+
         // Unique tags for each layer
         std::map<int, Layer*> layer_tags;
 
@@ -42,12 +60,27 @@ class MPIModule : public Module {
         std::map<int, int> recv_requests;
         std::map<int, int> recv_requests_inv;
 
+        // Compressed segment offsets/ends by layer tag within output buffers
+        std::map<int, std::map<int, int>> segment_offsets;
+        std::map<int, std::map<int, int>> segment_ends;
+
+        // Reconstructed spike histories for compressed BIT segments
+        std::map<int, Pointer<Output>> spike_histories;
+
+        // Iteration of last report, used to compute spike history deltas
+        int last_report_iteration;
+
+        // Message statistics
+        size_t words_sent;
+        size_t messages_sent;
+
     MODULE_MEMBERS
 };
 
 class MPILockstepModule : public MPIModule {
     public:
         MPILockstepModule(LayerList layers, ModuleConfig *config);
+        virtual ~MPILockstepModule();
 
     MODULE_MEMBERS
 };
@@ -0,0 +1,161 @@
+#include <cstring>
+#include <algorithm>
+
+#include "io/impl/record_output_module.h"
+#include "network/structure.h"
+
+REGISTER_MODULE(RecordOutputModule, "record_output");
+
+/* Trace format (native byte order)
+ *
+ * Header:
+ *   char[8]          "SYNREC1\0"
+ *   uint32           number of layers
+ *   for each layer:
+ *     uint32, chars  structure name
+ *     uint32, chars  layer name
+ *     uint32         rows
+ *     uint32         columns
+ *     uint32         output type (FLOAT, BIT, INT)
+ *     uint32         encoding (0: Output words, 1: spike indices)
+ *
+ * Frame:
+ *   uint32           layer index
+ *   uint32           iteration
+ *   uint32           count
+ *   uint32[count]    Output words or spike indices
+ *
+ * Index (written when the module is destroyed):
+ *   uint64[frames]   frame offsets
+ *   uint64           index offset
+ *   uint64           number of frames
+ *   char[8]          "SYNIDX1\0"
+ */
+static const char REC_MAGIC[8] = "SYNREC1";
+static const char IDX_MAGIC[8] = "SYNIDX1";
+#define FRAME_HEADER_WORDS 3
+
+static void append(std::string& s, uint32_t val) {
+    s.append((const char*)&val, sizeof(val));
+}
+
+static void append(std::string& s, std::string val) {
+    append(s, (uint32_t)val.size());
+    s.append(val);
+}
+
+RecordOutputModule::RecordOutputModule(LayerList layers, ModuleConfig *config)
+        : Module(layers, config),
+          writer(nullptr),
+          num_reports(0) {
+    set_io_type(OUTPUT);
+
+    std::string filename = config->get("filename", "");
+    this->spikes = config->get_bool("spikes", false);
+    this->decimation = config->get_int("decimation", 1);
+    int buffer_frames = config->get_int("buffer frames", 64);
+    bool drop = config->get_bool("drop frames", false);
+
+    if (filename == "")
+        LOG_ERROR(
+            "Unspecified filename for RecordOutputModule!");
+    if (decimation < 1)
+        LOG_ERROR(
+            "Bad decimation for RecordOutputModule!");
+    if (buffer_frames < 1)
+        LOG_ERROR(
+            "Bad buffer frames for RecordOutputModule!");
+
+    // Build header
+    std::string header(REC_MAGIC, sizeof(REC_MAGIC));
+    append(header, (uint32_t)layers.size());
+
+    int max_size = 0;
+    int header_index = 0;
+    for (auto layer : layers) {
+        if (spikes and output_types[layer] != BIT)
+            LOG_ERROR(
+                "RecordOutputModule can only record spikes from "
+                + layer->str() + " with BIT output type!");
+
+        layer_indices[layer] = header_index++;
+        frames[layer] = 0;
+        max_size = std::max(max_size, layer->size);
+
+        append(header, layer->structure->name);
+        append(header, layer->name);
+        append(header, (uint32_t)layer->rows);
+        append(header, (uint32_t)layer->columns);
+        append(header, (uint32_t)output_types[layer]);
+        append(header, (uint32_t)spikes);
+    }
+
+    this->writer = new AsyncWriter(filename, header, buffer_frames,
+        sizeof(uint32_t) * (FRAME_HEADER_WORDS + max_size), drop);
+}
+
+RecordOutputModule::~RecordOutputModule() {
+    writer->finish();
+
+    // Write index
+    // Traces without an index can still be read sequentially
+    try {
+        auto offsets = writer->get_frame_offsets();
+        uint64_t index_offset = writer->get_bytes();
+        uint64_t num_frames = offsets.size();
+        writer->write(offsets.data(), num_frames * sizeof(uint64_t));
+        writer->write(&index_offset, sizeof(index_offset));
+        writer->write(&num_frames, sizeof(num_frames));
+        writer->write(IDX_MAGIC, sizeof(IDX_MAGIC));
+    } catch (std::runtime_error& e) {
+        LOG_WARNING("Failed to write output recording index!");
+    }
+
+    delete writer;
+}
+
+void RecordOutputModule::report_output_impl(Buffer *buffer) {
+    if (num_reports++ % decimation != 0) return;
+
+    for (auto layer : layers) {
+        char *frame = writer->reserve();
+        if (frame == nullptr) continue;
+
+        uint32_t *words = (uint32_t*)frame;
+        uint32_t *data = words + FRAME_HEADER_WORDS;
+        Output *output = buffer->get_output(layer);
+        int size = layer->size;
+
+        // Fill data words
+        uint32_t count = 0;
+        if (spikes) {
+            // Newest spikes are in the most significant bit
+            for (int i = 0 ; i < size ; ++i)
+                if (output[i].i >> 31) data[count++] = i;
+        } else {
+            memcpy(data, output, size * sizeof(Output));
+            count = size;
+        }
+
+        words[0] = layer_indices[layer];
+        words[1] = curr_iteration;
+        words[2] = count;
+        writer->commit(sizeof(uint32_t) * (FRAME_HEADER_WORDS + count));
+        ++frames[layer];
+    }
+}
+
+void RecordOutputModule::report(Report *report) {
+    for (auto layer : layers) {
+        PropertyConfig props;
+        props.set("frames", std::to_string(frames[layer]));
+        report->add_report(this, layer, props);
+    }
+
+    // The writer is shared by every layer
+    PropertyConfig props;
+    props.set("dropped frames", std::to_string(writer->get_dropped()));
+    props.set("stalls", std::to_string(writer->get_stalls()));
+    props.set("failed", writer->has_failed());
+    report->add_report(this, props);
+}
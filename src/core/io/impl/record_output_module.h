@@ -0,0 +1,38 @@
+#ifndef record_output_module_h
+#define record_output_module_h
+
+#include "io/module.h"
+#include "util/async_writer.h"
+
+/* Records layer outputs to an indexed binary trace
+ *   (see read_recording() in syngen.py)
+ *
+ * Outputs are copied into the ring of an AsyncWriter, so the environment
+ *   thread never waits on the file system unless the ring is full.
+ * Frames hold either raw Output words, or the indices of neurons that
+ *   spiked in the latest timestep ("spikes", BIT layers only).
+ * "decimation" records every Nth output report.
+ */
+class RecordOutputModule : public Module {
+    public:
+        RecordOutputModule(LayerList layers, ModuleConfig *config);
+        virtual ~RecordOutputModule();
+
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
+        void report_output_impl(Buffer *buffer);
+        void report(Report *report);
+
+    protected:
+        AsyncWriter *writer;
+        bool spikes;
+        int decimation;
+        int num_reports;
+        std::map<Layer*, int> layer_indices;
+        std::map<Layer*, size_t> frames;
+
+    MODULE_MEMBERS
+};
+
+#endif
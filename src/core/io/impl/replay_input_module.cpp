@@ -0,0 +1,154 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "io/impl/replay_input_module.h"
+#include "io/input_recorder.h"
+#include "network/structure.h"
+
+REGISTER_MODULE(ReplayInputModule, "replay_input");
+
+/* Reads words and strings from the log, checking bounds */
+static uint32_t read_word(const std::vector<char>& data, size_t& offset) {
+    if (offset + sizeof(uint32_t) > data.size())
+        LOG_ERROR("Unexpected end of input log!");
+    uint32_t val;
+    memcpy(&val, data.data() + offset, sizeof(val));
+    offset += sizeof(val);
+    return val;
+}
+
+static std::string read_string(const std::vector<char>& data, size_t& offset) {
+    uint32_t length = read_word(data, offset);
+    if (offset + length > data.size())
+        LOG_ERROR("Unexpected end of input log!");
+    std::string val(data.data() + offset, length);
+    offset += length;
+    return val;
+}
+
+ReplayInputModule::ReplayInputModule(LayerList layers, ModuleConfig *config)
+        : Module(layers, config),
+          position(0),
+          num_iterations(0),
+          iteration(0) {
+    set_io_type(INPUT);
+
+    std::string filename = config->get("filename", "");
+    this->loop = config->get_bool("loop", false);
+
+    if (filename == "")
+        LOG_ERROR(
+            "Unspecified filename for replay input module!");
+
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    if (not file.good())
+        LOG_ERROR(
+            "Could not open input log: " + filename);
+    std::vector<char> data{std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>()};
+
+    if (data.size() < 8 or memcmp(data.data(), INPUT_LOG_MAGIC, 8) != 0)
+        LOG_ERROR(
+            "Not an input log: " + filename);
+
+    // Match streams to layers
+    size_t offset = 8;
+    int num_streams = read_word(data, offset);
+    std::set<Layer*> found;
+    for (int i = 0 ; i < num_streams ; ++i) {
+        std::string structure = read_string(data, offset);
+        std::string layer_name = read_string(data, offset);
+        std::string key = read_string(data, offset);
+        int size = read_word(data, offset);
+
+        Stream *stream = nullptr;
+        for (auto layer : layers) {
+            if (layer->structure->name == structure
+                    and layer->name == layer_name) {
+                if (layer->size != size)
+                    LOG_ERROR(
+                        "Input log size does not match " + layer->str());
+
+                stream = new Stream();
+                stream->layer = layer;
+                stream->key = key;
+                stream->state = Pointer<float>(size, 0.0);
+                if (key != "input") add_input_auxiliary_key(layer, key);
+                found.insert(layer);
+            }
+        }
+        streams.push_back(stream);
+    }
+
+    for (auto layer : layers)
+        if (found.count(layer) == 0)
+            LOG_ERROR(
+                "Input log has no inputs for " + layer->str());
+
+    // Copy frames into aligned words, and count complete frames
+    words.resize((data.size() - offset) / sizeof(uint32_t));
+    memcpy(words.data(), data.data() + offset,
+        words.size() * sizeof(uint32_t));
+
+    // Truncated logs are replayed up to the last complete frame
+    size_t pos = 0;
+    while (pos + 2 <= words.size()) {
+        size_t num_dirty = words[pos + 1];
+        bool complete = true;
+        pos += 2;
+        for (size_t i = 0 ; i < num_dirty and complete ; ++i) {
+            complete = pos + 2 <= words.size();
+            if (complete and words[pos] >= streams.size())
+                LOG_ERROR("Corrupt input log!");
+            if (complete) pos += 2 + words[pos + 1];
+        }
+        if (not complete or pos > words.size()) break;
+        ++num_iterations;
+    }
+
+    if (num_iterations == 0)
+        LOG_ERROR(
+            "Input log " + filename + " has no iterations!");
+}
+
+ReplayInputModule::~ReplayInputModule() {
+    for (auto stream : streams) {
+        if (stream != nullptr) {
+            stream->state.free();
+            delete stream;
+        }
+    }
+}
+
+void ReplayInputModule::feed_input_impl(Buffer *buffer) {
+    if (iteration == num_iterations) {
+        if (not loop) return;
+
+        // Restart from the initial (zero) inputs
+        iteration = 0;
+        position = 0;
+        for (auto stream : streams)
+            if (stream != nullptr)
+                memset(stream->state.get(), 0,
+                    stream->state.get_size() * sizeof(float));
+    }
+
+    // Skip the iteration, which is implied by the order of frames
+    size_t num_dirty = words[position + 1];
+    position += 2;
+    for (size_t i = 0 ; i < num_dirty ; ++i) {
+        Stream *stream = streams[words[position]];
+        size_t count = words[position + 1];
+        const uint32_t *runs = words.data() + position + 2;
+        position += 2 + count;
+        if (stream == nullptr) continue;
+
+        // Retrieving the buffer pointer sets the dirty flag
+        decode_runs(runs, count,
+            (uint32_t*)stream->state.get(), stream->layer->size);
+        stream->state.copy_to(Pointer<float>(
+            buffer->get_input_auxiliary(stream->layer, stream->key)));
+    }
+    ++iteration;
+}
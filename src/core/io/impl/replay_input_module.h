@@ -0,0 +1,48 @@
+#ifndef replay_input_module_h
+#define replay_input_module_h
+
+#include "io/module.h"
+#include "util/resources/pointer.h"
+
+/* Replays an input log recorded with the "record input" engine arg
+ *   (see InputRecorder)
+ * Each listed layer replays every stream recorded for it (its input and any
+ *   auxiliary inputs), with the recorded dirty flags.  The log is loaded up
+ *   front, and each iteration only applies the changed words.
+ * With "loop", the log restarts after its last iteration.
+ */
+class ReplayInputModule : public Module {
+    public:
+        ReplayInputModule(LayerList layers, ModuleConfig *config);
+        virtual ~ReplayInputModule();
+
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
+        virtual size_t get_expected_iterations() const
+            { return loop ? 0 : num_iterations; }
+
+        void feed_input_impl(Buffer *buffer);
+
+    protected:
+        class Stream {
+            public:
+                Layer *layer;
+                std::string key;
+                Pointer<float> state;
+        };
+
+        // Frames, as words following the header
+        std::vector<uint32_t> words;
+        size_t position;
+        size_t num_iterations;
+        uint32_t iteration;
+        bool loop;
+
+        // Streams by index in the log, null if not replayed
+        std::vector<Stream*> streams;
+
+    MODULE_MEMBERS
+};
+
+#endif
@@ -12,6 +12,9 @@ class SocketModule : public Module {
     public:
         SocketModule(LayerList layers, ModuleConfig *config);
 
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", true); }
+
         void feed_input_impl(Buffer *buffer);
         void report_output_impl(Buffer *buffer);
 
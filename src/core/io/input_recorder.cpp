@@ -0,0 +1,126 @@
+#include "io/input_recorder.h"
+#include "network/structure.h"
+#include "report.h"
+
+size_t encode_runs(const uint32_t *curr, uint32_t *prev, int size,
+        uint32_t *out) {
+    size_t count = 0;
+    int i = 0;
+
+    while (i < size) {
+        int start = i;
+        while (i < size and curr[i] == prev[i]) ++i;
+        out[count++] = i - start;
+
+        start = i;
+        uint32_t *changed = out + count + 1;
+        while (i < size and curr[i] != prev[i]) {
+            prev[i] = curr[i];
+            *changed++ = curr[i++];
+        }
+        out[count++] = i - start;
+        count += i - start;
+    }
+    return count;
+}
+
+void decode_runs(const uint32_t *in, size_t count, uint32_t *state, int size) {
+    size_t pos = 0;
+    int i = 0;
+
+    while (pos + 1 < count) {
+        i += in[pos++];
+        uint32_t changed = in[pos++];
+        if (i + changed > size or pos + changed > count)
+            LOG_ERROR("Corrupt input log!");
+        for (uint32_t j = 0 ; j < changed ; ++j)
+            state[i++] = in[pos++];
+    }
+}
+
+static void append(std::string& s, uint32_t val) {
+    s.append((const char*)&val, sizeof(val));
+}
+
+static void append(std::string& s, std::string val) {
+    append(s, (uint32_t)val.size());
+    s.append(val);
+}
+
+InputRecorder::InputRecorder(std::string filename, Buffer *buffer,
+        LayerKeyMap input_keys)
+        : buffer(buffer),
+          writer(nullptr),
+          iteration(0),
+          raw_bytes(0) {
+    // Build header and streams
+    std::string header(INPUT_LOG_MAGIC, 8);
+    size_t max_frame_words = 2;
+    for (auto pair : input_keys) {
+        // The buffer assumes the default key if none are specified
+        KeySet keys = pair.second;
+        if (keys.size() == 0) keys.insert("input");
+
+        for (auto key : keys) {
+            Layer *layer = pair.first;
+            streams.push_back(Stream());
+            streams.back().layer = layer;
+            streams.back().key = key;
+            streams.back().prev = std::vector<uint32_t>(layer->size, 0);
+            max_frame_words += 4 + 2 * layer->size;
+        }
+    }
+
+    append(header, (uint32_t)streams.size());
+    for (auto& stream : streams) {
+        append(header, stream.layer->structure->name);
+        append(header, stream.layer->name);
+        append(header, stream.key);
+        append(header, (uint32_t)stream.layer->size);
+    }
+
+    // Inputs can't be dropped, so the environment waits if the ring fills
+    writer = new AsyncWriter(filename, header,
+        16, max_frame_words * sizeof(uint32_t), false);
+}
+
+InputRecorder::~InputRecorder() {
+    delete writer;
+}
+
+void InputRecorder::record() {
+    uint32_t *frame = (uint32_t*)writer->reserve();
+    uint32_t *out = frame + 2;
+    uint32_t num_dirty = 0;
+
+    for (int index = 0 ; index < streams.size() ; ++index) {
+        auto& stream = streams[index];
+        bool dirty = (stream.key == "input")
+            ? buffer->get_input_dirty(stream.layer)
+            : buffer->get_auxiliary_dirty(stream.layer, stream.key);
+        if (not dirty) continue;
+
+        // Retrieving the pointer marks it dirty, which it already is
+        Pointer<float> data = Pointer<float>(
+            buffer->get_input_auxiliary(stream.layer, stream.key));
+
+        out[0] = index;
+        out[1] = encode_runs((uint32_t*)data.get(), stream.prev.data(),
+            stream.layer->size, out + 2);
+        out += 2 + out[1];
+        ++num_dirty;
+        raw_bytes += stream.layer->size * sizeof(float);
+    }
+
+    frame[0] = iteration++;
+    frame[1] = num_dirty;
+    writer->commit((char*)out - (char*)frame);
+}
+
+void InputRecorder::report(Report *report) const {
+    PropertyConfig props;
+    props.set("iterations", std::to_string(iteration));
+    props.set("input bytes", std::to_string(raw_bytes));
+    props.set("stalls", std::to_string(writer->get_stalls()));
+    report->set_child("input recording", &props);
+}
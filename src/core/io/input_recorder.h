@@ -0,0 +1,73 @@
+#ifndef input_recorder_h
+#define input_recorder_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "io/buffer.h"
+#include "util/async_writer.h"
+
+class Report;
+
+/* Input log format (native byte order)
+ *
+ * Header:
+ *   char[8]          "SYNINP1\0"
+ *   uint32           number of streams
+ *   for each stream (layer input or auxiliary input):
+ *     uint32, chars  structure name
+ *     uint32, chars  layer name
+ *     uint32, chars  key ("input" or auxiliary key)
+ *     uint32         size
+ *
+ * Frame (one per iteration):
+ *   uint32           iteration
+ *   uint32           number of dirty streams
+ *   for each dirty stream:
+ *     uint32         stream index
+ *     uint32         count
+ *     uint32[count]  encoded data (see encode_runs())
+ */
+#define INPUT_LOG_MAGIC "SYNINP1"
+
+/* Encodes the words of |curr| that differ from |prev| as runs of
+ *   { unchanged count, changed count, changed words... }, and updates |prev|.
+ * Stimuli are typically held for several iterations or sparse, so this
+ *   compresses well without any dependencies.
+ * Returns the number of encoded words (at most 2 + 2 * size). */
+size_t encode_runs(const uint32_t *curr, uint32_t *prev, int size,
+    uint32_t *out);
+
+/* Applies encoded runs to |state| */
+void decode_runs(const uint32_t *in, size_t count, uint32_t *state, int size);
+
+/* Records the inputs written to a Buffer by environment modules
+ * After modules feed input each iteration, every dirty input and auxiliary
+ *   input is encoded and handed to an AsyncWriter.  Logs are replayed by the
+ *   replay_input module. */
+class InputRecorder {
+    public:
+        InputRecorder(std::string filename, Buffer *buffer,
+            LayerKeyMap input_keys);
+        virtual ~InputRecorder();
+
+        void record();
+        void report(Report *report) const;
+
+    protected:
+        class Stream {
+            public:
+                Layer *layer;
+                std::string key;
+                std::vector<uint32_t> prev;
+        };
+
+        Buffer *buffer;
+        AsyncWriter *writer;
+        std::vector<Stream> streams;
+        uint32_t iteration;
+        size_t raw_bytes;
+};
+
+#endif
@@ -46,8 +46,13 @@ const PropertyConfig* ModuleConfig::get_layer(Layer *layer) const {
 
 Module::Module(LayerList layers, ModuleConfig *config)
         : layers(layers), config(config), curr_iteration(0) {
+    // The engine sets the output accumulation (see OutputAccumulation)
+    auto accumulation = get_output_accumulation(
+        config->get("output accumulation", "none"));
+
     for (auto layer : layers) {
-        output_types[layer] = Attributes::get_output_type(layer);
+        output_types[layer] = get_accumulated_output_type(
+            Attributes::get_output_type(layer), accumulation);
         auto layer_config = config->get_layer(layer);
 
         if (layer_config->get_bool("input", false))
@@ -65,6 +65,13 @@ class Module {
         /* Checks if two modules are active simultaneously */
         bool is_coactive(Module* other) const;
 
+        /* Checks if the module's hooks can run concurrently with those of
+         *   other modules (see ModulePool).  Modules that use shared state,
+         *   such as stdout or GUI windows, must run one at a time.
+         * The "thread safe" property overrides the module's default */
+        virtual bool is_thread_safe() const
+            { return config->get_bool("thread safe", false); }
+
         const LayerList layers;
         ModuleConfig* const config;
 
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <map>
+
+#include "io/module_pool.h"
+
+/* Union-find over module indices */
+static int find(std::vector<int>& parents, int i) {
+    while (parents[i] != i) i = parents[i] = parents[parents[i]];
+    return i;
+}
+
+static void join(std::vector<int>& parents, int i, int j) {
+    i = find(parents, i);
+    j = find(parents, j);
+    if (i != j) parents[std::max(i, j)] = std::min(i, j);
+}
+
+ModulePool::ModulePool(ModuleList modules, int num_threads)
+        : modules(modules),
+          first_input(true),
+          first_output(true),
+          first_cycle(true),
+          generation(0),
+          next_group(0),
+          remaining(0),
+          running(true) {
+    int size = modules.size();
+    std::vector<int> parents(size);
+    for (int i = 0 ; i < size ; ++i) parents[i] = i;
+
+    // Join modules that share a layer, and modules that are not thread safe
+    std::map<Layer*, int> layer_owners;
+    int unsafe = -1;
+    for (int i = 0 ; i < size ; ++i) {
+        for (auto layer : modules[i]->layers) {
+            auto it = layer_owners.find(layer);
+            if (it == layer_owners.end()) layer_owners[layer] = i;
+            else join(parents, i, it->second);
+        }
+
+        if (not modules[i]->is_thread_safe()) {
+            if (unsafe == -1) unsafe = i;
+            else join(parents, i, unsafe);
+        }
+    }
+
+    // Roots are the first members of their groups, so groups are created
+    //   in order, and members are added in their original order
+    std::map<int, int> group_indices;
+    for (int i = 0 ; i < size ; ++i) {
+        int root = find(parents, i);
+        if (group_indices.count(root) == 0) {
+            group_indices[root] = groups.size();
+            groups.push_back(ModuleList());
+        }
+        groups[group_indices[root]].push_back(modules[i]);
+    }
+
+    // Modules that are not thread safe stay on the calling thread, which
+    //   is where all modules used to run (eg. GUI modules expect this)
+    // Their group is moved to the back, where workers cannot claim it
+    this->num_claimable = groups.size();
+    if (unsafe != -1) {
+        int index = group_indices[find(parents, unsafe)];
+        std::rotate(groups.begin() + index, groups.begin() + index + 1,
+            groups.end());
+        --num_claimable;
+    }
+
+    // The caller runs groups too, so one fewer thread is needed
+    int workers = std::min(num_threads, (int)groups.size() - 1);
+    for (int i = 0 ; i < workers ; ++i)
+        threads.push_back(std::thread(&ModulePool::worker_loop, this));
+}
+
+ModulePool::~ModulePool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        running = false;
+    }
+    work_cv.notify_all();
+
+    for (auto& thread : threads)
+        if (thread.joinable()) thread.join();
+}
+
+void ModulePool::feed_input(Buffer *buffer) {
+    run([buffer](Module *m) { m->feed_input(buffer); }, first_input);
+}
+
+void ModulePool::report_output(Buffer *buffer) {
+    run([buffer](Module *m) { m->report_output(buffer); }, first_output);
+}
+
+void ModulePool::cycle() {
+    run([](Module *m) { m->cycle(); }, first_cycle);
+}
+
+void ModulePool::run(std::function<void(Module*)> f, bool& first) {
+    // Run sequentially on the first call, or if there is nothing to overlap
+    if (first or threads.size() == 0) {
+        for (auto& m : modules) f(m);
+        first = false;
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task = f;
+    next_group = 0;
+    remaining = num_claimable;
+    ++generation;
+    work_cv.notify_all();
+    lock.unlock();
+
+    // Run the unclaimable group, then help out until all groups are claimed
+    if (num_claimable < groups.size())
+        run_group(groups.size() - 1);
+
+    lock.lock();
+    while (next_group < num_claimable) {
+        int index = next_group++;
+        lock.unlock();
+        run_group(index);
+        lock.lock();
+        --remaining;
+    }
+
+    // Wait for workers to finish their groups
+    while (remaining > 0) done_cv.wait(lock);
+}
+
+void ModulePool::run_group(int index) {
+    for (auto& m : groups[index]) task(m);
+}
+
+void ModulePool::worker_loop() {
+    int seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        while (running and generation == seen) work_cv.wait(lock);
+        if (not running) return;
+        seen = generation;
+
+        while (next_group < num_claimable) {
+            int index = next_group++;
+            lock.unlock();
+            run_group(index);
+            lock.lock();
+            if (--remaining == 0) done_cv.notify_one();
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef module_pool_h
+#define module_pool_h
+
+#include <functional>
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+#include "io/module.h"
+
+/* Runs environment module hooks concurrently on a small pool of IO threads
+ *
+ * Modules are partitioned into groups whose members run sequentially,
+ *   in their original order:
+ *   - Modules that share a layer, since their accesses to the buffer
+ *     may depend on each other (eg. a cutoff clearing an input that a
+ *     delayed module starts writing in the same iteration)
+ *   - Modules that are not thread safe, which all share one group that
+ *     always runs on the calling thread
+ * Independent groups are distributed over the pool, and the calling thread
+ *   takes part in the work.  Each hook returns once every module is done.
+ *
+ * The first call of each hook runs sequentially, so that modules may
+ *   lazily set up shared resources (eg. callback views) without locking.
+ */
+class ModulePool {
+    public:
+        ModulePool(ModuleList modules, int num_threads);
+        virtual ~ModulePool();
+
+        void feed_input(Buffer *buffer);
+        void report_output(Buffer *buffer);
+        void cycle();
+
+        int get_num_groups() const { return groups.size(); }
+        int get_num_threads() const { return threads.size(); }
+
+    protected:
+        void run(std::function<void(Module*)> f, bool& first);
+        void run_group(int index);
+        void worker_loop();
+
+        ModuleList modules;
+        std::vector<ModuleList> groups;
+        int num_claimable;
+        bool first_input, first_output, first_cycle;
+
+        /* Pool state
+         * Workers wait for the generation to change, then claim groups
+         *   until none are left.  The caller waits for all groups to be
+         *   completed, including those claimed by workers. */
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable work_cv;
+        std::condition_variable done_cv;
+        std::function<void(Module*)> task;
+        int generation;
+        int next_group;
+        int remaining;
+        bool running;
+};
+
+#endif
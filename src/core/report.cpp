@@ -13,6 +13,8 @@ Report::Report(Engine* engine, State* state, size_t iterations, float total_time
     this->set("network bytes", std::to_string(state->get_network_bytes()));
     this->set("state buffer bytes", std::to_string(state->get_buffer_bytes()));
     this->set("engine buffer bytes", std::to_string(engine->get_buffer_bytes()));
+    this->set("inter-device transfers",
+        std::to_string(engine->get_num_inter_device_transfers()));
 }
 
 void Report::print() {
@@ -35,6 +37,46 @@ void Report::print() {
     printf("Engine buffer size: %12zu bytes    (%12f MB)\n",
         engine_buffer_bytes, (float)engine_buffer_bytes / (1024 * 1024));
 
+    if (has_child("pacing")) {
+        auto pacing = get_child("pacing");
+        printf("Pacing at %fs: %s overruns (max %fs, average %fs), "
+               "lateness max %fs, average %fs\n",
+            pacing->get_float("period", 0.0),
+            pacing->get("overruns").c_str(),
+            pacing->get_float("max overrun", 0.0),
+            pacing->get_float("average overrun", 0.0),
+            pacing->get_float("max lateness", 0.0),
+            pacing->get_float("average lateness", 0.0));
+    }
+
+    auto perf = get_child_array("perf counters");
+    if (perf.size() > 0) printf("\nPerformance counters:\n");
+    for (auto region : perf) {
+        printf("  %-40s %8s samples  %10fs",
+            region->get("region").c_str(),
+            region->get("samples").c_str(),
+            region->get_float("task clock", 0.0));
+        if (region->has("cycles"))
+            printf("  %s cycles  %s instructions  (%.2f ipc)  "
+                   "%s llc misses  %s branch misses",
+                region->get("cycles").c_str(),
+                region->get("instructions").c_str(),
+                region->get_float("ipc", 0.0),
+                region->get("llc misses").c_str(),
+                region->get("branch misses").c_str());
+        printf("\n");
+    }
+
+    for (auto module_report : get_child_array("module reports")) {
+        printf("\nReport for module %s\n",
+            module_report->get("Module").c_str());
+        for (auto pair : module_report->get())
+            if (pair.first != "Module")
+                printf("  %15s -> %s\n",
+                    pair.first.c_str(),
+                    pair.second.c_str());
+    }
+
     auto arr = get_child_array("layer reports");
     for (auto indices : layer_indices) {
         printf("\nReport for %s\n", indices.first->str().c_str());
@@ -63,3 +105,11 @@ void Report::add_report(Module *module, Layer *layer, PropertyConfig props) {
     // Add the report
     this->add_to_child_array("layer reports", &layer_report);
 }
+
+void Report::add_report(Module *module, PropertyConfig props) {
+    PropertyConfig module_report;
+    module_report.set("Module", module->get_name());
+    for (auto pair : props.get())
+        module_report.set(pair.first, pair.second);
+    this->add_to_child_array("module reports", &module_report);
+}
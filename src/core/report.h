@@ -20,6 +20,9 @@ class Report : public PropertyConfig {
         void print();
         void add_report(Module *module, Layer *layer, PropertyConfig props);
 
+        /* Adds a report for the module as a whole */
+        void add_report(Module *module, PropertyConfig props);
+
     protected:
         std::map<Layer*, std::vector<int>> layer_indices;
 };
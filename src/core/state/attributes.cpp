@@ -13,6 +13,8 @@ OutputType Attributes::get_output_type(Layer *layer) {
     return NeuralModelBank::get_output_type(layer->neural_model);
 }
 
+thread_local bool Attributes::probing = false;
+
 Attributes::Attributes(Layer *layer, OutputType output_type)
         : layer(layer),
           output_type(output_type),
@@ -29,7 +31,8 @@ Attributes::Attributes(Layer *layer, OutputType output_type)
     this->output = Pointer<Output>(output_register_count * layer->size);
 
     // Set up weight matrices
-    for (auto& conn : layer->get_input_connections()) {
+    // Memory estimates measure these separately (see estimate_memory())
+    if (not probing) for (auto& conn : layer->get_input_connections()) {
         WeightMatrix* matrix =
             NeuralModelBank::build_weight_matrix(conn);
         this->weight_matrices[conn] = matrix;
@@ -110,6 +113,45 @@ std::map<PointerKey, BasePointer*> Attributes::get_pointer_map() {
     return pointers;
 }
 
+PropertyConfig Attributes::get_memory_report() {
+    std::map<std::string, BasePointer*> pointers = neuron_variables;
+    pointers["input"] = &input;
+    pointers["output"] = &output;
+
+    PropertyConfig report;
+    size_t total = 0;
+    for (auto pair : pointers) {
+        size_t bytes = pair.second->get_bytes();
+        if (bytes > 0) {
+            report.set(pair.first, std::to_string(bytes));
+            total += bytes;
+        }
+    }
+    report.set("total bytes", std::to_string(total));
+    return report;
+}
+
+PropertyConfig Attributes::estimate_memory(Layer *layer) {
+    // Constructors may draw random numbers, so restore the generator
+    //   to keep the estimate from changing the state built afterwards
+    std::mt19937 saved_generator = generator;
+    Attributes::probing = true;
+    Attributes *probe;
+    try {
+        probe = NeuralModelBank::build_attributes(layer);
+    } catch (...) {
+        Attributes::probing = false;
+        generator = saved_generator;
+        throw;
+    }
+    Attributes::probing = false;
+    generator = saved_generator;
+
+    PropertyConfig report = probe->get_memory_report();
+    delete probe;
+    return report;
+}
+
 void Attributes::process_weight_matrices() {
     for (auto pair : weight_matrices)
         process_weight_matrix(pair.second);
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <vector>
+#include <cstring>
 
 #include "network/layer.h"
 #include "state/weight_matrix.h"
@@ -36,6 +37,13 @@ class Attributes {
         std::map<PointerKey, BasePointer*> get_pointer_map();
         void transfer(DeviceID new_device);
 
+        /* Memory accounting for neuron data (see WeightMatrix)
+         * Neuron variables are created by subclass constructors, so
+         *   estimates build the attributes without weight matrices and
+         *   measure them.  Only one layer is allocated at a time. */
+        PropertyConfig get_memory_report();
+        static PropertyConfig estimate_memory(Layer *layer);
+
         // Activation Function
         virtual KernelList<SYNAPSE_ARGS> get_activators(Connection *conn)
             { return { get_base_activator_kernel(conn) }; }
@@ -47,6 +55,11 @@ class Attributes {
         // Pointer keys to initialize with input
         virtual KeySet get_init_keys() { return { }; }
 
+        /* Rebuilds data derived from neuron variables, which may have been
+         *   edited or loaded on the host.  Called before transfer to
+         *   devices, and by subclass constructors that need it. */
+        virtual void process_neuron_variables() { }
+
         // Weight matrix functions
         void process_weight_matrices();
         virtual void process_weight_matrix(WeightMatrix* matrix) { }
@@ -108,6 +121,9 @@ class Attributes {
 
         DeviceID device_id;
 
+        // Set while estimating memory, which skips weight matrices
+        static thread_local bool probing;
+
         // Managed pointers
         std::map<std::string, BasePointer*> neuron_variables;
 
@@ -208,6 +224,35 @@ GLOBAL void FUNC_NAME##_PARALLEL(AttributeData attribute_data) { \
         BODY; \
     } \
 }
+
+// Vectorizable attribute kernel
+// The output history is shifted before the main loop, leaving BODY free of
+//   inner loops so that it can be vectorized on the host
+// BODY should write its new output with SET_FLOAT_OUTPUT or SET_BIT_OUTPUT
+#define DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+HOST void FUNC_NAME##_SERIAL(AttributeData attribute_data) { \
+    PREAMBLE_ATTRIBUTES(CLASS_NAME) \
+    PREAMBLE \
+    SHIFT_ALL_OUTPUTS \
+    _Pragma("omp parallel for") \
+    for (int nid = 0; nid < size; ++nid) { \
+        BODY; \
+    } \
+} \
+GLOBAL void FUNC_NAME##_PARALLEL(AttributeData attribute_data) { \
+    PREAMBLE_ATTRIBUTES(CLASS_NAME) \
+    PREAMBLE \
+    int nid = blockIdx.x * blockDim.x + threadIdx.x; \
+    if (nid < size) { \
+        unsigned int *b_outputs = (unsigned int*)outputs; \
+        for (int index = history_size - 1 ; index > 0 ; --index) \
+            b_outputs[size * index + nid] = (att->output_type == BIT) \
+                ? (b_outputs[size * index + nid] >> 1) \
+                    | (b_outputs[size * (index - 1) + nid] << 31) \
+                : b_outputs[size * (index - 1) + nid]; \
+        BODY; \
+    } \
+}
 //
 //////
 
@@ -230,6 +275,14 @@ Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_kernel() { \
     return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL, FUNC_NAME##_PARALLEL); \
 }
 
+// Vectorizable version
+#define BUILD_VEC_ATTRIBUTE_KERNEL( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_kernel() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL, FUNC_NAME##_PARALLEL); \
+}
+
 // Use this to set up attributes learning kernel
 #define BUILD_ATTRIBUTE_LEARNING_KERNEL( \
     CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
@@ -237,6 +290,24 @@ DEF_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
 Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_learning_kernel() { \
     return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL, FUNC_NAME##_PARALLEL); \
 }
+
+// Use this to set up one of several attribute kernels
+// Defines a static get_FUNC_NAME() getter instead of get_kernel(), which the
+//   class implements itself to choose between variants
+#define BUILD_ATTRIBUTE_KERNEL_VARIANT( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+static Kernel<ATTRIBUTE_ARGS> get_##FUNC_NAME() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL, FUNC_NAME##_PARALLEL); \
+}
+
+// Vectorizable version
+#define BUILD_VEC_ATTRIBUTE_KERNEL_VARIANT( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+static Kernel<ATTRIBUTE_ARGS> get_##FUNC_NAME() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL, FUNC_NAME##_PARALLEL); \
+}
 //
 //////
 
@@ -274,6 +345,21 @@ HOST void FUNC_NAME##_SERIAL(AttributeData attribute_data) { \
         BODY; \
     } \
 }
+
+// Vectorizable attribute kernel
+// The output history is shifted before the main loop, leaving BODY free of
+//   inner loops so that it can be vectorized
+// BODY should write its new output with SET_FLOAT_OUTPUT or SET_BIT_OUTPUT
+#define DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+HOST void FUNC_NAME##_SERIAL(AttributeData attribute_data) { \
+    PREAMBLE_ATTRIBUTES(CLASS_NAME) \
+    PREAMBLE \
+    SHIFT_ALL_OUTPUTS \
+    _Pragma("omp parallel for") \
+    for (int nid = 0; nid < size; ++nid) { \
+        BODY; \
+    } \
+}
 //
 /////
 
@@ -295,6 +381,14 @@ Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_kernel() { \
     return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL); \
 }
 
+// Vectorizable version
+#define BUILD_VEC_ATTRIBUTE_KERNEL( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_kernel() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL); \
+}
+
 // Use this to set up attributes learning kernel
 #define BUILD_ATTRIBUTE_LEARNING_KERNEL( \
     CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
@@ -302,6 +396,24 @@ DEF_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
 Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_learning_kernel() { \
     return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL); \
 }
+
+// Use this to set up one of several attribute kernels
+// Defines a static get_FUNC_NAME() getter instead of get_kernel(), which the
+//   class implements itself to choose between variants
+#define BUILD_ATTRIBUTE_KERNEL_VARIANT( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+static Kernel<ATTRIBUTE_ARGS> get_##FUNC_NAME() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL); \
+}
+
+// Vectorizable version
+#define BUILD_VEC_ATTRIBUTE_KERNEL_VARIANT( \
+    CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+DEF_VEC_ATT_KERNEL(CLASS_NAME, FUNC_NAME, PREAMBLE, BODY) \
+static Kernel<ATTRIBUTE_ARGS> get_##FUNC_NAME() { \
+    return Kernel<ATTRIBUTE_ARGS>(FUNC_NAME##_SERIAL); \
+}
 //
 //////
 
@@ -318,6 +430,33 @@ Kernel<ATTRIBUTE_ARGS> CLASS_NAME::get_learning_kernel() { \
         f_outputs[size * index + nid] = f_outputs[size * (index - 1) + nid]; \
     f_outputs[nid] = (new_output);
 
+/* Shifts the history of every neuron at once
+ * History rows are contiguous, so float histories are a single move.
+ * Bit histories carry the oldest bit of each word into the next row, leaving
+ *   the newest word for SET_BIT_OUTPUT. */
+#define SHIFT_ALL_OUTPUTS \
+    if (att->output_type == BIT) { \
+        unsigned int *b_outputs = (unsigned int*)outputs; \
+        for (int index = history_size - 1 ; index > 0 ; --index) \
+            for (int nid = 0 ; nid < size ; ++nid) \
+                b_outputs[size * index + nid] = \
+                    (b_outputs[size * index + nid] >> 1) \
+                    | (b_outputs[size * (index - 1) + nid] << 31); \
+    } else if (history_size > 1) \
+        memmove(outputs + size, outputs, \
+            (history_size - 1) * size * sizeof(Output));
+
+/* Sets the newest output in vectorizable kernels (see DEF_VEC_ATT_KERNEL) */
+#define SET_FLOAT_OUTPUT(f_outputs, new_output) \
+    f_outputs[nid] = (new_output);
+
+/* Bit version of SET_FLOAT_OUTPUT
+ * Defines prev_bit like SHIFT_BIT_OUTPUTS */
+#define SET_BIT_OUTPUT(b_outputs, new_bit) \
+    unsigned int curr_value = b_outputs[nid]; \
+    b_outputs[nid] = (curr_value >> 1) | ((new_bit) << 31); \
+    bool prev_bit = curr_value >> 31;
+
 #define SHIFT_BIT_OUTPUTS(b_outputs, new_bit) \
     /* Reduce reads, chain values */ \
     unsigned int curr_value = b_outputs[size * (history_size-1) + nid]; \
@@ -1,11 +1,166 @@
+#include <string>
+
 #include "state/impl/backprop_rate_encoding_attributes.h"
+#include "state/weight_matrix.h"
+#include "engine/kernel/synapse_kernel.h"
+#include "network/connection.h"
+#include "util/resources/resource_manager.h"
 #include "util/logger.h"
 
 REGISTER_ATTRIBUTES(BackpropRateEncodingAttributes, "backprop_rate_encoding", FLOAT)
+REGISTER_WEIGHT_MATRIX(BackpropWeightMatrix, "backprop_rate_encoding")
+
+/******************************************************************************/
+/************************* BACKPROP UPDATER KERNELS ***************************/
+/******************************************************************************/
+
+/* Backpropagation for fully connected matrices
+ *
+ * The feedforward cluster runs weight updates from the output layers
+ *   backwards, so by the time a layer's updaters run, every layer it
+ *   projects to has already pushed its error back into |error_deltas|.
+ *
+ * For each connection:
+ *   1. Deltas of the destination layer are computed from its error and the
+ *      derivative of the activation function (1 - y^2 for active neurons).
+ *   2. If the source layer is also a backprop layer, the deltas are
+ *      propagated to its error through the transposed weights.  These are
+ *      transposed at the start of the update phase, before any learning.
+ *   3. The deltas and source outputs are recorded in the minibatch history.
+ *      Once the batch is full, the weight gradient (deltas^T * inputs) is
+ *      applied as a single blocked GEMM.
+ *
+ * Only first order fully connected connections are supported, and only on
+ *   the host: there is no parallel kernel.  get_updaters() raises an error
+ *   for any other connection type, or for layers placed on a device.
+ */
+
+#define BP_TO_BLOCK 32
+#define BP_FROM_BLOCK 256
+#define BP_PARTIAL_SUMS 8
+
+void update_backprop_fully_connected_SERIAL(SynapseData synapse_data) {
+    SYNAPSE_PREAMBLE;
+
+    BackpropRateEncodingAttributes *att =
+        (BackpropRateEncodingAttributes*)synapse_data.attributes;
+    BackpropWeightMatrix *mat = (BackpropWeightMatrix*)synapse_data.matrix;
+    float *error_deltas = att->error_deltas.get();
+    float *targets = att->targets.get();
+    const bool output_layer = att->output_layer;
+
+    const int batch_size = mat->batch_size;
+    const int batch_index = mat->batch_index;
+    float * const batch_deltas = mat->batch_deltas.get();
+    float * const batch_inputs = mat->batch_inputs.get();
+    float *deltas = batch_deltas + batch_index * to_size;
+    float *sources = batch_inputs + batch_index * from_size;
+
+    /* Destination deltas */
+    _Pragma("omp parallel for")
+    for (int to_index = 0 ; to_index < to_size ; ++to_index) {
+        float out = destination_outputs[to_index].f;
+        float error = (output_layer)
+            ? targets[to_index] - out
+            : error_deltas[to_index];
+        error_deltas[to_index] = error;
+        deltas[to_index] = (out > 0.0f) ? error * (1.0f - out * out) : 0.0f;
+    }
+
+    /* Source outputs */
+    _Pragma("omp parallel for")
+    for (int from_index = 0 ; from_index < from_size ; ++from_index)
+        sources[from_index] = extract(outputs[from_index], delay);
+
+    /* Error propagation
+     * Rows of the transposed matrix are contiguous over destinations.
+     * Partial sums keep the dot product vectorizable. */
+    if (mat->propagate) {
+        float *from_error_deltas =
+            ((BackpropRateEncodingAttributes*)synapse_data.from_attributes)
+                ->error_deltas.get();
+        const float *weights_transposed = mat->weights_transposed.get();
+        const int vec_size = to_size - (to_size % BP_PARTIAL_SUMS);
+
+        _Pragma("omp parallel for")
+        for (int from_index = 0 ; from_index < from_size ; ++from_index) {
+            const float *row = weights_transposed + from_index * to_size;
+
+            float partial[BP_PARTIAL_SUMS] = { 0.0f };
+            for (int to_index = 0 ; to_index < vec_size ;
+                    to_index += BP_PARTIAL_SUMS)
+                for (int k = 0 ; k < BP_PARTIAL_SUMS ; ++k)
+                    partial[k] += row[to_index + k] * deltas[to_index + k];
+
+            float sum = 0.0f;
+            for (int k = 0 ; k < BP_PARTIAL_SUMS ; ++k)
+                sum += partial[k];
+            for (int to_index = vec_size ; to_index < to_size ; ++to_index)
+                sum += row[to_index] * deltas[to_index];
+
+            from_error_deltas[from_index] += sum;
+        }
+    }
+
+    /* Wait for the minibatch to fill */
+    if (batch_index + 1 < batch_size) {
+        mat->batch_index = batch_index + 1;
+        return;
+    }
+    mat->batch_index = 0;
+
+    /* Weight update: weights += rate / batch * (deltas^T * inputs)
+     * Tiles of the weight matrix are updated with the batch of source
+     *   outputs for that tile, which stays in cache across destinations.
+     * Inactive destinations have zero deltas and are skipped. */
+    const float scale = mat->learning_rate / batch_size;
+
+    _Pragma("omp parallel for collapse(2)")
+    for (int to_block = 0 ; to_block < to_size ; to_block += BP_TO_BLOCK) {
+        for (int from_block = 0 ; from_block < from_size ;
+                from_block += BP_FROM_BLOCK) {
+            int to_end = (to_block + BP_TO_BLOCK < to_size)
+                ? to_block + BP_TO_BLOCK : to_size;
+            int from_end = (from_block + BP_FROM_BLOCK < from_size)
+                ? from_block + BP_FROM_BLOCK : from_size;
+
+            for (int to_index = to_block ; to_index < to_end ; ++to_index) {
+                float *row = weights + to_index * from_size;
+
+                for (int b = 0 ; b < batch_size ; ++b) {
+                    float delta = scale * batch_deltas[b * to_size + to_index];
+                    if (delta == 0.0f) continue;
 
-KernelList<SYNAPSE_ARGS> BackpropRateEncodingAttributes::get_updater(
+                    const float *in = batch_inputs + b * from_size;
+                    for (int from_index = from_block ;
+                            from_index < from_end ; ++from_index)
+                        row[from_index] += delta * in[from_index];
+                }
+            }
+        }
+    }
+}
+
+KernelList<SYNAPSE_ARGS> BackpropRateEncodingAttributes::get_updaters(
         Connection* conn) {
-    return { };
+    if (not ResourceManager::get_instance()->is_host(device_id))
+        LOG_ERROR(
+            "Backprop learning is only implemented on the host!");
+
+    // Source outputs are only available to updaters within
+    //   the same feedforward structure (see synapse_data.cpp)
+    if (conn->from_layer->structure != conn->to_layer->structure)
+        LOG_ERROR(
+            "Backprop learning requires connections within one structure: "
+            + conn->str());
+
+    if (not conn->second_order and conn->get_type() == FULLY_CONNECTED)
+        return { Kernel<SYNAPSE_ARGS>(
+            update_backprop_fully_connected_SERIAL, nullptr) };
+
+    LOG_ERROR(
+        "Backprop learning is only implemented for first order "
+        "fully connected connections: " + conn->str());
 }
 
 /******************************************************************************/
@@ -16,4 +171,69 @@ BackpropRateEncodingAttributes::BackpropRateEncodingAttributes(Layer *layer)
         : RateEncodingAttributes(layer) {
     this->error_deltas = Attributes::create_neuron_variable<float>(0.0);
     Attributes::register_neuron_variable("error deltas", &error_deltas);
+
+    this->targets = Attributes::create_neuron_variable<float>(0.0);
+    Attributes::register_neuron_variable("targets", &targets);
+
+    this->output_layer = true;
+    for (auto conn : layer->get_output_connections())
+        if (conn->to_layer->neural_model == "backprop_rate_encoding")
+            this->output_layer = false;
+}
+
+void BackpropRateEncodingAttributes::process_weight_matrix(
+        WeightMatrix* matrix) {
+    BackpropWeightMatrix *bp_mat = (BackpropWeightMatrix*)matrix;
+    auto conn = matrix->connection;
+
+    bp_mat->learning_rate =
+        std::stof(conn->get_parameter("learning rate", "0.01"));
+    bp_mat->batch_size =
+        std::stoi(conn->get_parameter("batch size", "1"));
+    bp_mat->batch_index = 0;
+    bp_mat->propagate =
+        conn->from_layer->neural_model == "backprop_rate_encoding";
+
+    if (bp_mat->batch_size < 1)
+        LOG_ERROR(
+            "Error in backprop connection " + conn->str() + ":\n"
+            "  Batch size must be positive!");
+
+    if (conn->plastic) {
+        bp_mat->batch_deltas = Pointer<float>(
+            bp_mat->batch_size * conn->to_layer->size, 0.0);
+        bp_mat->batch_inputs = Pointer<float>(
+            bp_mat->batch_size * conn->from_layer->size, 0.0);
+
+        // Errors are propagated through the transposed matrix
+        if (bp_mat->propagate)
+            matrix->set_transpose_flag(true);
+    }
+}
+
+void BackpropWeightMatrix::estimate_processing(
+        std::map<std::string, size_t>& arrays) {
+    // See process_weight_matrix()
+    if (not connection->plastic) return;
+
+    int batch_size = std::stoi(connection->get_parameter("batch size", "1"));
+    arrays["batch deltas"] =
+        batch_size * connection->to_layer->size * sizeof(float);
+    arrays["batch inputs"] =
+        batch_size * connection->from_layer->size * sizeof(float);
+
+    if (connection->from_layer->neural_model == "backprop_rate_encoding")
+        arrays["weights transposed"] =
+            connection->get_num_weights() * sizeof(float);
+}
+
+void BackpropWeightMatrix::get_extra_memory(
+        std::map<std::string, BasePointer*>& pointers) {
+    pointers["batch deltas"] = &batch_deltas;
+    pointers["batch inputs"] = &batch_inputs;
+}
+
+BackpropWeightMatrix::~BackpropWeightMatrix() {
+    batch_deltas.free();
+    batch_inputs.free();
 }
@@ -11,11 +11,50 @@ class BackpropRateEncodingAttributes : public RateEncodingAttributes {
             return cluster_type == FEEDFORWARD;
         }
 
-        virtual KernelList<SYNAPSE_ARGS> get_updater(Connection* conn);
+        // Backprop learning is implemented for fully connected
+        //   connections on the host only
+        virtual KernelList<SYNAPSE_ARGS> get_updaters(Connection* conn);
 
+        // Hidden layer errors are accumulated anew every timestep
+        virtual KeySet get_init_keys() { return { "error deltas" }; }
+
+        virtual void process_weight_matrix(WeightMatrix* matrix);
+
+        // Layers that do not project to other backprop layers compute their
+        //   error from the targets, rather than accumulating it
+        bool output_layer;
+
+        // Error with respect to the output (target - output for output layers)
         Pointer<float> error_deltas;
 
+        // Expected outputs, provided by the environment
+        Pointer<float> targets;
+
     ATTRIBUTE_MEMBERS
 };
 
+class BackpropWeightMatrix : public WeightMatrix {
+    public:
+        virtual ~BackpropWeightMatrix();
+
+        float learning_rate;
+        int batch_size;
+        int batch_index;
+
+        // Whether the source layer takes part in backpropagation
+        bool propagate;
+
+        // Minibatch history of deltas (batch x to_size)
+        //   and source outputs (batch x from_size)
+        Pointer<float> batch_deltas;
+        Pointer<float> batch_inputs;
+
+        virtual void estimate_processing(
+            std::map<std::string, size_t>& arrays);
+        virtual void get_extra_memory(
+            std::map<std::string, BasePointer*>& pointers);
+
+    WEIGHT_MATRIX_MEMBERS(BackpropWeightMatrix);
+};
+
 #endif
@@ -1,9 +1,13 @@
 #include <string>
+#include <vector>
+#include <cstdint>
 #include <math.h>
 
 #include "state/impl/game_of_life_attributes.h"
 #include "state/weight_matrix.h"
 #include "engine/kernel/synapse_kernel.h"
+#include "network/connection.h"
+#include "util/resources/resource_manager.h"
 
 REGISTER_ATTRIBUTES(GameOfLifeAttributes, "game_of_life", BIT)
 
@@ -21,7 +25,9 @@ BUILD_ATTRIBUTE_KERNEL(GameOfLifeAttributes, gol_attribute_kernel,
 
     int input = (int)inputs[nid];
     unsigned int *lives = (unsigned int*)outputs;
-    bool prev_live = lives[nid] & 1;
+
+    // The most recent state is the most significant bit
+    bool prev_live = lives[nid] >> 31;
     bool live = (prev_live)
         ? (input >= survival_min and input <= survival_max)
         : (input >= birth_min and input <= birth_max);
@@ -32,6 +38,170 @@ BUILD_ATTRIBUTE_KERNEL(GameOfLifeAttributes, gol_attribute_kernel,
     SHIFT_BIT_OUTPUTS(lives, live);
 )
 
+/******************************************************************************/
+/********************** CELLULAR AUTOMATON KERNELS ****************************/
+/******************************************************************************/
+
+/* Neighbor counting for uniform square neighborhoods
+ *
+ * Cells are packed 64 to a word, one row at a time, from the bit of each
+ *   source output word that corresponds to the connection delay.  Each row
+ *   is padded with a halo word on either side that holds the wrapped (or
+ *   dead) cells, so horizontal neighbors are word shifts across adjacent
+ *   words and vertical neighbors are adjacent rows.
+ *
+ * Every neighbor offset contributes one bitboard, which is added into a
+ *   bit-sliced counter (plane k holds bit k of the count of 64 cells).
+ *   The counts are then unpacked and aggregated into the inputs with the
+ *   connection's uniform weight.
+ */
+
+#define CA_MAX_RADIUS 7
+#define CA_MAX_PLANES 8
+
+/* Packs the cells of one row into |words| 64 bit words
+ * Word w holds the cells starting at column 64 * (w - 1) */
+static void pack_row(const Output *row_outputs, uint64_t *packed,
+        int words, int columns, bool wrap, int bit) {
+    for (int w = 0 ; w < words ; ++w) {
+        int start = 64 * (w - 1);
+        uint64_t word = 0;
+
+        // Fast path for words entirely within the row
+        if (start >= 0 and start + 64 <= columns) {
+            for (int j = 0 ; j < 64 ; ++j)
+                word |= (uint64_t)((row_outputs[start + j].i >> bit) & 1) << j;
+        } else {
+            for (int j = 0 ; j < 64 ; ++j) {
+                int column = start + j;
+                if (wrap)
+                    column = (column % columns + columns) % columns;
+                else if (column < 0 or column >= columns)
+                    continue;
+                word |= (uint64_t)((row_outputs[column].i >> bit) & 1) << j;
+            }
+        }
+        packed[w] = word;
+    }
+}
+
+/* Adds a bitboard into a bit-sliced counter */
+#define CA_ADD_BOARD(planes, num_planes, board) \
+{ \
+    uint64_t carry = board; \
+    for (int k = 0 ; k < num_planes and carry ; ++k) { \
+        uint64_t next = planes[k] & carry; \
+        planes[k] ^= carry; \
+        carry = next; \
+    } \
+}
+
+void count_neighbors_bit_parallel_SERIAL(SynapseData synapse_data) {
+    SYNAPSE_PREAMBLE;
+    CONVERGENT_PREAMBLE;
+
+    const int radius = row_field_size / 2;
+    const int bit = 31 - (delay & 0x1F);
+    const float weight = weights[0];
+
+    // Halo words on either side of each row
+    const int row_words = (to_columns + 63) / 64;
+    const int padded_words = row_words + 2;
+
+    int num_planes = 1;
+    while ((1 << num_planes) <= kernel_size) ++num_planes;
+
+    std::vector<uint64_t> packed(from_rows * padded_words);
+    uint64_t *packed_data = packed.data();
+
+    _Pragma("omp parallel for")
+    for (int row = 0 ; row < from_rows ; ++row)
+        pack_row(outputs + row * from_columns,
+            packed_data + row * padded_words,
+            padded_words, from_columns, wrap, bit);
+
+    _Pragma("omp parallel for collapse(2)")
+    for (int to_row = 0 ; to_row < to_rows ; ++to_row) {
+        for (int w = 0 ; w < row_words ; ++w) {
+            uint64_t planes[CA_MAX_PLANES] = { 0 };
+
+            for (int dr = -radius ; dr <= radius ; ++dr) {
+                int from_row = to_row + dr;
+                if (wrap)
+                    from_row = (from_row % from_rows + from_rows) % from_rows;
+                else if (from_row < 0 or from_row >= from_rows)
+                    continue;
+
+                const uint64_t *row = packed_data
+                    + from_row * padded_words + w + 1;
+                uint64_t left = row[-1], center = row[0], right = row[1];
+
+                CA_ADD_BOARD(planes, num_planes, center);
+                for (int d = 1 ; d <= radius ; ++d) {
+                    CA_ADD_BOARD(planes, num_planes,
+                        (center << d) | (left >> (64 - d)));
+                    CA_ADD_BOARD(planes, num_planes,
+                        (center >> d) | (right << (64 - d)));
+                }
+            }
+
+            // Unpack counts for the cells in this word
+            int start = 64 * w;
+            int count = (to_columns - start < 64) ? to_columns - start : 64;
+            float *word_inputs = inputs + to_row * to_columns + start;
+            for (int j = 0 ; j < count ; ++j) {
+                int sum = 0;
+                for (int k = 0 ; k < num_planes ; ++k)
+                    sum |= ((planes[k] >> j) & 1) << k;
+                word_inputs[j] = aggregate(word_inputs[j], sum * weight);
+            }
+        }
+    }
+}
+
+/* Checks whether a connection can use bit-parallel neighbor counting
+ * The source must be a BIT layer with the same dimensions, and the
+ *   neighborhood must be a centered square with stride and spacing of one
+ *   and a single fixed weight. */
+static bool is_uniform_neighborhood(Connection *conn, WeightMatrix *matrix) {
+    if (conn->get_type() != CONVERGENT
+            or conn->second_order
+            or conn->plastic
+            or Attributes::get_output_type(conn->from_layer) != BIT
+            or conn->from_layer->rows != conn->to_layer->rows
+            or conn->from_layer->columns != conn->to_layer->columns)
+        return false;
+
+    auto ac = conn->get_config()->get_arborized_config();
+    int radius = ac.row_field_size / 2;
+    if (ac.row_field_size != ac.column_field_size
+            or ac.row_field_size % 2 == 0
+            or radius > CA_MAX_RADIUS
+            or ac.row_stride != 1 or ac.column_stride != 1
+            or ac.row_spacing != 1 or ac.column_spacing != 1
+            or ac.row_offset != -radius or ac.column_offset != -radius)
+        return false;
+
+    Pointer<float> weights = matrix->get_weights();
+    if (weights.get_size() == 0) return false;
+    float weight = weights[0];
+    for (int i = 1 ; i < weights.get_size() ; ++i)
+        if (weights[i] != weight) return false;
+
+    return true;
+}
+
+KernelList<SYNAPSE_ARGS> GameOfLifeAttributes::get_activators(
+        Connection *conn) {
+    // Bit-parallel counting is host only
+    if (bit_parallel
+            and ResourceManager::get_instance()->is_host(device_id)
+            and is_uniform_neighborhood(conn, get_weight_matrix(conn)))
+        return { Kernel<SYNAPSE_ARGS>(
+            count_neighbors_bit_parallel_SERIAL, nullptr) };
+    return Attributes::get_activators(conn);
+}
+
 /******************************************************************************/
 /************************** CLASS FUNCTIONS ***********************************/
 /******************************************************************************/
@@ -42,4 +212,6 @@ GameOfLifeAttributes::GameOfLifeAttributes(Layer *layer)
     this->survival_max = std::stoi(layer->get_parameter("survival_max", "3"));
     this->birth_min = std::stoi(layer->get_parameter("birth_min", "3"));
     this->birth_max = std::stoi(layer->get_parameter("birth_max", "3"));
+    this->bit_parallel =
+        layer->get_parameter("bit parallel", "true") == "true";
 }
@@ -7,11 +7,16 @@ class GameOfLifeAttributes : public Attributes {
     public:
         GameOfLifeAttributes(Layer *layer);
 
+        virtual KernelList<SYNAPSE_ARGS> get_activators(Connection *conn);
+
     int survival_min;
     int survival_max;
     int birth_min;
     int birth_max;
 
+    // Use bit-sliced neighbor counting for uniform neighborhoods
+    bool bit_parallel;
+
     GET_KERNEL_DEF
     ATTRIBUTE_MEMBERS
 };
@@ -15,16 +15,21 @@ BUILD_ATTRIBUTE_KERNEL(GhostFloatAttributes, ghost_float_attribute_kernel,
     float input = inputs[nid];
     SHIFT_FLOAT_OUTPUTS(f_outputs, input);
 )
+/* Ghost inputs hold the raw output words of the source layer (see MPIModule),
+ *   so bit and int inputs are reinterpreted rather than converted.
+ * The newest spike of a bit output is the most significant bit. */
 BUILD_ATTRIBUTE_KERNEL(GhostBitAttributes, ghost_bit_attribute_kernel,
     unsigned int *b_outputs = (unsigned int*)outputs;
+    unsigned int *b_inputs = (unsigned int*)inputs;
     ,
-    unsigned int input = inputs[nid];
-    SHIFT_BIT_OUTPUTS(b_outputs, input & 1);
+    unsigned int input = b_inputs[nid];
+    SHIFT_BIT_OUTPUTS(b_outputs, input >> 31);
 )
 BUILD_ATTRIBUTE_KERNEL(GhostIntAttributes, ghost_int_attribute_kernel,
     int *i_outputs = (int*)outputs;
+    int *i_inputs = (int*)inputs;
     ,
-    int input = inputs[nid];
+    int input = i_inputs[nid];
     SHIFT_FLOAT_OUTPUTS(i_outputs, input);
 )
 
@@ -1,9 +1,16 @@
+#include <map>
+#include <tuple>
+#include <vector>
 #include <string>
+#include <sstream>
 #include <math.h>
 
 #include "state/impl/izhikevich_attributes.h"
+#include "state/impl/izhikevich_integrator.h"
 #include "engine/kernel/synapse_kernel.h"
 #include "util/tools.h"
+#include "util/fast_math.h"
+#include "util/resources/resource_manager.h"
 
 REGISTER_ATTRIBUTES(IzhikevichAttributes, "izhikevich", BIT)
 REGISTER_WEIGHT_MATRIX(IzhikevichWeightMatrix, "izhikevich")
@@ -34,6 +41,31 @@ DEF_PARAM(LOW_THRESHOLD    , 0.02, 0.25, -65.0, 2   ); // Low Threshold
 DEF_PARAM(THALAMO_CORTICAL , 0.02, 0.25, -65.0, 0.05); // Thalamo-cortical
 DEF_PARAM(RESONATOR        , 0.1 , 0.26, -65.0, 2   ); // Resonator
 
+/* Parameters of a named neuron class */
+static IzhikevichParameters get_class_parameters(std::string str) {
+    if (str == "default")                 return DEFAULT;
+    else if (str == "regular")            return REGULAR;
+    else if (str == "bursting")           return BURSTING;
+    else if (str == "chattering")         return CHATTERING;
+    else if (str == "fast")               return FAST;
+    else if (str == "low_threshold")      return LOW_THRESHOLD;
+    else if (str == "thalamo_cortical")   return THALAMO_CORTICAL;
+    else if (str == "resonator")          return RESONATOR;
+    else
+        LOG_ERROR(
+            "Unrecognized parameter string: " + str);
+}
+
+static std::string strip(std::string str) {
+    size_t start = str.find_first_not_of(" ");
+    if (start == std::string::npos) return "";
+    return str.substr(start, str.find_last_not_of(" ") - start + 1);
+}
+
+/* Per-neuron parameters
+ * Besides a single class or a randomized configuration, layers may mix
+ *   classes with a comma separated list of "class:fraction" entries, such as
+ *   "regular:0.8, fast:0.2".  Neurons are assigned classes at random. */
 static void create_parameters(std::string str,
         float* as, float* bs, float* cs, float* ds, int size) {
     if (str == "random positive") {
@@ -45,6 +77,7 @@ static void create_parameters(std::string str,
             cs[i] = -65.0 + (15.0 * pow(fRand(), 2));
             ds[i] = 8.0 - (6.0 * pow(fRand(), 2));
         }
+        return;
     } else if (str == "random negative") {
         //(ai; bi) = (0:02; 0:25) + (0:08;-0:05)ri and (ci; di)=(-65; 2).
         for (int i = 0 ; i < size ; ++i) {
@@ -53,27 +86,39 @@ static void create_parameters(std::string str,
             cs[i] = -65.0;
             ds[i] = 2.0;
         }
-    } else {
-        IzhikevichParameters params(0,0,0,0);
-        if (str == "default")                 params = DEFAULT;
-        else if (str == "regular")            params = REGULAR;
-        else if (str == "bursting")           params = BURSTING;
-        else if (str == "chattering")         params = CHATTERING;
-        else if (str == "fast")               params = FAST;
-        else if (str == "low_threshold")      params = LOW_THRESHOLD;
-        else if (str == "thalamo_cortical")   params = THALAMO_CORTICAL;
-        else if (str == "resonator")          params = RESONATOR;
-        else
-            LOG_ERROR(
-                "Unrecognized parameter string: " + str);
+        return;
+    }
 
+    std::vector<IzhikevichParameters> classes;
+    std::vector<float> fractions;
+    float total = 0.0;
+
+    std::stringstream stream(str);
+    std::string entry;
+    while (std::getline(stream, entry, ',')) {
+        size_t colon = entry.find(':');
+        classes.push_back(get_class_parameters(strip(entry.substr(0, colon))));
+        fractions.push_back((colon == std::string::npos)
+            ? 1.0 : std::stof(entry.substr(colon + 1)));
+        total += fractions.back();
+    }
 
-        for (int i = 0 ; i < size ; ++i) {
-            as[i] = params.a;
-            bs[i] = params.b;
-            cs[i] = params.c;
-            ds[i] = params.d;
+    if (classes.size() == 0 or total <= 0.0)
+        LOG_ERROR(
+            "Unrecognized parameter string: " + str);
+
+    for (int i = 0 ; i < size ; ++i) {
+        int index = 0;
+        if (classes.size() > 1) {
+            float r = fRand() * total;
+            while (index < classes.size() - 1 and r >= fractions[index])
+                r -= fractions[index++];
         }
+
+        as[i] = classes[index].a;
+        bs[i] = classes[index].b;
+        cs[i] = classes[index].c;
+        ds[i] = classes[index].d;
     }
 }
 
@@ -99,118 +144,288 @@ static void create_parameters(std::string str,
 #define STDP_A_POS 0.004
 #define STDP_A_NEG 0.004
 
-BUILD_ATTRIBUTE_KERNEL(IzhikevichAttributes, iz_attribute_kernel,
-    float *ampa_conductances = att->ampa_conductance.get();
-    float *nmda_conductances = att->nmda_conductance.get();
-    float *gabaa_conductances = att->gabaa_conductance.get();
-    float *gabab_conductances = att->gabab_conductance.get();
-    float *multiplicative_factors = att->multiplicative_factor.get();
-    float *dopamines = att->dopamine.get();
-
-    float *voltages = att->voltage.get();
-    float *recoveries = att->recovery.get();
-    float *postsyn_exc_traces = att->postsyn_exc_trace.get();
-    int *time_since_spikes = att->time_since_spike.get();
-    unsigned int *spikes = (unsigned int*)outputs;
-    float *as = att->as.get();
-    float *bs = att->bs.get();
-    float *cs = att->cs.get();
-    float *ds = att->ds.get();
+/* Neuron parameters
+ * The kernels read a..d from the packed table (see izhikevich_attributes.h)
+ *   rather than the per-neuron "a".."d" variables, using one of three
+ *   layouts chosen when the table is packed:
+ *     shared: every neuron uses type 0, so nothing is read per neuron
+ *     typed:  neurons read a type ID, and types share a few cache lines
+ *     neuron: every neuron is its own type, and the table is streamed */
+#define IZ_NEURON_PARAMS_shared \
+    float a = neuron_params[IZ_PARAM_INDEX(0, 0)]; \
+    float b = neuron_params[IZ_PARAM_INDEX(0, 1)]; \
+    float c = neuron_params[IZ_PARAM_INDEX(0, 2)]; \
+    float d = neuron_params[IZ_PARAM_INDEX(0, 3)];
+
+#define IZ_NEURON_PARAMS_typed \
+    int type = neuron_types[nid]; \
+    float a = neuron_params[IZ_PARAM_INDEX(type, 0)]; \
+    float b = neuron_params[IZ_PARAM_INDEX(type, 1)]; \
+    float c = neuron_params[IZ_PARAM_INDEX(type, 2)]; \
+    float d = neuron_params[IZ_PARAM_INDEX(type, 3)];
+
+#define IZ_NEURON_PARAMS_neuron \
+    float a = neuron_params[IZ_PARAM_INDEX(nid, 0)]; \
+    float b = neuron_params[IZ_PARAM_INDEX(nid, 1)]; \
+    float c = neuron_params[IZ_PARAM_INDEX(nid, 2)]; \
+    float d = neuron_params[IZ_PARAM_INDEX(nid, 3)];
+
+#define IZ_ATTRIBUTE_KERNEL(PARAMS) \
+BUILD_ATTRIBUTE_KERNEL_VARIANT(IzhikevichAttributes, \
+        iz_attribute_kernel_##PARAMS, \
+    float *ampa_conductances = att->ampa_conductance.get(); \
+    float *nmda_conductances = att->nmda_conductance.get(); \
+    float *gabaa_conductances = att->gabaa_conductance.get(); \
+    float *gabab_conductances = att->gabab_conductance.get(); \
+    float *multiplicative_factors = att->multiplicative_factor.get(); \
+    float *dopamines = att->dopamine.get(); \
+ \
+    float *voltages = att->voltage.get(); \
+    float *recoveries = att->recovery.get(); \
+    float *postsyn_exc_traces = att->postsyn_exc_trace.get(); \
+    int *time_since_spikes = att->time_since_spike.get(); \
+    unsigned int *spikes = (unsigned int*)outputs; \
+    int *neuron_types = att->neuron_types.get(); \
+    float *neuron_params = att->neuron_params.get(); \
+ \
+    , \
+ \
+    /********************** \
+     *** VOLTAGE UPDATE *** \
+     **********************/ \
+    float ampa_conductance = ampa_conductances[nid]; \
+    float nmda_conductance = nmda_conductances[nid]; \
+    float gabaa_conductance = gabaa_conductances[nid]; \
+    float gabab_conductance = gabab_conductances[nid]; \
+    float multiplicative_factor = multiplicative_factors[nid]; \
+ \
+    float voltage = voltages[nid]; \
+    float recovery = recoveries[nid]; \
+    float base_current = inputs[nid]; \
+ \
+    IZ_NEURON_PARAMS_##PARAMS \
+ \
+    /* Euler's method for voltage/recovery update */ \
+    /* If the voltage exceeds the spiking threshold, break */ \
+    for (int i = 0 ; (i < IZ_EULER_RES) and (voltage < IZ_SPIKE_THRESH) ; ++i) { \
+        /* Start with AMPA conductance */ \
+        float current = -ampa_conductance * voltage; \
+ \
+        /* NMDA nonlinear voltage dependence */ \
+        float temp = powf((voltage + 80) / 60, 2); \
+        current -= nmda_conductance * (temp / (1+temp)) * voltage; \
+ \
+        /* GABA conductances */ \
+        current -= gabaa_conductance * (voltage + 70); \
+        current -= gabab_conductance * (voltage + 90); \
+ \
+        /* Multiplicative factor for synaptic currents */ \
+        current *= 1 + multiplicative_factor; \
+ \
+        /* Add the base current after multiplicative factor */ \
+        current += base_current; \
+ \
+        /* Update voltage */ \
+        /* For numerical stability, use hybrid numerical method */ \
+        /*   (see section 5b of "Hybrid Spiking Models" by Izhikevich) */ \
+        float delta_v = (0.04 * voltage * voltage) + \
+                        (5*voltage) + 140 - recovery + current; \
+ \
+        float sum_conductances = \
+            ampa_conductance + nmda_conductance + \
+            gabaa_conductance + gabab_conductance; \
+ \
+        voltage = \
+            (voltage + IZ_EULER_RES_INV * \
+                (delta_v \
+                    + (gabaa_conductance * -70) \
+                    + (gabab_conductance * -90))) \
+            / (1 + (IZ_EULER_RES_INV * sum_conductances)); \
+ \
+        /* If the voltage explodes (voltage == NaN -> voltage != voltage), */ \
+        /*   set it to threshold before it corrupts the recovery variable */ \
+        voltage = (voltage != voltage) ? IZ_SPIKE_THRESH : voltage; \
+ \
+        float adjusted_tau = (voltage > IZ_SPIKE_THRESH) \
+            ? delta_v \
+                / (IZ_SPIKE_THRESH - voltage + delta_v) \
+                * IZ_EULER_RES_INV \
+            : IZ_EULER_RES_INV; \
+ \
+        /* Update recovery variable */ \
+        recovery += a * adjusted_tau * ((b * voltage) - recovery); \
+    } \
+ \
+    ampa_conductances[nid] = 0.0; \
+    nmda_conductances[nid] = 0.0; \
+    gabaa_conductances[nid] = 0.0; \
+    gabab_conductances[nid] = 0.0; \
+    multiplicative_factors[nid] = 0.0; \
+    dopamines[nid] *= DOPAMINE_CLEAR_TAU; \
+ \
+    /******************** \
+     *** SPIKE UPDATE *** \
+     ********************/ \
+    /* Determine if spike occurred */ \
+    unsigned int spike = voltage >= IZ_SPIKE_THRESH; \
+ \
+    SHIFT_BIT_OUTPUTS(spikes, spike); \
+ \
+    /* Update trace, voltage, recovery */ \
+    postsyn_exc_traces[nid] = (prev_bit) \
+        ? STDP_A_NEG \
+        : (postsyn_exc_traces[nid] * STDP_TAU_NEG); \
+    time_since_spikes[nid] = (prev_bit) \
+        ? 0 \
+        : MIN(32, time_since_spikes[nid] + 1); \
+    voltages[nid] = (spike) ? c : voltage; \
+    recoveries[nid] = recovery + (spike * d); \
+)
 
-    ,
+IZ_ATTRIBUTE_KERNEL(shared)
+IZ_ATTRIBUTE_KERNEL(typed)
+IZ_ATTRIBUTE_KERNEL(neuron)
+
+/* Exponential integrator (see izhikevich_integrator.h) */
+#define IZ_EXP_ATTRIBUTE_KERNEL(STEPS, PARAMS) \
+BUILD_VEC_ATTRIBUTE_KERNEL_VARIANT(IzhikevichAttributes, \
+        iz_exp_attribute_kernel_##STEPS##_##PARAMS, \
+    float *ampa_conductances = att->ampa_conductance.get(); \
+    float *nmda_conductances = att->nmda_conductance.get(); \
+    float *gabaa_conductances = att->gabaa_conductance.get(); \
+    float *gabab_conductances = att->gabab_conductance.get(); \
+    float *multiplicative_factors = att->multiplicative_factor.get(); \
+    float *dopamines = att->dopamine.get(); \
+ \
+    float *voltages = att->voltage.get(); \
+    float *recoveries = att->recovery.get(); \
+    float *postsyn_exc_traces = att->postsyn_exc_trace.get(); \
+    int *time_since_spikes = att->time_since_spike.get(); \
+    unsigned int *spikes = (unsigned int*)outputs; \
+    int *neuron_types = att->neuron_types.get(); \
+    float *neuron_params = att->neuron_params.get(); \
+ \
+    const float h = 1.0f / STEPS; \
+ \
+    , \
+ \
+    /********************** \
+     *** VOLTAGE UPDATE *** \
+     **********************/ \
+    float ampa_conductance = ampa_conductances[nid]; \
+    float nmda_conductance = nmda_conductances[nid]; \
+    float gabaa_conductance = gabaa_conductances[nid]; \
+    float gabab_conductance = gabab_conductances[nid]; \
+    float scale = 1.0f + multiplicative_factors[nid]; \
+ \
+    float voltage = voltages[nid]; \
+    float recovery = recoveries[nid]; \
+    float base_current = inputs[nid]; \
+ \
+    IZ_NEURON_PARAMS_##PARAMS \
+    float recovery_rate = 1.0f - fast_exp(-a * h); \
+ \
+    /* Same voltage equation as the Euler update: synaptic currents scaled */ \
+    /*   by the multiplicative factor, plus the hybrid conductance terms */ \
+    float sum_conductances = \
+        ampa_conductance + nmda_conductance + \
+        gabaa_conductance + gabab_conductance; \
+    float reversal_current = \
+        (scale + 1.0f) * (gabaa_conductance * -70 + gabab_conductance * -90); \
+ \
+    for (int i = 0 ; i < STEPS ; ++i) { \
+        /* NMDA nonlinear voltage dependence */ \
+        float temp = (voltage + 80) * (1.0f / 60); \
+        temp *= temp; \
+        float synaptic_conductance = scale * \
+            (ampa_conductance + (nmda_conductance * (temp / (1 + temp))) \
+                + gabaa_conductance + gabab_conductance); \
+ \
+        float delta_v = (0.04f * voltage * voltage) + (5 * voltage) \
+            + 140 - recovery + base_current + reversal_current \
+            - (synaptic_conductance + sum_conductances) * voltage; \
+        float slope = (0.08f * voltage) + 5 \
+            - synaptic_conductance - sum_conductances; \
+ \
+        float next_voltage = \
+            voltage + h * fast_exprel(slope * h) * delta_v; \
+ \
+        /* Clamp at threshold, which also catches NaN */ \
+        next_voltage = (next_voltage < IZ_SPIKE_THRESH) \
+            ? next_voltage : IZ_SPIKE_THRESH; \
+ \
+        /* Update recovery variable */ \
+        float next_recovery = \
+            recovery + recovery_rate * ((b * next_voltage) - recovery); \
+ \
+        /* Hold neurons that have already reached threshold */ \
+        bool active = voltage < IZ_SPIKE_THRESH; \
+        voltage = (active) ? next_voltage : voltage; \
+        recovery = (active) ? next_recovery : recovery; \
+    } \
+ \
+    ampa_conductances[nid] = 0.0; \
+    nmda_conductances[nid] = 0.0; \
+    gabaa_conductances[nid] = 0.0; \
+    gabab_conductances[nid] = 0.0; \
+    multiplicative_factors[nid] = 0.0; \
+    dopamines[nid] *= DOPAMINE_CLEAR_TAU; \
+ \
+    /******************** \
+     *** SPIKE UPDATE *** \
+     ********************/ \
+    /* Determine if spike occurred */ \
+    unsigned int spike = voltage >= IZ_SPIKE_THRESH; \
+ \
+    SET_BIT_OUTPUT(spikes, spike); \
+ \
+    /* Update trace, voltage, recovery */ \
+    int time_since_spike = time_since_spikes[nid]; \
+    postsyn_exc_traces[nid] = (prev_bit) \
+        ? STDP_A_NEG \
+        : (postsyn_exc_traces[nid] * STDP_TAU_NEG); \
+    time_since_spikes[nid] = (prev_bit) \
+        ? 0 \
+        : ((time_since_spike < 32) ? time_since_spike + 1 : 32); \
+    voltages[nid] = (spike) ? c : voltage; \
+    recoveries[nid] = recovery + ((spike) ? d : 0.0f); \
+)
 
-    /**********************
-     *** VOLTAGE UPDATE ***
-     **********************/
-    float ampa_conductance = ampa_conductances[nid];
-    float nmda_conductance = nmda_conductances[nid];
-    float gabaa_conductance = gabaa_conductances[nid];
-    float gabab_conductance = gabab_conductances[nid];
-    float multiplicative_factor = multiplicative_factors[nid];
-
-    float voltage = voltages[nid];
-    float recovery = recoveries[nid];
-    float base_current = inputs[nid];
-
-    float a = as[nid];
-    float b = bs[nid];
-
-    // Euler's method for voltage/recovery update
-    // If the voltage exceeds the spiking threshold, break
-    for (int i = 0 ; (i < IZ_EULER_RES) and (voltage < IZ_SPIKE_THRESH) ; ++i) {
-        // Start with AMPA conductance
-        float current = -ampa_conductance * voltage;
-
-        // NMDA nonlinear voltage dependence
-        float temp = powf((voltage + 80) / 60, 2);
-        current -= nmda_conductance * (temp / (1+temp)) * voltage;
-
-        // GABA conductances
-        current -= gabaa_conductance * (voltage + 70);
-        current -= gabab_conductance * (voltage + 90);
-
-        // Multiplicative factor for synaptic currents
-        current *= 1 + multiplicative_factor;
-
-        // Add the base current after multiplicative factor
-        current += base_current;
-
-        // Update voltage
-        // For numerical stability, use hybrid numerical method
-        //   (see section 5b of "Hybrid Spiking Models" by Izhikevich)
-        float delta_v = (0.04 * voltage * voltage) +
-                        (5*voltage) + 140 - recovery + current;
-
-        float sum_conductances =
-            ampa_conductance + nmda_conductance +
-            gabaa_conductance + gabab_conductance;
-
-        voltage =
-            (voltage + IZ_EULER_RES_INV *
-                (delta_v
-                    + (gabaa_conductance * -70)
-                    + (gabab_conductance * -90)))
-            / (1 + (IZ_EULER_RES_INV * sum_conductances));
-
-        // If the voltage explodes (voltage == NaN -> voltage != voltage),
-        //   set it to threshold before it corrupts the recovery variable
-        voltage = (voltage != voltage) ? IZ_SPIKE_THRESH : voltage;
-
-        float adjusted_tau = (voltage > IZ_SPIKE_THRESH)
-            ? delta_v
-                / (IZ_SPIKE_THRESH - voltage + delta_v)
-                * IZ_EULER_RES_INV
-            : IZ_EULER_RES_INV;
-
-        // Update recovery variable
-        recovery += a * adjusted_tau * ((b * voltage) - recovery);
+IZ_EXP_ATTRIBUTE_KERNEL(1, shared)
+IZ_EXP_ATTRIBUTE_KERNEL(2, shared)
+IZ_EXP_ATTRIBUTE_KERNEL(3, shared)
+IZ_EXP_ATTRIBUTE_KERNEL(4, shared)
+IZ_EXP_ATTRIBUTE_KERNEL(1, typed)
+IZ_EXP_ATTRIBUTE_KERNEL(2, typed)
+IZ_EXP_ATTRIBUTE_KERNEL(3, typed)
+IZ_EXP_ATTRIBUTE_KERNEL(4, typed)
+IZ_EXP_ATTRIBUTE_KERNEL(1, neuron)
+IZ_EXP_ATTRIBUTE_KERNEL(2, neuron)
+IZ_EXP_ATTRIBUTE_KERNEL(3, neuron)
+IZ_EXP_ATTRIBUTE_KERNEL(4, neuron)
+
+#define IZ_EXP_ATTRIBUTE_KERNEL_SWITCH(PARAMS) \
+    switch (integration_steps) { \
+        case 1:  return get_iz_exp_attribute_kernel_1_##PARAMS(); \
+        case 2:  return get_iz_exp_attribute_kernel_2_##PARAMS(); \
+        case 3:  return get_iz_exp_attribute_kernel_3_##PARAMS(); \
+        default: return get_iz_exp_attribute_kernel_4_##PARAMS(); \
     }
 
-    ampa_conductances[nid] = 0.0;
-    nmda_conductances[nid] = 0.0;
-    gabaa_conductances[nid] = 0.0;
-    gabab_conductances[nid] = 0.0;
-    multiplicative_factors[nid] = 0.0;
-    dopamines[nid] *= DOPAMINE_CLEAR_TAU;
-
-    /********************
-     *** SPIKE UPDATE ***
-     ********************/
-    // Determine if spike occurred
-    unsigned int spike = voltage >= IZ_SPIKE_THRESH;
-
-    SHIFT_BIT_OUTPUTS(spikes, spike);
-
-    // Update trace, voltage, recovery
-    postsyn_exc_traces[nid] = (prev_bit)
-        ? STDP_A_NEG
-        : (postsyn_exc_traces[nid] * STDP_TAU_NEG);
-    time_since_spikes[nid] = (prev_bit)
-        ? 0
-        : MIN(32, time_since_spikes[nid] + 1);
-    voltages[nid] = (spike) ? cs[nid] : voltage;
-    recoveries[nid] = recovery + (spike * ds[nid]);
-)
+Kernel<ATTRIBUTE_ARGS> IzhikevichAttributes::get_kernel() {
+    if (not exponential_integrator)
+        switch (param_layout) {
+            case IZ_PARAMS_SHARED: return get_iz_attribute_kernel_shared();
+            case IZ_PARAMS_TYPED:  return get_iz_attribute_kernel_typed();
+            default:               return get_iz_attribute_kernel_neuron();
+        }
+
+    switch (param_layout) {
+        case IZ_PARAMS_SHARED: IZ_EXP_ATTRIBUTE_KERNEL_SWITCH(shared)
+        case IZ_PARAMS_TYPED:  IZ_EXP_ATTRIBUTE_KERNEL_SWITCH(typed)
+        default:               IZ_EXP_ATTRIBUTE_KERNEL_SWITCH(neuron)
+    }
+}
 
 /******************************************************************************/
 /************************* TRACE ACTIVATOR KERNELS ****************************/
@@ -365,11 +580,191 @@ CALC_ALL(activate_iz_gap,
     inputs[to_index] += sum;
 );
 
+/******************************************************************************/
+/*********************** EVENT QUEUE ACTIVATOR KERNELS ************************/
+/******************************************************************************/
+
+/* Longest delay supported by event queue delivery
+ * Polled connections are limited to the history of one output word */
+#define EVENT_QUEUE_MAX_DELAY 1023
+
+/* Outgoing synapse lists
+ * These kernels visit exactly the synapses the polling activators visit,
+ *   so every connection type (including convolutional and sparse) maps
+ *   onto the same (source, destination, weight) triples. */
+#define EVENT_LIST_EXTRACTIONS \
+    IzhikevichWeightMatrix *matrix = \
+        (IzhikevichWeightMatrix*)synapse_data.matrix; \
+    int *event_offsets = matrix->event_offsets.get(); \
+    int *event_weights = matrix->event_weights.get(); \
+    int *event_targets = matrix->event_targets.get();
+
+CALC_ALL(count_iz_events,
+    EVENT_LIST_EXTRACTIONS,
+
+    ,
+
+    event_offsets[from_index + 1] += 1;,
+);
+
+CALC_ALL(fill_iz_events,
+    EVENT_LIST_EXTRACTIONS,
+
+    ,
+
+    int event_index = event_offsets[from_index]++;
+    event_weights[event_index] = weight_index;
+    event_targets[event_index] = to_index;,
+);
+
+void IzhikevichWeightMatrix::build_event_queue() {
+    auto conn = this->connection;
+    int from_size = conn->from_layer->size;
+    int to_size = conn->to_layer->size;
+
+    // Count outgoing synapses and convert to offsets
+    this->event_offsets = Pointer<int>(from_size + 1, 0);
+    count_iz_events_map.at(conn->get_type())
+        .run_serial(SynapseData(this, conn));
+    for (int i = 0 ; i < from_size ; ++i)
+        event_offsets[i + 1] += event_offsets[i];
+
+    // Fill lists, which advances each offset to the start of the next list
+    int num_events = event_offsets[from_size];
+    this->event_weights = Pointer<int>(num_events, 0);
+    this->event_targets = Pointer<int>(num_events, 0);
+    fill_iz_events_map.at(conn->get_type())
+        .run_serial(SynapseData(this, conn));
+    for (int i = from_size ; i > 0 ; --i)
+        event_offsets[i] = event_offsets[i - 1];
+    event_offsets[0] = 0;
+
+    // Spikes are read from the output history at the base delay, so
+    //   the queue only needs to cover the remainder
+    int max_delay = 0;
+    for (int i = 0 ; i < num_events ; ++i)
+        max_delay = MAX(max_delay, delays[event_weights[i]] - conn->delay);
+
+    this->queue_length = max_delay + 1;
+    this->queue_time = 0;
+    this->event_queue = Pointer<float>(queue_length * to_size, 0.0);
+    this->event_short_traces = Pointer<float>(to_size, 0.0);
+    this->event_long_traces = Pointer<float>(to_size, 0.0);
+}
+
+/* Event queue activator
+ *   1. Sources that spiked deposit their weighted spikes into the slot of
+ *      the queue at which they arrive, (t + delay) % queue_length.
+ *   2. Destinations drain the current slot into their conductance traces.
+ * Since the connection is not plastic, weights are constant in transit and
+ *   summing per-synapse traces is equivalent to one trace per neuron. */
+void activate_iz_event_queue_SERIAL(SynapseData synapse_data) {
+    SYNAPSE_PREAMBLE;
+    ACTIV_EXTRACTIONS;
+
+    // Outgoing lists are built lazily, after sparse indices are final
+    if (matrix->event_offsets.is_null())
+        matrix->build_event_queue();
+
+    float *short_conductances = nullptr;
+    float *long_conductances = nullptr;
+    float short_tau = 0.0;
+    float long_tau = 0.0;
+    switch (opcode) {
+        case(ADD):
+            short_conductances = att->ampa_conductance.get();
+            short_tau = AMPA_TAU;
+            long_conductances = att->nmda_conductance.get();
+            long_tau = NMDA_TAU;
+            break;
+        case(SUB):
+            short_conductances = att->gabaa_conductance.get();
+            short_tau = GABAA_TAU;
+            long_conductances = att->gabab_conductance.get();
+            long_tau = GABAB_TAU;
+            break;
+        case(MULT):
+            short_conductances = att->multiplicative_factor.get();
+            short_tau = MULT_TAU;
+            break;
+        case(REWARD):
+            short_conductances = att->dopamine.get();
+            short_tau = DOPAMINE_TAU;
+            break;
+    }
+
+    const int queue_length = matrix->queue_length;
+    const int queue_time = matrix->queue_time;
+    float * const event_queue = matrix->event_queue.get();
+    float * const short_traces = matrix->event_short_traces.get();
+    float * const long_traces = matrix->event_long_traces.get();
+    const int * const event_offsets = matrix->event_offsets.get();
+    const int * const event_weights = matrix->event_weights.get();
+    const int * const event_targets = matrix->event_targets.get();
+
+    /* Deposit */
+    for (int from_index = 0 ; from_index < from_size ; ++from_index) {
+        float spike = extract(outputs[from_index], delay);
+        from_time_since_spike[from_index] =
+            ((spike > 0.0)
+                ? 0
+                : MIN(32, from_time_since_spike[from_index] + 1));
+        if (spike == 0.0) continue;
+
+        for (int i = event_offsets[from_index] ;
+                i < event_offsets[from_index + 1] ; ++i) {
+            int weight_index = event_weights[i];
+            int slot = queue_time + delays[weight_index] - delay;
+            if (slot >= queue_length) slot -= queue_length;
+
+            float weight = weights[weight_index]
+                * (stp_rs[weight_index] * stp_ws[weight_index]);
+            event_queue[slot * to_size + event_targets[i]] +=
+                spike * weight * baseline_conductance;
+        }
+    }
+
+    /* Deliver */
+    float * const arrivals = event_queue + queue_time * to_size;
+
+    _Pragma("omp parallel for")
+    for (int to_index = 0 ; to_index < to_size ; ++to_index) {
+        float arrival = arrivals[to_index];
+        arrivals[to_index] = 0.0;
+
+        float short_trace = short_traces[to_index] + arrival;
+        short_conductances[to_index] += short_trace;
+        short_traces[to_index] = short_trace * short_tau;
+
+        if (long_conductances != nullptr) {
+            float long_trace = long_traces[to_index] + arrival;
+            long_conductances[to_index] += long_trace;
+            long_traces[to_index] = long_trace * long_tau;
+        }
+    }
+
+    matrix->queue_time =
+        (queue_time + 1 == queue_length) ? 0 : queue_time + 1;
+}
+
 KernelList<SYNAPSE_ARGS> IzhikevichAttributes::get_activators(Connection *conn) {
     // Direct connections get a mainline into the input current
     if (conn->get_parameter("direct", "false") == "true")
         return { get_base_activator_kernel(conn) };
 
+    // Event queues keep traces per neuron rather than per synapse, which
+    //   the STDP updaters depend on
+    if (conn->get_parameter("event queue", "false") == "true") {
+        if (not ResourceManager::get_instance()->is_host(device_id))
+            LOG_ERROR(
+                "Event queues are only implemented on the host!");
+        if (conn->plastic or conn->second_order or conn->opcode == GAP)
+            LOG_ERROR(
+                "Event queues require non-plastic first order "
+                "chemical synapses: " + conn->str());
+        return { Kernel<SYNAPSE_ARGS>(activate_iz_event_queue_SERIAL, nullptr) };
+    }
+
     // These are not supported because of the change of weight matrix pointer
     // Second order host connections require their weight matrices to be copied
     // Currently, this only copies the first matrix in the stack, and this
@@ -441,71 +836,117 @@ KernelList<SYNAPSE_ARGS> IzhikevichAttributes::get_activators(Connection *conn)
 #define C_TAU 0.0001
 #define C_A   0.000001
 
+/* Inhibitory STDP windows as a function of time since spike
+ * Both windows vanish outside of (0, 32), and time since spike saturates
+ *   at 32, so the host looks them up instead of evaluating powf and expf
+ *   for every synapse.  Device kernels evaluate them directly. */
+#define ISTDP_WINDOW_SIZE 33
+
+HOST DEVICE inline float istdp_positive_window(int time_since_spike) {
+    return (time_since_spike > 0 and time_since_spike < 32)
+        ? powf(time_since_spike, 10)
+          * 0.000001
+          * 2.29
+          * expf(-1.1 * time_since_spike)
+        : 0.0;
+}
+
+HOST DEVICE inline float istdp_negative_window(int time_since_spike) {
+    return (time_since_spike > 0 and time_since_spike < 32)
+        ? powf(time_since_spike, 10)
+          * 0.0000001
+          * 2.6
+          * expf(-0.94 * time_since_spike)
+        : 0.0;
+}
+
+class ISTDPWindows {
+    public:
+        ISTDPWindows() {
+            for (int i = 0 ; i < ISTDP_WINDOW_SIZE ; ++i) {
+                positive[i] = istdp_positive_window(i);
+                negative[i] = istdp_negative_window(i);
+            }
+        }
+        float positive[ISTDP_WINDOW_SIZE];
+        float negative[ISTDP_WINDOW_SIZE];
+};
+
+static const ISTDPWindows istdp_windows;
+
+/* Kernels copy the windows locally so that the compiler knows that they
+ *   cannot alias the synaptic variables, which is needed to vectorize */
+#ifdef __CUDA_ARCH__
+#define ISTDP_EXTRACTIONS
+#define ISTDP_POSITIVE(t) istdp_positive_window(t)
+#define ISTDP_NEGATIVE(t) istdp_negative_window(t)
+#else
+#define ISTDP_EXTRACTIONS \
+    ISTDPWindows windows = istdp_windows;
+#define ISTDP_POSITIVE(t) windows.positive[t]
+#define ISTDP_NEGATIVE(t) windows.negative[t]
+#endif
+
+#define GET_DEST_WINDOW \
+    float dest_window = ISTDP_NEGATIVE(dest_time_since_spike);
+
 #define STDP_ADD \
     /* Update presynaptic trace */ \
-    float src_trace = \
-        (presyn_traces[weight_index] = \
-            (src_spike) \
-                ? STDP_A_POS \
-                : presyn_traces[weight_index] * STDP_TAU_POS); \
+    float presyn_trace = presyn_traces[weight_index]; \
+    float src_trace = (src_spike) \
+        ? STDP_A_POS \
+        : presyn_trace * STDP_TAU_POS; \
+    presyn_traces[weight_index] = (active) ? src_trace : presyn_trace; \
 \
     float dest_trace = dest_exc_trace;
 
 #define STDP_SUB \
-    /* Update presynaptic trace */ \
-    float src_trace =  \
-        ((dest_spike > 0.0 and src_time_since_spike > 0 and src_time_since_spike < 32) \
-            /* positive iSTDP function of delta T */ \
-            ? powf(src_time_since_spike, 10) \
-              * 0.000001 \
-              * 2.29 \
-              * expf(-1.1 * src_time_since_spike) \
-            : 0.0); \
+    /* positive iSTDP function of delta T */ \
+    float src_window = ISTDP_POSITIVE(src_time_since_spike); \
+    float src_trace = (dest_spike > 0.0) ? src_window : 0.0f; \
 \
-    float dest_trace = \
-        ((src_spike and dest_time_since_spike > 0 and dest_time_since_spike < 32) \
-            /* negative iSTDP function of delta T */ \
-            ? powf(dest_time_since_spike, 10) \
-              * 0.0000001 \
-              * 2.6 \
-              * expf(-0.94 * dest_time_since_spike) \
-            : 0.0);
+    /* negative iSTDP function of delta T */ \
+    float dest_trace = (src_spike) ? dest_window : 0.0f;
 
+/* Synapses below the minimum weight are masked rather than skipped,
+ *   so that the loop over weights has no branches and vectorizes.
+ * Every variable is written back, unchanged if the synapse is masked. */
 #define UPDATE_WEIGHT(STDP, U, D, F) \
     float weight = weights[weight_index]; \
+    bool active = weight >= MIN_WEIGHT; \
 \
-    if (weight >= MIN_WEIGHT) { \
-        /* Extract postsynaptic trace */ \
-        int src_time_since_spike = from_time_since_spike[from_index]; \
-        bool src_spike = src_time_since_spike == 0; \
-\
-        /* Depends on ADD/SUB */ \
-        STDP; \
+    /* Extract presynaptic activity */ \
+    int src_time_since_spike = from_time_since_spike[from_index]; \
+    bool src_spike = src_time_since_spike == 0; \
 \
-        /* Compute delta from short term dynamics */ \
-        float weight_delta = weight_derivatives[weight_index]; \
-        weight_delta = \
-            weight_derivatives[weight_index] -= \
-                (weight_delta - C_A) * C_TAU + \
-                    (dest_spike * src_trace) \
-                    - (src_spike * dest_trace); \
+    /* Depends on ADD/SUB */ \
+    STDP; \
 \
-        /* Calculate new weight */ \
-        /* Reward (dopamine) should factor in here */ \
-        weight += learning_rate * weight_delta; \
+    /* Compute delta from short term dynamics */ \
+    float weight_delta = weight_derivatives[weight_index]; \
+    float new_delta = weight_delta - \
+        ((weight_delta - C_A) * C_TAU + \
+            (dest_spike * src_trace) \
+            - (src_spike * dest_trace)); \
+    weight_derivatives[weight_index] = (active) ? new_delta : weight_delta; \
 \
-        /* Ensure weight stays within boundaries */ \
-        weights[weight_index] = MAX(MIN_WEIGHT, MIN(max_weight, weight)); \
+    /* Calculate new weight */ \
+    /* Reward (dopamine) should factor in here */ \
+    /* Ensure weight stays within boundaries */ \
+    /* (fmin/fmax do not vectorize, comparisons do) */ \
+    float new_weight = weight + learning_rate * new_delta; \
+    new_weight = (new_weight < max_weight) ? new_weight : max_weight; \
+    new_weight = (new_weight > MIN_WEIGHT) ? new_weight : MIN_WEIGHT; \
+    weights[weight_index] = (active) ? new_weight : weight; \
 \
-        /* Update short term plasticity if applicable */ \
-        if (stp_flag) { \
-            float r = stp_rs[weight_index]; \
-            float w = stp_ws[weight_index]; \
-\
-            stp_rs[weight_index] += ((1 - r) / D) - (r * w * src_spike); \
-            stp_ws[weight_index] += ((U - w) / F) + (U * (1 - w) * src_spike); \
-        } \
-    }
+    /* Update short term plasticity if applicable */ \
+    bool stp_active = active and stp_flag; \
+    float r = stp_rs[weight_index]; \
+    float w = stp_ws[weight_index]; \
+    float new_r = r + (((1 - r) / D) - (r * w * src_spike)); \
+    float new_w = w + (((U - w) / F) + (U * (1 - w) * src_spike)); \
+    stp_rs[weight_index] = (stp_active) ? new_r : r; \
+    stp_ws[weight_index] = (stp_active) ? new_w : w;
 
 CALC_ALL(update_iz_add,
     UPDATE_EXTRACTIONS,
@@ -514,8 +955,10 @@ CALC_ALL(update_iz_add,
 ; );
 
 CALC_ALL(update_iz_sub,
-    UPDATE_EXTRACTIONS,
-    GET_DEST_ACTIVITY,
+    UPDATE_EXTRACTIONS
+    ISTDP_EXTRACTIONS,
+    GET_DEST_ACTIVITY
+    GET_DEST_WINDOW,
     UPDATE_WEIGHT(STDP_SUB, U_SUB, D_SUB, F_SUB),
 ; );
 
@@ -551,6 +994,8 @@ static void check_parameters(Layer *layer) {
 
     valid_params.insert("params");
     valid_params.insert("neuron spacing");
+    valid_params.insert("integrator");
+    valid_params.insert("integration steps");
 
     for (auto pair : layer->get_config()->get())
         if (valid_params.count(pair.first) == 0)
@@ -574,6 +1019,7 @@ static void check_parameters(Connection *conn) {
     valid_params.insert("myelinated");
     valid_params.insert("random delay");
     valid_params.insert("cap delay");
+    valid_params.insert("event queue");
     valid_params.insert("x offset");
     valid_params.insert("y offset");
     valid_params.insert("short term plasticity");
@@ -610,6 +1056,9 @@ IzhikevichAttributes::IzhikevichAttributes(Layer *layer)
     this->time_since_spike = Attributes::create_neuron_variable<int>();
     Attributes::register_neuron_variable("time since spike", &time_since_spike);
 
+    // Check layer parameters
+    check_parameters(layer);
+
     // Neuron parameters
     this->as = Attributes::create_neuron_variable<float>();
     Attributes::register_neuron_variable("a", &as);
@@ -620,22 +1069,48 @@ IzhikevichAttributes::IzhikevichAttributes(Layer *layer)
     this->ds = Attributes::create_neuron_variable<float>();
     Attributes::register_neuron_variable("d", &ds);
 
-    // Check layer parameters
-    check_parameters(layer);
-
     create_parameters(layer->get_parameter("params", "regular"),
         this->as, this->bs, this->cs, this->ds, layer->size);
+
+    // Packed neuron parameters
+    this->neuron_types = Attributes::create_neuron_variable<int>(0);
+    Attributes::register_neuron_variable("neuron type", &neuron_types);
+    this->neuron_params = Pointer<float>(IZ_PARAM_TILE_SIZE, 0.0);
+    Attributes::register_neuron_variable("neuron params", &neuron_params);
+    process_neuron_variables();
+
+    // Voltage integrator
+    // Integration steps only apply to the exponential integrator
+    std::string integrator = layer->get_parameter("integrator", "euler");
+    if (integrator == "euler")
+        this->exponential_integrator = false;
+    else if (integrator == "exponential")
+        this->exponential_integrator = true;
+    else
+        LOG_ERROR(
+            "Unrecognized integrator: " + integrator);
+
+    this->integration_steps = std::stoi(layer->get_parameter(
+        "integration steps", std::to_string(IZ_EXP_MAX_STEPS)));
+    if (this->integration_steps < 1
+            or this->integration_steps > IZ_EXP_MAX_STEPS)
+        LOG_ERROR(
+            "Error in " + layer->str() + "\n"
+            "  Integration steps must be between 1 and "
+            + std::to_string(IZ_EXP_MAX_STEPS) + "!");
+
     for (int j = 0 ; j < layer->size ; ++j) {
         postsyn_exc_trace[j] = 0.0;
         time_since_spike[j] = 32;
 
         // Run simulation to stable point
-        float v = this->cs[j];
-        float r = this->bs[j] * this->cs[j];
-        float delta_v;
-        float delta_r;
         float a = this->as[j];
         float b = this->bs[j];
+        float c = this->cs[j];
+        float v = c;
+        float r = b * c;
+        float delta_v;
+        float delta_r;
         do {
             delta_v = (0.04 * v * v) + (5*v) + 140 - r;
             v += delta_v;
@@ -661,6 +1136,41 @@ IzhikevichAttributes::IzhikevichAttributes(Layer *layer)
     }
 }
 
+/* Packs the per-neuron parameters into the neuron type table
+ * Neurons with identical parameters share a type, numbered in order of first
+ *   appearance, so layers without repeats get the identity mapping. */
+void IzhikevichAttributes::process_neuron_variables() {
+    std::map<std::tuple<float, float, float, float>, int> types;
+    for (int i = 0 ; i < layer->size ; ++i) {
+        auto key = std::make_tuple(as[i], bs[i], cs[i], ds[i]);
+        auto it = types.find(key);
+        if (it == types.end())
+            it = types.insert(std::make_pair(key, (int)types.size())).first;
+        neuron_types[i] = it->second;
+    }
+
+    int num_types = types.size();
+    if (num_types <= 1)
+        this->param_layout = IZ_PARAMS_SHARED;
+    else if (num_types == layer->size)
+        this->param_layout = IZ_PARAMS_NEURON;
+    else
+        this->param_layout = IZ_PARAMS_TYPED;
+
+    int num_tiles =
+        std::max(1, (num_types + IZ_PARAM_TILE - 1) / IZ_PARAM_TILE);
+    if (neuron_params.get_size() != num_tiles * IZ_PARAM_TILE_SIZE)
+        neuron_params.resize(num_tiles * IZ_PARAM_TILE_SIZE);
+
+    for (auto pair : types) {
+        int type = pair.second;
+        neuron_params[IZ_PARAM_INDEX(type, 0)] = std::get<0>(pair.first);
+        neuron_params[IZ_PARAM_INDEX(type, 1)] = std::get<1>(pair.first);
+        neuron_params[IZ_PARAM_INDEX(type, 2)] = std::get<2>(pair.first);
+        neuron_params[IZ_PARAM_INDEX(type, 3)] = std::get<3>(pair.first);
+    }
+}
+
 void IzhikevichWeightMatrix::register_variables() {
     // Short term (AMPA/GABAA) conductance trace
     this->short_traces = WeightMatrix::create_variable<float>();
@@ -729,17 +1239,35 @@ void IzhikevichAttributes::process_weight_matrix(WeightMatrix* matrix) {
 
     fSet(iz_mat->weight_derivatives, num_weights, C_A);
 
+    // Event queue delivery
+    iz_mat->event_queue_flag =
+        conn->get_parameter("event queue", "false") == "true";
+    iz_mat->queue_length = 0;
+    iz_mat->queue_time = 0;
+
     // Delays
     // Myelinated connections use the base delay only
+    // Event queues are not limited by the output history, and measure
+    //   random delays from the base delay
     if (conn->get_parameter("myelinated", "false") == "true") {
         iz_mat->get_delays(conn->delay);
     } else if (conn->get_config()->has("random delay")) {
         int max_delay = std::stoi(
             conn->get_parameter("random delay", "0"));
-        if (max_delay > 31)
-            LOG_ERROR(
-                "Randomized axons cannot have delays greater than 31!");
-        iRand(iz_mat->delays, num_weights, 0, max_delay);
+        if (iz_mat->event_queue_flag) {
+            if (conn->delay + max_delay > EVENT_QUEUE_MAX_DELAY)
+                LOG_ERROR(
+                    "Event queue delays cannot be greater than "
+                    + std::to_string(EVENT_QUEUE_MAX_DELAY) + "!");
+            iz_mat->get_delays(conn->delay);
+            iRand(iz_mat->delays, num_weights,
+                conn->delay, conn->delay + max_delay);
+        } else {
+            if (max_delay > 31)
+                LOG_ERROR(
+                    "Randomized axons cannot have delays greater than 31!");
+            iRand(iz_mat->delays, num_weights, 0, max_delay);
+        }
     } else {
         iz_mat->get_delays(BIT,
             std::stof(conn->from_layer->get_parameter("neuron spacing", "0.1")),
@@ -747,7 +1275,8 @@ void IzhikevichAttributes::process_weight_matrix(WeightMatrix* matrix) {
             std::stof(conn->get_parameter("x offset", "0.0")),
             std::stof(conn->get_parameter("y offset", "0.0")),
             0.15,
-            conn->get_parameter("cap delay", "false") == "true");
+            conn->get_parameter("cap delay", "false") == "true",
+            (iz_mat->event_queue_flag) ? EVENT_QUEUE_MAX_DELAY : 31);
     }
 
     // Time since last spike
@@ -755,3 +1284,49 @@ void IzhikevichAttributes::process_weight_matrix(WeightMatrix* matrix) {
     for (int i = 0 ; i < num_weights; ++i)
         time_since_spike[i] = 32;
 }
+
+void IzhikevichWeightMatrix::estimate_processing(
+        std::map<std::string, size_t>& arrays) {
+    estimate_delays(arrays);
+
+    // Event queues are built on first activation (see build_event_queue())
+    // The queue spans the delays beyond the base delay, which is known for
+    //   random delays, and assumed to fit in one output word otherwise
+    if (connection->get_parameter("event queue", "false") == "true") {
+        size_t num_weights = connection->get_num_weights();
+        size_t from_size = connection->from_layer->size;
+        size_t to_size = connection->to_layer->size;
+
+        size_t queue_length = 1;
+        if (connection->get_parameter("myelinated", "false") != "true")
+            queue_length = 1 + ((connection->get_config()->has("random delay"))
+                ? std::stoi(connection->get_parameter("random delay", "0"))
+                : 31);
+
+        arrays["event queue"] = queue_length * to_size * sizeof(float);
+        arrays["event short traces"] = to_size * sizeof(float);
+        arrays["event long traces"] = to_size * sizeof(float);
+        arrays["event offsets"] = (from_size + 1) * sizeof(int);
+        arrays["event weights"] = num_weights * sizeof(int);
+        arrays["event targets"] = num_weights * sizeof(int);
+    }
+}
+
+void IzhikevichWeightMatrix::get_extra_memory(
+        std::map<std::string, BasePointer*>& pointers) {
+    pointers["event queue"] = &event_queue;
+    pointers["event short traces"] = &event_short_traces;
+    pointers["event long traces"] = &event_long_traces;
+    pointers["event offsets"] = &event_offsets;
+    pointers["event weights"] = &event_weights;
+    pointers["event targets"] = &event_targets;
+}
+
+IzhikevichWeightMatrix::~IzhikevichWeightMatrix() {
+    event_queue.free();
+    event_short_traces.free();
+    event_long_traces.free();
+    event_offsets.free();
+    event_weights.free();
+    event_targets.free();
+}
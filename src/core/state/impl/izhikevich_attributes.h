@@ -3,6 +3,24 @@
 
 #include "state/attributes.h"
 
+/* Packed neuron parameters
+ * Parameters are packed per neuron type into tiles of IZ_PARAM_TILE types,
+ *   storing the a, b, c, and d rows of a tile contiguously so that each row
+ *   fills one cache line.  Layers with a few neuron classes only touch a
+ *   tile or two, and layers with per-neuron parameters stream a tile per
+ *   IZ_PARAM_TILE neurons. */
+#define IZ_PARAM_TILE 16
+#define IZ_PARAM_TILE_SIZE (4 * IZ_PARAM_TILE)
+#define IZ_PARAM_INDEX(type, param) \
+    (((type) / IZ_PARAM_TILE) * IZ_PARAM_TILE_SIZE \
+        + ((param) * IZ_PARAM_TILE) + ((type) % IZ_PARAM_TILE))
+
+enum IzhikevichParamLayout {
+    IZ_PARAMS_SHARED,
+    IZ_PARAMS_TYPED,
+    IZ_PARAMS_NEURON
+};
+
 class IzhikevichAttributes : public Attributes {
     public:
         IzhikevichAttributes(Layer *layer);
@@ -10,6 +28,7 @@ class IzhikevichAttributes : public Attributes {
         virtual KernelList<SYNAPSE_ARGS> get_activators(Connection *conn);
         virtual KernelList<SYNAPSE_ARGS> get_updaters(Connection *conn);
         virtual void process_weight_matrix(WeightMatrix* matrix);
+        virtual void process_neuron_variables();
 
         /* Neuron Attributes */
         // Conductances for different ion channels
@@ -38,12 +57,24 @@ class IzhikevichAttributes : public Attributes {
         Pointer<float> cs;
         Pointer<float> ds;
 
+        // Packed neuron parameters, rebuilt from the above
+        //   by process_neuron_variables()
+        IzhikevichParamLayout param_layout;
+        Pointer<int> neuron_types;
+        Pointer<float> neuron_params;
+
+        // Integrator selection ("integrator" layer parameter)
+        bool exponential_integrator;
+        int integration_steps;
+
     GET_KERNEL_DEF
     ATTRIBUTE_MEMBERS
 };
 
 class IzhikevichWeightMatrix : public WeightMatrix {
     public:
+        virtual ~IzhikevichWeightMatrix();
+
         Pointer<float> short_traces;
         Pointer<float> long_traces;
         Pointer<float> presyn_traces;
@@ -61,8 +92,33 @@ class IzhikevichWeightMatrix : public WeightMatrix {
         // Short term plasticity flag
         bool stp_flag;
 
+        /* Event queue delivery ("event queue" connection parameter)
+         * Spikes are deposited into a circular buffer of per-neuron
+         *   arrivals when they are emitted, instead of every synapse polling
+         *   the output history every timestep.  Conductance traces are
+         *   kept per destination neuron rather than per synapse. */
+        bool event_queue_flag;
+        int queue_length;
+        int queue_time;
+
+        // Arrivals (queue_length x to_size)
+        Pointer<float> event_queue;
+        Pointer<float> event_short_traces;
+        Pointer<float> event_long_traces;
+
+        // Outgoing synapses of each source neuron (compressed rows)
+        Pointer<int> event_offsets;
+        Pointer<int> event_weights;
+        Pointer<int> event_targets;
+
+        // Builds the outgoing synapse lists and allocates the queue
+        void build_event_queue();
+
     WEIGHT_MATRIX_MEMBERS(IzhikevichWeightMatrix);
     virtual void register_variables();
+    virtual void estimate_processing(std::map<std::string, size_t>& arrays);
+    virtual void get_extra_memory(
+        std::map<std::string, BasePointer*>& pointers);
 };
 
 #endif
@@ -0,0 +1,18 @@
+#ifndef izhikevich_integrator_h
+#define izhikevich_integrator_h
+
+/* Exponential integrator for Izhikevich-style neuron models
+ * Each sub-step linearizes the voltage equation around the current voltage
+ *   and advances the linear system exactly:
+ *     v += h * (e^(J*h) - 1) / (J*h) * dv/dt
+ *   where J is the slope of dv/dt.  This stays stable for stiff conductances
+ *   with far fewer sub-steps than Euler, and the recovery variable, which is
+ *   linear, is advanced exactly.
+ * Neurons that reach threshold are clamped and held for the remaining
+ *   sub-steps instead of exiting early, and the sub-step count is a compile
+ *   time constant, so the neuron loop is branch-free and vectorizes.
+ *   Kernels are instantiated for 1 to IZ_EXP_MAX_STEPS sub-steps, which is
+ *   also the default for the "integration steps" layer parameter. */
+#define IZ_EXP_MAX_STEPS 4
+
+#endif
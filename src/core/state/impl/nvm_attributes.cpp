@@ -3,6 +3,7 @@
 
 #include "state/impl/nvm_attributes.h"
 #include "state/weight_matrix.h"
+#include "util/fast_math.h"
 #include "engine/kernel/synapse_kernel.h"
 
 #define GATE_THRESHOLD 0.5f
@@ -61,7 +62,7 @@ BUILD_RAND_ATTRIBUTE_KERNEL(NVMAttributes, nvm_kernel,
             : 0.));
 
     context[nid] = 1.;
-    SHIFT_FLOAT_OUTPUTS(f_outputs, tanh(input));
+    SHIFT_FLOAT_OUTPUTS(f_outputs, fast_tanh(input));
 )
 
 /******************************************************************************/
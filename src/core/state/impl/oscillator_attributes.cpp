@@ -4,6 +4,7 @@
 #include "state/impl/oscillator_attributes.h"
 #include "state/weight_matrix.h"
 #include "engine/kernel/synapse_kernel.h"
+#include "util/fast_math.h"
 
 REGISTER_ATTRIBUTES(OscillatorAttributes, "oscillator", FLOAT)
 REGISTER_WEIGHT_MATRIX(OscillatorWeightMatrix, "oscillator")
@@ -44,7 +45,7 @@ bool OscillatorAttributes::check_compatibility(ClusterType cluster_type) {
 /******************************** KERNEL **************************************/
 /******************************************************************************/
 
-BUILD_ATTRIBUTE_KERNEL(OscillatorAttributes, oscillator_kernel,
+BUILD_VEC_ATTRIBUTE_KERNEL(OscillatorAttributes, oscillator_kernel,
     float tonic = att->tonic;
     float tau = att->tau;
     float decay = att->decay;
@@ -62,7 +63,8 @@ BUILD_ATTRIBUTE_KERNEL(OscillatorAttributes, oscillator_kernel,
     state[nid] = st = (tau * inputs[nid]) + recur;
     bold[nid] += recur;
 
-    SHIFT_FLOAT_OUTPUTS(f_outputs, MAX(0.0f, tanh(st)));
+    float out = fast_tanh(st);
+    SET_FLOAT_OUTPUT(f_outputs, (out > 0.0f) ? out : 0.0f);
     // SHIFT_FLOAT_OUTPUTS(f_outputs, MAX(0.0f, st));
     // SHIFT_FLOAT_OUTPUTS(f_outputs,
     //     (1.0f / (1.0f + exp(-3.0f * st - 3.0f)) * MAX(0.0f, tanh(st))));
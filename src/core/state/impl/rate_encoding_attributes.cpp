@@ -2,6 +2,7 @@
 
 #include "state/impl/rate_encoding_attributes.h"
 #include "util/logger.h"
+#include "util/fast_math.h"
 
 #include <math.h>
 
@@ -11,13 +12,13 @@ REGISTER_ATTRIBUTES(RateEncodingAttributes, "rate_encoding", FLOAT)
 /******************************** KERNEL **************************************/
 /******************************************************************************/
 
-BUILD_ATTRIBUTE_KERNEL(RateEncodingAttributes, re_attribute_kernel,
+BUILD_VEC_ATTRIBUTE_KERNEL(RateEncodingAttributes, re_attribute_kernel,
     float *f_outputs = (float*)outputs;
 
     ,
 
     float input = inputs[nid];
-    SHIFT_FLOAT_OUTPUTS(f_outputs, (input > 0.0) ? tanh(input) : 0.0);
+    SET_FLOAT_OUTPUT(f_outputs, (input > 0.0f) ? fast_tanh(input) : 0.0f);
     // SHIFT_FLOAT_OUTPUTS(f_outputs, (input > 0.0) ? input : 0.0);
     // SHIFT_FLOAT_OUTPUTS(f_outputs, tanh(input));
 )
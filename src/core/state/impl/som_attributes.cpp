@@ -4,6 +4,7 @@
 #include "state/impl/som_attributes.h"
 #include "state/weight_matrix.h"
 #include "engine/kernel/synapse_kernel.h"
+#include "util/fast_math.h"
 
 #define DUMMY_VAL 1.0
 
@@ -14,25 +15,49 @@ REGISTER_WEIGHT_MATRIX(SOMWeightMatrix, "som")
 /******************************** KERNEL **************************************/
 /******************************************************************************/
 
-BUILD_ATTRIBUTE_KERNEL(SOMAttributes, som_attribute_kernel,
-    SOMAttributes *som_att = (SOMAttributes*)att;
-    float *f_outputs = (float*)outputs;
-    float rbf_scale = som_att->rbf_scale;
-
+/* Best matching unit: index of the smallest input, lowest index on ties
+ * Each thread scans a chunk, and partial results are merged with the same
+ *   tie-breaking so that the winner matches a serial scan. */
+HOST DEVICE static int find_winner(const float* inputs, int size) {
     float min = inputs[0];
     int min_node = 0;
-    for (int i = 0 ; i < size ; ++i) {
-        if (inputs[i] < min) {
-            min = inputs[i];
-            min_node = i;
+
+    #pragma omp parallel
+    {
+        float local_min = inputs[0];
+        int local_node = 0;
+
+        #pragma omp for nowait
+        for (int i = 0 ; i < size ; ++i) {
+            if (inputs[i] < local_min) {
+                local_min = inputs[i];
+                local_node = i;
+            }
+        }
+
+        #pragma omp critical
+        {
+            if (local_min < min
+                    or (local_min == min and local_node < min_node)) {
+                min = local_min;
+                min_node = local_node;
+            }
         }
     }
-    som_att->winner = min_node;
+    return min_node;
+}
+
+BUILD_VEC_ATTRIBUTE_KERNEL(SOMAttributes, som_attribute_kernel,
+    SOMAttributes *som_att = (SOMAttributes*)att;
+    float *f_outputs = (float*)outputs;
+    float rbf_scale = som_att->rbf_scale;
+
+    som_att->winner = find_winner(inputs, size);
 
     ,
 
     float input = inputs[nid];
-    SHIFT_FLOAT_OUTPUTS(f_outputs, std::exp(-rbf_scale * (input * input)));
+    SET_FLOAT_OUTPUT(f_outputs, fast_exp(-rbf_scale * (input * input)));
 )
 
 /******************************************************************************/
@@ -66,31 +91,102 @@ CALC_ALL(modulate_som,
     plasticity[to_index] = sum;
 );
 
+/* Weight updates only apply within |neighborhood_size| (manhattan distance)
+ *   of the winner.  The neuron prefix opens a block that the postfix closes,
+ *   so neurons outside of the neighborhood skip their weights entirely. */
+#define UPDATE_SOM_EXTRACTIONS \
+    SOMAttributes *som_att = (SOMAttributes*)synapse_data.attributes; \
+    SOMWeightMatrix *som_mat = (SOMWeightMatrix*)synapse_data.matrix; \
+    float* output_cache = som_mat->output_cache.get(); \
+    float* plasticity = som_att->plasticity.get(); \
+    float learning_rate = som_mat->learning_rate; \
+    float neighbor_learning_rate = som_mat->neighbor_learning_rate; \
+    int neighborhood_size = som_mat->neighborhood_size; \
+    int winner = som_att->winner; \
+\
+    int winner_row = winner / to_columns; \
+    int winner_col = winner % to_columns; \
+\
+    /* Bounding box of the neighborhood, clipped to the layer */ \
+    int window_row_start = winner_row - neighborhood_size; \
+    int window_row_end = winner_row + neighborhood_size + 1; \
+    int window_col_start = winner_col - neighborhood_size; \
+    int window_col_end = winner_col + neighborhood_size + 1; \
+    window_row_start = (window_row_start < 0) ? 0 : window_row_start; \
+    window_col_start = (window_col_start < 0) ? 0 : window_col_start; \
+    window_row_end = (window_row_end > to_rows) ? to_rows : window_row_end; \
+    window_col_end = \
+        (window_col_end > to_columns) ? to_columns : window_col_end;
+
+#define UPDATE_SOM_PRE \
+    int row_dist = abs(winner_row - (to_index / to_columns)); \
+    int col_dist = abs(winner_col - (to_index % to_columns)); \
+    float rate = (to_index == winner) \
+        ? learning_rate : neighbor_learning_rate; \
+    if (row_dist + col_dist <= neighborhood_size) {
+
+#define UPDATE_SOM_OP \
+    weights[weight_index] += plasticity[to_index] * rate * \
+        (output_cache[weight_index] - weights[weight_index]);
+
+#define UPDATE_SOM_POST }
+
 CALC_ALL(update_som,
-    SOMAttributes *som_att = (SOMAttributes*)synapse_data.attributes;
-    SOMWeightMatrix *som_mat = (SOMWeightMatrix*)synapse_data.matrix;
-    float* output_cache = som_mat->output_cache.get();
-    float* plasticity = som_att->plasticity.get();
-    float learning_rate = som_mat->learning_rate;
-    float neighbor_learning_rate = som_mat->neighbor_learning_rate;
-    int neighborhood_size = som_mat->neighborhood_size;
-    int winner = som_att->winner;
-
-    int winner_row = winner / to_columns;
-    int winner_col = winner % to_columns;,
-
-    int row_dist = abs(winner_row - (to_index / to_columns));
-    int col_dist = abs(winner_col - (to_index % to_columns));,
-
-    if (to_index == winner) {
-        weights[weight_index] += plasticity[to_index] * learning_rate *
-            (output_cache[weight_index] - weights[weight_index]);
-    } else if (row_dist + col_dist <= neighborhood_size) {
-        weights[weight_index] += plasticity[to_index] * neighbor_learning_rate *
-            (output_cache[weight_index] - weights[weight_index]);
-    },
+    UPDATE_SOM_EXTRACTIONS,
+    UPDATE_SOM_PRE,
+    UPDATE_SOM_OP,
+    UPDATE_SOM_POST
 );
 
+/* Fully connected and sparse matrices are indexed directly by destination,
+ *   so their loops can be restricted to the neighborhood's bounding box.
+ * This also spreads the neighborhood across threads, rather than leaving it
+ *   to whichever thread owns the winner's rows of the full layer. */
+#define SOM_WINDOW_SERIAL_LOOP_OPEN \
+_Pragma("omp parallel for collapse(2)") \
+for (int to_row = window_row_start ; to_row < window_row_end ; ++to_row) { \
+    for (int to_column = window_col_start ; to_column < window_col_end ; ++to_column) { \
+        int to_index = to_row * to_columns + to_column;
+
+#define SOM_WINDOW_PARALLEL_LOOP_OPEN \
+int window_columns = window_col_end - window_col_start; \
+int window_index = blockIdx.x * blockDim.x + threadIdx.x; \
+int to_row = window_row_start + window_index / window_columns; \
+int to_column = window_col_start + window_index % window_columns; \
+int to_index = to_row * to_columns + to_column; \
+if (to_row < window_row_end) {
+
+#define SOM_WINDOW_FC_PREAMBLE FC_PREAMBLE
+#define SOM_WINDOW_FC_SERIAL_LOOP_OPEN SOM_WINDOW_SERIAL_LOOP_OPEN
+#define SOM_WINDOW_FC_PARALLEL_LOOP_OPEN SOM_WINDOW_PARALLEL_LOOP_OPEN
+
+#define SOM_WINDOW_SPARSE_PREAMBLE SPARSE_PREAMBLE
+#define SOM_WINDOW_SPARSE_SERIAL_LOOP_OPEN SOM_WINDOW_SERIAL_LOOP_OPEN
+#define SOM_WINDOW_SPARSE_PARALLEL_LOOP_OPEN SOM_WINDOW_PARALLEL_LOOP_OPEN
+
+DEF_KERNELS(SOM_WINDOW_FC, update_som_window_fully_connected,
+    UPDATE_SOM_EXTRACTIONS,
+    UPDATE_SOM_PRE;
+        FC_WEIGHT_LOOP(to_index * from_size, UPDATE_SOM_OP, ++weight_index)
+    UPDATE_SOM_POST;
+    ,
+    UPDATE_SOM_PRE;
+        FC_WEIGHT_LOOP(to_index, UPDATE_SOM_OP, weight_index += to_size);
+    UPDATE_SOM_POST;
+)
+
+DEF_KERNELS(SOM_WINDOW_SPARSE, update_som_window_sparse,
+    UPDATE_SOM_EXTRACTIONS,
+    UPDATE_SOM_PRE;
+        SPARSE_WEIGHT_LOOP(
+            to_index * num_weights_per_neuron, UPDATE_SOM_OP, ++weight_index);
+    UPDATE_SOM_POST;
+    ,
+    UPDATE_SOM_PRE;
+        SPARSE_WEIGHT_LOOP(to_index, UPDATE_SOM_OP, weight_index += to_size);
+    UPDATE_SOM_POST;
+)
+
 KernelList<SYNAPSE_ARGS> SOMAttributes::get_activators(Connection *conn) {
     try {
         if (not conn->second_order) {
@@ -110,9 +206,20 @@ KernelList<SYNAPSE_ARGS> SOMAttributes::get_activators(Connection *conn) {
 /******************************************************************************/
 
 KernelList<SYNAPSE_ARGS> SOMAttributes::get_updaters(Connection *conn) {
-    if (not conn->second_order)
-        return { update_som_map.at(conn->get_type()) };
-    else
+    if (not conn->second_order) {
+        switch (conn->get_type()) {
+            case FULLY_CONNECTED:
+                return { Kernel<SYNAPSE_ARGS>(
+                    update_som_window_fully_connected_SERIAL,
+                    update_som_window_fully_connected_PARALLEL) };
+            case SPARSE:
+                return { Kernel<SYNAPSE_ARGS>(
+                    update_som_window_sparse_SERIAL,
+                    update_som_window_sparse_PARALLEL) };
+            default:
+                return { update_som_map.at(conn->get_type()) };
+        }
+    } else
         LOG_ERROR(
             "Unimplemented connection type!");
 }
@@ -2,8 +2,10 @@
 #include <math.h>
 
 #include "state/impl/spnet_attributes.h"
+#include "state/impl/izhikevich_integrator.h"
 #include "engine/kernel/synapse_kernel.h"
 #include "util/tools.h"
+#include "util/fast_math.h"
 
 REGISTER_ATTRIBUTES(SpnetAttributes, "spnet", BIT)
 REGISTER_WEIGHT_MATRIX(SpnetWeightMatrix, "spnet")
@@ -99,7 +101,7 @@ static void create_parameters(std::string str,
 #define STDP_A_POS 0.1
 #define STDP_A_NEG 0.1
 
-BUILD_ATTRIBUTE_KERNEL(SpnetAttributes, spnet_attribute_kernel,
+BUILD_ATTRIBUTE_KERNEL_VARIANT(SpnetAttributes, spnet_attribute_kernel,
     float *voltages = att->voltage.get();
     float *recoveries = att->recovery.get();
     float *postsyn_exc_traces = att->postsyn_exc_trace.get();
@@ -166,6 +168,95 @@ BUILD_ATTRIBUTE_KERNEL(SpnetAttributes, spnet_attribute_kernel,
     recoveries[nid] = recovery + (spike * ds[nid]);
 )
 
+/* Exponential integrator (see izhikevich_integrator.h) */
+#define SPNET_EXP_ATTRIBUTE_KERNEL(STEPS) \
+BUILD_VEC_ATTRIBUTE_KERNEL_VARIANT(SpnetAttributes, \
+        spnet_exp_attribute_kernel_##STEPS, \
+    float *voltages = att->voltage.get(); \
+    float *recoveries = att->recovery.get(); \
+    float *postsyn_exc_traces = att->postsyn_exc_trace.get(); \
+    int *time_since_spikes = att->time_since_spike.get(); \
+    unsigned int *spikes = (unsigned int*)outputs; \
+    float *as = att->as.get(); \
+    float *bs = att->bs.get(); \
+    float *cs = att->cs.get(); \
+    float *ds = att->ds.get(); \
+ \
+    const float h = 1.0f / STEPS; \
+ \
+    , \
+ \
+    /********************** \
+     *** VOLTAGE UPDATE *** \
+     **********************/ \
+    float voltage = voltages[nid]; \
+    float recovery = recoveries[nid]; \
+    float current = inputs[nid]; \
+ \
+    float b = bs[nid]; \
+    float c = cs[nid]; \
+    float d = ds[nid]; \
+    float recovery_rate = 1.0f - fast_exp(-as[nid] * h); \
+ \
+    for (int i = 0 ; i < STEPS ; ++i) { \
+        float delta_v = (0.04f * voltage * voltage) + (5 * voltage) \
+            + 140 - recovery + current; \
+        float slope = (0.08f * voltage) + 5; \
+ \
+        float next_voltage = \
+            voltage + h * fast_exprel(slope * h) * delta_v; \
+ \
+        /* Clamp at threshold, which also catches NaN */ \
+        next_voltage = (next_voltage < IZ_SPIKE_THRESH) \
+            ? next_voltage : IZ_SPIKE_THRESH; \
+ \
+        /* Update recovery variable */ \
+        float next_recovery = \
+            recovery + recovery_rate * ((b * next_voltage) - recovery); \
+ \
+        /* Hold neurons that have already reached threshold */ \
+        bool active = voltage < IZ_SPIKE_THRESH; \
+        voltage = (active) ? next_voltage : voltage; \
+        recovery = (active) ? next_recovery : recovery; \
+    } \
+ \
+    /******************** \
+     *** SPIKE UPDATE *** \
+     ********************/ \
+    /* Determine if spike occurred */ \
+    unsigned int spike = voltage >= IZ_SPIKE_THRESH; \
+ \
+    SET_BIT_OUTPUT(spikes, spike); \
+ \
+    /* Update trace, voltage, recovery */ \
+    int time_since_spike = time_since_spikes[nid]; \
+    postsyn_exc_traces[nid] = (prev_bit) \
+        ? (postsyn_exc_traces[nid] + STDP_A_NEG) \
+        : (postsyn_exc_traces[nid] * STDP_TAU_NEG); \
+    time_since_spikes[nid] = (prev_bit) \
+        ? 0 \
+        : ((time_since_spike < 32) ? time_since_spike + 1 : 32); \
+    voltages[nid] = (spike) ? c : voltage; \
+    recoveries[nid] = recovery + ((spike) ? d : 0.0f); \
+)
+
+SPNET_EXP_ATTRIBUTE_KERNEL(1)
+SPNET_EXP_ATTRIBUTE_KERNEL(2)
+SPNET_EXP_ATTRIBUTE_KERNEL(3)
+SPNET_EXP_ATTRIBUTE_KERNEL(4)
+
+Kernel<ATTRIBUTE_ARGS> SpnetAttributes::get_kernel() {
+    if (not exponential_integrator)
+        return get_spnet_attribute_kernel();
+
+    switch (integration_steps) {
+        case 1:  return get_spnet_exp_attribute_kernel_1();
+        case 2:  return get_spnet_exp_attribute_kernel_2();
+        case 3:  return get_spnet_exp_attribute_kernel_3();
+        default: return get_spnet_exp_attribute_kernel_4();
+    }
+}
+
 /******************************************************************************/
 /************************* TRACE ACTIVATOR KERNELS ****************************/
 /******************************************************************************/
@@ -334,6 +425,8 @@ static void check_parameters(Layer *layer) {
 
     valid_params.insert("params");
     valid_params.insert("neuron spacing");
+    valid_params.insert("integrator");
+    valid_params.insert("integration steps");
 
     for (auto pair : layer->get_config()->get())
         if (valid_params.count(pair.first) == 0)
@@ -394,6 +487,27 @@ SpnetAttributes::SpnetAttributes(Layer *layer)
 
     create_parameters(layer->get_parameter("params", "regular"),
         this->as, this->bs, this->cs, this->ds, layer->size);
+
+    // Voltage integrator
+    // Integration steps only apply to the exponential integrator
+    std::string integrator = layer->get_parameter("integrator", "euler");
+    if (integrator == "euler")
+        this->exponential_integrator = false;
+    else if (integrator == "exponential")
+        this->exponential_integrator = true;
+    else
+        LOG_ERROR(
+            "Unrecognized integrator: " + integrator);
+
+    this->integration_steps = std::stoi(layer->get_parameter(
+        "integration steps", std::to_string(IZ_EXP_MAX_STEPS)));
+    if (this->integration_steps < 1
+            or this->integration_steps > IZ_EXP_MAX_STEPS)
+        LOG_ERROR(
+            "Error in " + layer->str() + "\n"
+            "  Integration steps must be between 1 and "
+            + std::to_string(IZ_EXP_MAX_STEPS) + "!");
+
     for (int j = 0 ; j < layer->size ; ++j) {
         postsyn_exc_trace[j] = 0.0;
         time_since_spike[j] = 32;
@@ -27,6 +27,10 @@ class SpnetAttributes : public Attributes {
         Pointer<float> cs;
         Pointer<float> ds;
 
+        // Integrator selection ("integrator" layer parameter)
+        bool exponential_integrator;
+        int integration_steps;
+
     GET_KERNEL_DEF
     ATTRIBUTE_MEMBERS
 };
@@ -47,6 +51,8 @@ class SpnetWeightMatrix : public WeightMatrix {
 
     WEIGHT_MATRIX_MEMBERS(SpnetWeightMatrix);
     virtual void register_variables();
+    virtual void estimate_processing(std::map<std::string, size_t>& arrays)
+        { estimate_delays(arrays); }
 };
 
 #endif
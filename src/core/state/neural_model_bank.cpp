@@ -34,7 +34,7 @@ bool NeuralModelBank::register_attributes(std::string neural_model,
 }
 
 bool NeuralModelBank::register_weight_matrix(std::string neural_model,
-        MAT_BUILD_PTR build_ptr) {
+        MAT_BUILD_PTR build_ptr, MAT_BUILD_PTR probe_ptr) {
     auto bank = get_instance();
 
     if (bank->mat_build_pointers.count(neural_model) == 1)
@@ -44,6 +44,7 @@ bool NeuralModelBank::register_weight_matrix(std::string neural_model,
 
     bank->neural_models.insert(neural_model);
     bank->mat_build_pointers[neural_model] = build_ptr;
+    bank->mat_probe_pointers[neural_model] = probe_ptr;
     return true;
 }
 
@@ -81,3 +82,13 @@ WeightMatrix* NeuralModelBank::build_weight_matrix(Connection *conn) {
         return WeightMatrix::build(conn);
     }
 }
+
+WeightMatrix* NeuralModelBank::probe_weight_matrix(Connection *conn) {
+    auto neural_model = conn->to_layer->neural_model;
+    try {
+        return get_instance()
+            ->mat_probe_pointers.at(neural_model)(conn);
+    } catch (std::out_of_range) {
+        return WeightMatrix::probe(conn);
+    }
+}
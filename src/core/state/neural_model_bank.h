@@ -27,8 +27,9 @@ class NeuralModelBank {
             OutputType output_type, ATT_BUILD_PTR build_ptr);
 
         // Registers a WeightMatrix subclass neural model name with the state
+        // The probe method constructs the subclass without initializing it
         static bool register_weight_matrix(std::string neural_model,
-            MAT_BUILD_PTR build_ptr);
+            MAT_BUILD_PTR build_ptr, MAT_BUILD_PTR probe_ptr);
 
         // Builds an instance of an Attributes subclass by name
         static Attributes *build_attributes(Layer *layer);
@@ -36,6 +37,10 @@ class NeuralModelBank {
         // Builds an instance of a WeightMatrix subclass by name
         static WeightMatrix *build_weight_matrix(Connection *conn);
 
+        // Constructs an uninitialized instance of a WeightMatrix subclass
+        //   by name, for measuring its variables without allocating them
+        static WeightMatrix *probe_weight_matrix(Connection *conn);
+
     protected:
         static NeuralModelBank *instance;
         NeuralModelBank() { }
@@ -44,6 +49,7 @@ class NeuralModelBank {
         std::set<std::string> neural_models;
         std::map<std::string, ATT_BUILD_PTR> att_build_pointers;
         std::map<std::string, MAT_BUILD_PTR> mat_build_pointers;
+        std::map<std::string, MAT_BUILD_PTR> mat_probe_pointers;
         std::map<std::string, OutputType> output_types;
 };
 
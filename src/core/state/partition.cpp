@@ -0,0 +1,230 @@
+#include <climits>
+
+#include "state/partition.h"
+#include "state/attributes.h"
+#include "network/connection.h"
+
+/* Load of a layer for balancing purposes
+ * Synaptic weights dominate both compute and memory, but neurons are
+ *   counted as well so that layers without inputs still carry weight. */
+static long get_load(Layer *layer) {
+    return (long)layer->get_num_compute_weights() + layer->size;
+}
+
+static std::map<DeviceID, long> get_device_loads(
+        const LayerDeviceMap& layer_devices, std::set<DeviceID> devices) {
+    std::map<DeviceID, long> loads;
+    for (auto device : devices)
+        loads[device] = 0;
+    for (auto pair : layer_devices)
+        loads[pair.second] += get_load(pair.first);
+    return loads;
+}
+
+/* Inter-device transfers out of the device hosting |source|
+ * Each element corresponds to one InterDeviceTransferInstruction: the
+ *   engine shares a transfer between all connections to the same
+ *   destination device that read the same output word. */
+typedef std::set<std::pair<DeviceID, int>> TransferSet;
+static TransferSet get_source_transfers(Layer *source,
+        const LayerDeviceMap& layer_devices) {
+    TransferSet transfers;
+    auto source_it = layer_devices.find(source);
+    if (source_it == layer_devices.end()) return transfers;
+
+    for (auto conn : source->get_output_connections()) {
+        auto dest_it = layer_devices.find(conn->to_layer);
+        if (dest_it != layer_devices.end()
+                and dest_it->second != source_it->second)
+            transfers.insert(std::make_pair(dest_it->second,
+                get_word_index(conn->delay,
+                    Attributes::get_output_type(source))));
+    }
+    return transfers;
+}
+
+/* Bytes per timestep transferred out of the device hosting |source| */
+static size_t get_source_cost(Layer *source,
+        const LayerDeviceMap& layer_devices) {
+    return get_source_transfers(source, layer_devices).size()
+        * source->size * sizeof(Output);
+}
+
+/* Cost change from moving |layer| onto |device|
+ * Only transfers out of the layer and out of its sources can change */
+static long get_move_delta(Layer *layer, DeviceID device,
+        LayerDeviceMap& layer_devices) {
+    std::set<Layer*> sources = { layer };
+    for (auto conn : layer->get_input_connections())
+        sources.insert(conn->from_layer);
+
+    long before = 0;
+    for (auto source : sources)
+        before += get_source_cost(source, layer_devices);
+
+    DeviceID original = layer_devices[layer];
+    layer_devices[layer] = device;
+
+    long after = 0;
+    for (auto source : sources)
+        after += get_source_cost(source, layer_devices);
+
+    layer_devices[layer] = original;
+    return after - before;
+}
+
+/* Give the next biggest layer to the device with the most free weights
+ *   until no layers are left to distribute
+ * This is the original greedy assignment, which only counts compute weights
+ *   and ignores the connection graph. */
+static void greedy_seed(const LayerList& layers, std::set<DeviceID> devices,
+        LayerDeviceMap& layer_devices) {
+    std::map<DeviceID, long> device_loads;
+    for (auto device : devices)
+        device_loads[device] = 0;
+    for (auto pair : layer_devices)
+        device_loads[pair.second] += pair.first->get_num_compute_weights();
+
+    std::map<Layer*, long> loads;
+    for (auto layer : layers)
+        if (layer_devices.count(layer) == 0)
+            loads[layer] = layer->get_num_compute_weights();
+
+    while (loads.size() > 0) {
+        // Start with the max device ID
+        // If multi-GPU and an imbalanced network, this can shift the
+        //   burden off of the the primary GPU
+        int next_device = *devices.rbegin();
+        for (auto pair : device_loads)
+            if (pair.second < device_loads.at(next_device))
+                next_device = pair.first;
+
+        Layer *biggest = nullptr;
+        long size = -1;
+        for (auto pair : loads) {
+            if (pair.second > size) {
+                size = pair.second;
+                biggest = pair.first;
+            }
+        }
+        loads.erase(biggest);
+        layer_devices[biggest] = next_device;
+        device_loads[next_device] += size;
+    }
+}
+
+/* Kernighan-Lin / Fiduccia-Mattheyses style refinement
+ * Each pass moves every unpinned layer exactly once, always taking the
+ *   best feasible move even if it increases traffic, and then rolls back
+ *   to the best assignment seen during the pass.  Passes repeat until
+ *   no improvement is found.  Layer graphs are small enough that the
+ *   graph does not need to be coarsened first. */
+static void refine(const LayerList& layers, std::set<DeviceID> devices,
+        const std::set<Layer*>& pinned, float imbalance,
+        LayerDeviceMap& layer_devices) {
+    long total_load = 0;
+    for (auto layer : layers)
+        total_load += get_load(layer);
+
+    // Never exceed the balance limit, unless the seed already does
+    long limit = (1.0 + imbalance) * total_load / devices.size();
+    for (auto pair : get_device_loads(layer_devices, devices))
+        limit = std::max(limit, pair.second);
+
+    const int max_passes = 16;
+    for (int pass = 0 ; pass < max_passes ; ++pass) {
+        auto curr_devices = layer_devices;
+        auto loads = get_device_loads(curr_devices, devices);
+        std::set<Layer*> locked = pinned;
+
+        long curr_delta = 0;
+        long best_delta = 0;
+        auto best_devices = layer_devices;
+
+        while (locked.size() < layers.size()) {
+            Layer *move_layer = nullptr;
+            DeviceID move_device = 0;
+            long move_delta = LONG_MAX;
+
+            for (auto layer : layers) {
+                if (locked.count(layer) > 0) continue;
+
+                long load = get_load(layer);
+                for (auto device : devices) {
+                    if (device == curr_devices[layer]
+                            or loads[device] + load > limit)
+                        continue;
+
+                    long delta = get_move_delta(layer, device, curr_devices);
+                    if (delta < move_delta) {
+                        move_delta = delta;
+                        move_layer = layer;
+                        move_device = device;
+                    }
+                }
+            }
+
+            // No feasible moves left
+            if (move_layer == nullptr) break;
+
+            loads[curr_devices[move_layer]] -= get_load(move_layer);
+            loads[move_device] += get_load(move_layer);
+            curr_devices[move_layer] = move_device;
+            locked.insert(move_layer);
+
+            curr_delta += move_delta;
+            if (curr_delta < best_delta) {
+                best_delta = curr_delta;
+                best_devices = curr_devices;
+            }
+        }
+
+        if (best_delta < 0) layer_devices = best_devices;
+        else break;
+    }
+}
+
+LayerDeviceMap partition_layers(const LayerList& layers,
+        std::set<DeviceID> devices, float imbalance, bool refine_seed) {
+    LayerDeviceMap layer_devices;
+
+    if (devices.size() == 1) {
+        int dev = *devices.begin();
+        for (auto layer : layers)
+            layer_devices[layer] = dev;
+        return layer_devices;
+    }
+
+    // Respect device allocation parameters
+    std::set<Layer*> pinned;
+    for (auto layer : layers) {
+        int dev = layer->get_config()->get_int("device", -1);
+
+        // If device provided and is in the set, allocate layer
+        if (dev > -1 and devices.count(dev) > 0) {
+            layer_devices[layer] = dev;
+            pinned.insert(layer);
+        }
+    }
+
+    greedy_seed(layers, devices, layer_devices);
+    if (refine_seed)
+        refine(layers, devices, pinned, imbalance, layer_devices);
+
+    return layer_devices;
+}
+
+int count_inter_device_transfers(const LayerList& layers,
+        const LayerDeviceMap& layer_devices, size_t* bytes) {
+    int count = 0;
+    size_t total = 0;
+
+    for (auto layer : layers) {
+        int transfers = get_source_transfers(layer, layer_devices).size();
+        count += transfers;
+        total += transfers * layer->size * sizeof(Output);
+    }
+
+    if (bytes != nullptr) *bytes = total;
+    return count;
+}
@@ -0,0 +1,28 @@
+#ifndef partition_h
+#define partition_h
+
+#include <map>
+#include <set>
+
+#include "network/layer.h"
+#include "util/constants.h"
+
+typedef std::map<Layer*, DeviceID> LayerDeviceMap;
+
+/* Assigns layers to devices.
+ * Layers with a "device" property in the set are pinned to that device.
+ * The remaining layers are seeded greedily by compute weights, and then
+ *   refined to minimize inter-device traffic while keeping the load within
+ *   |imbalance| of an even split.  Without |refine_seed|, the greedy
+ *   assignment is returned as is, for comparison. */
+LayerDeviceMap partition_layers(const LayerList& layers,
+    std::set<DeviceID> devices, float imbalance=0.1, bool refine_seed=true);
+
+/* Counts the inter-device transfers implied by an assignment.
+ * One transfer is needed per source layer, destination device, and
+ *   output word index.  If |bytes| is provided, the number of bytes
+ *   transferred per timestep is written to it. */
+int count_inter_device_transfers(const LayerList& layers,
+    const LayerDeviceMap& layer_devices, size_t* bytes=nullptr);
+
+#endif
@@ -5,79 +5,13 @@
 #include "state/state.h"
 #include "state/weight_matrix.h"
 #include "state/neural_model_bank.h"
+#include "state/partition.h"
 #include "network/network.h"
 #include "io/buffer.h"
+#include "engine/engine.h"
+#include "engine/instruction.h"
 #include "util/resources/pointer_stash.h"
 
-static std::map<Layer*, DeviceID> distribute_layers(
-        const LayerList& layers, std::set<DeviceID> devices) {
-    std::map<Layer*, DeviceID> layer_devices;
-
-    if (devices.size() == 1) {
-        int dev = *devices.begin();
-        for (auto layer : layers)
-            layer_devices[layer] = dev;
-        return layer_devices;
-    }
-
-    // Distribute layers
-    // Count up weights
-    std::map<Layer*, int> num_weights;
-    for (auto layer : layers)
-        num_weights[layer] = layer->get_num_compute_weights();
-
-    // Keep track of weight distribution to devices
-    std::map<DeviceID, int> device_weights;
-    for (auto device : devices)
-        device_weights[device] = 0;
-
-    // Respect device allocation parameters
-    for (auto layer : layers) {
-        int dev = layer->get_config()->get_int("device", -1);
-
-        // If device provided and is in the set, allocate layer
-        if (dev > -1) {
-            for (auto device : devices) {
-                if (dev == device) {
-                    layer_devices[layer] = dev;
-                    device_weights[dev] += num_weights[layer];
-                    num_weights.erase(layer);
-                }
-            }
-        }
-    }
-
-    // Give the next biggest layer to the device with the least weight
-    //   until no layers are left to distribute
-    for (int i = 0; num_weights.size() > 0; ++i) {
-        // Start with the max device ID
-        // If multi-GPU and an imbalanced network, this can shift the
-        //   burden off of the the primary GPU
-        int next_device = *devices.begin();
-        for (auto pair : device_weights)
-            if (pair.first > next_device)
-                next_device = pair.first;
-
-        for (auto pair : device_weights)
-            if (pair.second < device_weights.at(next_device))
-                next_device = pair.first;
-
-        Layer *biggest;
-        int size = -1;
-        for (auto pair : num_weights) {
-            if (pair.second > size) {
-                size = pair.second;
-                biggest = pair.first;
-            }
-        }
-        num_weights.erase(biggest);
-        layer_devices[biggest] = next_device;
-        device_weights[next_device] += size;
-    }
-
-    return layer_devices;
-}
-
 State::State(Network *network, std::string filename)
         : network(network), on_host(true) {
     // Preload state and stash pointers
@@ -153,7 +87,11 @@ void State::build(std::set<DeviceID> devices) {
 
     // Distribute layers
     this->active_devices = devices;
-    this->layer_devices = distribute_layers(network->get_layers(), devices);
+    this->layer_devices = partition_layers(network->get_layers(), devices);
+    LOG_DEBUG("Partitioned layers with "
+        + std::to_string(count_inter_device_transfers(
+            network->get_layers(), layer_devices))
+        + " inter-device transfers\n");
 
     // Delete old buffers
     for (auto pair : internal_buffers)
@@ -259,6 +197,10 @@ PointerSetMap State::get_buffer_pointers() const {
 void State::transfer_to_device() {
     if (not on_host) return;
 
+    // Neuron variables may have changed on the host
+    for (auto pair : attributes)
+        pair.second->process_neuron_variables();
+
     auto res_man = ResourceManager::get_instance();
     DeviceID host_id = res_man->get_host_id();
 
@@ -357,6 +299,159 @@ size_t State::get_buffer_bytes() const {
     return size;
 }
 
+/* Labels a layer or connection entry of a memory report */
+static PropertyConfig layer_memory_entry(Layer *layer, PropertyConfig report) {
+    PropertyConfig entry;
+    entry.set("structure", layer->structure->name);
+    entry.set("layer", layer->name);
+    entry.set("neural model", layer->neural_model);
+    entry.set("size", std::to_string(layer->size));
+    for (auto pair : report.get()) entry.set(pair.first, pair.second);
+    return entry;
+}
+
+static PropertyConfig connection_memory_entry(Connection *conn,
+        PropertyConfig report) {
+    PropertyConfig entry;
+    entry.set("connection", conn->str());
+    entry.set("from structure", conn->from_layer->structure->name);
+    entry.set("from layer", conn->from_layer->name);
+    entry.set("to structure", conn->to_layer->structure->name);
+    entry.set("to layer", conn->to_layer->name);
+    entry.set("weights count", std::to_string(conn->get_num_weights()));
+    for (auto pair : report.get()) entry.set(pair.first, pair.second);
+    return entry;
+}
+
+PropertyConfig *State::get_memory_report() const {
+    auto report = new PropertyConfig();
+    size_t total = 0;
+
+    for (auto layer : network->get_layers()) {
+        auto att = attributes.at(layer);
+        auto entry = layer_memory_entry(layer, att->get_memory_report());
+        entry.set("device", std::to_string(get_device_id(layer)));
+        total += std::stoll(entry.get("total bytes"));
+        report->add_to_child_array("layers", &entry);
+    }
+
+    for (auto conn : network->get_connections()) {
+        auto mat = attributes.at(conn->to_layer)->get_weight_matrix(conn);
+        auto entry = connection_memory_entry(conn, mat->get_memory_report());
+        entry.set("device", std::to_string(get_device_id(conn->to_layer)));
+        total += std::stoll(entry.get("total bytes"));
+        report->add_to_child_array("connections", &entry);
+    }
+
+    for (auto pair : internal_buffers) {
+        size_t internal = 0, inter_device = 0;
+        for (auto ptr : pair.second->get_pointers())
+            internal += ptr->get_bytes();
+        for (auto inner_pair : inter_device_buffers.at(pair.first))
+            for (auto ptr : inner_pair.second->get_pointers())
+                inter_device += ptr->get_bytes();
+
+        PropertyConfig entry;
+        entry.set("device", std::to_string(pair.first));
+        entry.set("input buffer", std::to_string(internal));
+        entry.set("inter-device buffer", std::to_string(inter_device));
+        entry.set("total bytes", std::to_string(internal + inter_device));
+        total += internal + inter_device;
+        report->add_to_child_array("buffers", &entry);
+    }
+
+    report->set("total bytes", std::to_string(total));
+    return report;
+}
+
+static std::set<DeviceID> get_virtual_devices(int num_devices) {
+    if (num_devices < 1)
+        LOG_ERROR("Cannot partition network over "
+            + std::to_string(num_devices) + " devices!");
+
+    std::set<DeviceID> devices;
+    for (DeviceID i = 0 ; i < num_devices ; ++i)
+        devices.insert(i);
+    return devices;
+}
+
+static PropertyConfig *partition_report(const LayerList& layers,
+        const LayerDeviceMap& layer_devices) {
+    size_t bytes = 0;
+    int transfers = count_inter_device_transfers(
+        layers, layer_devices, &bytes);
+
+    auto report = new PropertyConfig();
+    for (auto layer : layers) {
+        PropertyConfig entry;
+        entry.set("structure", layer->structure->name);
+        entry.set("layer", layer->name);
+        entry.set("device", std::to_string(layer_devices.at(layer)));
+        report->add_to_child_array("layers", &entry);
+    }
+    report->set("inter-device transfers", std::to_string(transfers));
+    report->set("inter-device bytes", std::to_string(bytes));
+    return report;
+}
+
+PropertyConfig *State::estimate_partition(Network *network,
+        int num_devices, bool refine) {
+    auto layer_devices = partition_layers(network->get_layers(),
+        get_virtual_devices(num_devices), 0.1, refine);
+    return partition_report(network->get_layers(), layer_devices);
+}
+
+PropertyConfig *State::get_partition_report(int num_devices) {
+    // Buffers are only allocated on the devices when transferred,
+    //   so the state can be built for devices that do not exist
+    this->build(get_virtual_devices(num_devices));
+
+    auto report = partition_report(network->get_layers(), layer_devices);
+    report->set("transfer instructions",
+        std::to_string(InterDeviceTransferInstruction::count(this)));
+    return report;
+}
+
+PropertyConfig *State::estimate_memory(Network *network,
+        Environment *environment) {
+    auto report = new PropertyConfig();
+    size_t total = 0;
+    size_t buffer = 0;
+
+    for (auto layer : network->get_layers()) {
+        auto entry = layer_memory_entry(layer,
+            Attributes::estimate_memory(layer));
+        total += std::stoll(entry.get("total bytes"));
+        buffer += sizeof(float) * layer->size;
+        report->add_to_child_array("layers", &entry);
+    }
+
+    for (auto conn : network->get_connections()) {
+        auto entry = connection_memory_entry(conn,
+            WeightMatrix::estimate_memory(conn));
+        total += std::stoll(entry.get("total bytes"));
+        report->add_to_child_array("connections", &entry);
+    }
+
+    // Layer input buffers, assuming a single device
+    PropertyConfig entry;
+    entry.set("input buffer", std::to_string(buffer));
+    entry.set("total bytes", std::to_string(buffer));
+    total += buffer;
+    report->add_to_child_array("buffers", &entry);
+
+    // The engine IO buffer depends on the environment modules
+    if (environment != nullptr) {
+        size_t engine_buffer =
+            Engine::estimate_buffer_bytes(network, environment);
+        report->set("engine buffer", std::to_string(engine_buffer));
+        total += engine_buffer;
+    }
+
+    report->set("total bytes", std::to_string(total));
+    return report;
+}
+
 bool State::exists(std::string file_name) {
     std::ifstream f((file_name).c_str());
     return f.good();
@@ -11,6 +11,7 @@
 #include "util/resources/pointer.h"
 
 class Buffer;
+class Environment;
 class Network;
 class Layer;
 class DendriticNode;
@@ -40,6 +41,29 @@ class State {
         size_t get_network_bytes() const;
         size_t get_buffer_bytes() const;
 
+        /* Memory accounting
+         * get_memory_report() itemizes the built state by layer, connection,
+         *   and device buffer.  estimate_memory() predicts the same breakdown
+         *   from the network alone, allocating one layer of neuron data at
+         *   a time.  Given an environment, it also sizes the engine IO
+         *   buffer, which the engine reports as "engine buffer bytes". */
+        PropertyConfig *get_memory_report() const;
+        static PropertyConfig *estimate_memory(Network *network,
+            Environment *environment=nullptr);
+
+        /* Previews the layer partition over |num_devices| virtual devices
+         * Reports the device of each layer and the number of inter-device
+         *   transfers, so partitions can be compared without the hardware.
+         *   Without |refine|, the original greedy assignment is reported. */
+        static PropertyConfig *estimate_partition(Network *network,
+            int num_devices, bool refine=true);
+
+        /* Builds the state over |num_devices| virtual devices, without
+         *   transferring to them, and reports the partition along with the
+         *   number of inter-device transfer instructions an engine would
+         *   build for it ("transfer instructions"). */
+        PropertyConfig *get_partition_report(int num_devices);
+
         /* Save or load state to/from disk */
         static bool exists(std::string file_name);
         void save(std::string file_name, bool verbose=false);
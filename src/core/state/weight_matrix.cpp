@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include "state/weight_matrix.h"
+#include "state/neural_model_bank.h"
 #include "network/layer.h"
 #include "network/connection.h"
 #include "engine/kernel/synapse_kernel.h"
@@ -26,11 +27,15 @@ WeightMatrix::WeightMatrix(Connection* conn)
       transpose_flag(false) {
     this->rows = conn->get_matrix_rows();
     this->columns = conn->get_matrix_columns();
+    this->interior_row_start = this->interior_row_end = 0;
+    this->interior_column_start = this->interior_column_end = 0;
 }
 
 WeightMatrix::~WeightMatrix() {
     // Free pointers
     for (auto ptr : get_pointers()) ptr->free();
+    convergent_row_table.free();
+    convergent_column_table.free();
 
     // Free device copy if one exists
     if (this != this->pointer)
@@ -43,7 +48,35 @@ WeightMatrix *WeightMatrix::build(Connection *conn) {
     return mat;
 }
 
+WeightMatrix *WeightMatrix::probe(Connection *conn) {
+    return new WeightMatrix(conn);
+}
+
+void WeightMatrix::estimate_indices(std::map<std::string, size_t>& arrays) {
+    // To row/column indices and the used mask are purged after building
+    size_t bytes = connection->get_num_weights() * sizeof(int);
+    for (auto key : { "from row indices", "from column indices",
+                      "from indices", "to indices" })
+        arrays[key] = bytes;
+}
+
+void WeightMatrix::estimate_delays(std::map<std::string, size_t>& arrays) {
+    size_t num_weights = connection->get_num_weights();
+    arrays["delays"] = num_weights * sizeof(int);
+
+    // Spatial delays are computed from distances, which need indices
+    if (connection->get_parameter("myelinated", "false") != "true"
+            and not connection->get_config()->has("random delay")) {
+        arrays["distances"] = num_weights * sizeof(float);
+        estimate_indices(arrays);
+    }
+}
+
 void WeightMatrix::init() {
+    // Convergent kernels need boundary tables, even for initialization
+    if (connection->get_type() == CONVERGENT)
+        build_convergent_tables();
+
     // Consult the pointer stash to see if we can skip any initialization
     auto pointers = get_pointer_map();
     auto stash = PointerStash::get_instance();
@@ -106,11 +139,17 @@ BasePointer* WeightMatrix::get_layer(std::string key) {
     if (key == "weights") return &weights;
     try {
         return variables.at(key);
-    } catch (std::out_of_range) {
-        LOG_ERROR(
-            "Failed to retrieve data \"" + key + "\" in WeightMatrix for "
-            "connection:" + connection->str());
-    }
+    } catch (std::out_of_range) { }
+
+    // Other arrays, if allocated (eg. "weights transposed")
+    auto pointers = get_named_pointers();
+    auto it = pointers.find(key);
+    if (it != pointers.end() and it->second->get_size() > 0)
+        return it->second;
+
+    LOG_ERROR(
+        "Failed to retrieve data \"" + key + "\" in WeightMatrix for "
+        "connection:" + connection->str());
 }
 
 std::vector<BasePointer*> WeightMatrix::get_pointers() {
@@ -122,41 +161,98 @@ std::vector<BasePointer*> WeightMatrix::get_pointers() {
 
 std::map<PointerKey, BasePointer*> WeightMatrix::get_pointer_map() {
     std::map<PointerKey, BasePointer*> pointers;
-
-    pointers[PointerKey(connection->id, "weights",
-        weights.get_bytes())] = &weights;
-    pointers[PointerKey(connection->id, "weights transposed",
-        weights_transposed.get_bytes())] = &weights_transposed;
-    pointers[PointerKey(connection->id, "second order weights",
-        second_order_weights.get_bytes())] = &second_order_weights;
-    pointers[PointerKey(connection->id, "nonzero counts",
-        nonzero_counts.get_bytes())] = &nonzero_counts;
-    pointers[PointerKey(connection->id, "from row indices",
-        from_row_indices.get_bytes())] = &from_row_indices;
-    pointers[PointerKey(connection->id, "from column indices",
-        from_column_indices.get_bytes())] = &from_column_indices;
-    pointers[PointerKey(connection->id, "from indices",
-        from_indices.get_bytes())] = &from_indices;
-    pointers[PointerKey(connection->id, "to row indices",
-        to_row_indices.get_bytes())] = &to_row_indices;
-    pointers[PointerKey(connection->id, "to column indices",
-        to_column_indices.get_bytes())] = &to_column_indices;
-    pointers[PointerKey(connection->id, "to indices",
-        to_indices.get_bytes())] = &to_indices;
-    pointers[PointerKey(connection->id, "used",
-        used.get_bytes())] = &used;
-    pointers[PointerKey(connection->id, "distances",
-        distances.get_bytes())] = &distances;
-    pointers[PointerKey(connection->id, "delays",
-        delays.get_bytes())] = &delays;
-
-    for (auto pair : variables)
+    for (auto pair : get_named_pointers())
         pointers[PointerKey(
             connection->id, pair.first,
             pair.second->get_bytes())] = pair.second;
     return pointers;
 }
 
+std::map<std::string, BasePointer*> WeightMatrix::get_named_pointers() {
+    std::map<std::string, BasePointer*> pointers;
+
+    pointers["weights"] = &weights;
+    pointers["weights transposed"] = &weights_transposed;
+    pointers["second order weights"] = &second_order_weights;
+    pointers["nonzero counts"] = &nonzero_counts;
+    pointers["from row indices"] = &from_row_indices;
+    pointers["from column indices"] = &from_column_indices;
+    pointers["from indices"] = &from_indices;
+    pointers["to row indices"] = &to_row_indices;
+    pointers["to column indices"] = &to_column_indices;
+    pointers["to indices"] = &to_indices;
+    pointers["used"] = &used;
+    pointers["distances"] = &distances;
+    pointers["delays"] = &delays;
+
+    for (auto pair : variables)
+        pointers[pair.first] = pair.second;
+    return pointers;
+}
+
+PropertyConfig WeightMatrix::get_memory_report() {
+    auto pointers = get_named_pointers();
+
+    // Boundary tables stay on the host, and are not part of the state
+    pointers["convergent row table"] = &convergent_row_table;
+    pointers["convergent column table"] = &convergent_column_table;
+    get_extra_memory(pointers);
+
+    PropertyConfig report;
+    size_t total = 0;
+    for (auto pair : pointers) {
+        size_t bytes = pair.second->get_bytes();
+        if (bytes > 0) {
+            report.set(pair.first, std::to_string(bytes));
+            total += bytes;
+        }
+    }
+    report.set("total bytes", std::to_string(total));
+    return report;
+}
+
+PropertyConfig WeightMatrix::estimate_memory(Connection *conn) {
+    size_t num_weights = conn->get_num_weights();
+    std::map<std::string, size_t> arrays;
+
+    arrays["weights"] = num_weights * sizeof(float);
+    if (conn->second_order_host)
+        arrays["second order weights"] = num_weights * sizeof(float);
+
+    WeightMatrix *probe = NeuralModelBank::probe_weight_matrix(conn);
+    if (conn->sparse or conn->randomized_projection)
+        probe->estimate_indices(arrays);
+    if (conn->sparse)
+        arrays["nonzero counts"] = conn->to_layer->size * sizeof(int);
+
+    if (conn->get_type() == CONVERGENT) {
+        auto arborized_config = conn->get_config()->get_arborized_config();
+        arrays["convergent row table"] = sizeof(int)
+            * conn->to_layer->rows * arborized_config.row_field_size;
+        arrays["convergent column table"] = sizeof(int)
+            * conn->to_layer->columns * arborized_config.column_field_size;
+    }
+
+    // Arrays allocated by the attributes
+    probe->estimate_processing(arrays);
+
+    // Measure subclass variables on a single weight probe
+    probe->num_weights = 1;
+    probe->register_variables();
+    for (auto pair : probe->variables)
+        arrays[pair.first] = pair.second->get_bytes() * num_weights;
+    delete probe;
+
+    PropertyConfig report;
+    size_t total = 0;
+    for (auto pair : arrays) {
+        report.set(pair.first, std::to_string(pair.second));
+        total += pair.second;
+    }
+    report.set("total bytes", std::to_string(total));
+    return report;
+}
+
 void WeightMatrix::transfer(DeviceID new_device) {
     if (device_id == new_device) return;
 
@@ -341,6 +437,69 @@ void WeightMatrix::adjust_sparse_indices() {
     }
 }
 
+/* Splits one dimension of a convergent connection into interior and border
+ * Entries are the source index for each (destination, kernel element) pair,
+ *   wrapped if necessary, or -1 if the source does not exist.
+ * The interior is the range of destinations whose entire field is in bounds
+ *   without wrapping.  Sources are linear in the destination, so this
+ *   range is contiguous. */
+static void build_convergent_table(int* table, int to_size, int from_size,
+        int field_size, int stride, int spacing, int offset, bool wrap,
+        int* interior_start, int* interior_end) {
+    *interior_start = *interior_end = 0;
+    bool found = false;
+
+    for (int to = 0 ; to < to_size ; ++to) {
+        int start = to * stride + (spacing * offset);
+        bool interior = true;
+
+        for (int k = 0 ; k < field_size ; ++k) {
+            int from = start + (k * spacing);
+            if (from < 0 or from >= from_size) {
+                interior = false;
+                from = (wrap) ? (from % from_size + from_size) % from_size : -1;
+            }
+            table[to * field_size + k] = from;
+        }
+
+        if (interior) {
+            if (not found) *interior_start = to;
+            *interior_end = to + 1;
+            found = true;
+        }
+    }
+}
+
+void WeightMatrix::build_convergent_tables() {
+    if (not convergent_row_table.is_null()) return;
+
+    auto arborized_config = connection->get_config()->get_arborized_config();
+    auto from_layer = connection->from_layer;
+    auto to_layer = connection->to_layer;
+
+    this->convergent_row_table = Pointer<int>(
+        to_layer->rows * arborized_config.row_field_size);
+    this->convergent_column_table = Pointer<int>(
+        to_layer->columns * arborized_config.column_field_size);
+
+    build_convergent_table(convergent_row_table.get(),
+        to_layer->rows, from_layer->rows,
+        arborized_config.row_field_size,
+        arborized_config.row_stride,
+        arborized_config.row_spacing,
+        arborized_config.row_offset,
+        arborized_config.wrap,
+        &interior_row_start, &interior_row_end);
+    build_convergent_table(convergent_column_table.get(),
+        to_layer->columns, from_layer->columns,
+        arborized_config.column_field_size,
+        arborized_config.column_stride,
+        arborized_config.column_spacing,
+        arborized_config.column_offset,
+        arborized_config.wrap,
+        &interior_column_start, &interior_column_end);
+}
+
 /* This function is necessary for freeing up auxiliary matrices that
  *   were necessary during construction and initialization */
 void WeightMatrix::purge_auxiliary() {
@@ -1322,15 +1481,15 @@ HOST void compute_delays_SERIAL(int num_weights,
         int* delays, float* distances,
         float from_spacing, float to_spacing,
         float x_offset, float y_offset,
-        float velocity, bool cap_delay, int base_delay) {
+        float velocity, bool cap_delay, int base_delay, int max_delay) {
 
     for (int weight_index = 0 ; weight_index < num_weights ; ++weight_index) {
         int delay = base_delay + (distances[weight_index] / velocity);
-        if (delay > 31 and not cap_delay) {
-            printf("BIT delays cannot be greater than 31!\n");
+        if (delay > max_delay and not cap_delay) {
+            printf("Delays cannot be greater than %d!\n", max_delay);
             assert(false);
         }
-        delays[weight_index] = MIN(31, delay);
+        delays[weight_index] = MIN(max_delay, delay);
     }
 }
 
@@ -1339,16 +1498,16 @@ GLOBAL void compute_delays_PARALLEL(int num_weights,
         int* delays, float* distances,
         float from_spacing, float to_spacing,
         float x_offset, float y_offset,
-        float velocity, bool cap_delay, int base_delay) {
+        float velocity, bool cap_delay, int base_delay, int max_delay) {
 
     int weight_index = blockIdx.x * blockDim.x + threadIdx.x;
     if (weight_index < num_weights) {
         int delay = base_delay + (distances[weight_index] / velocity);
-        if (delay > 31 and not cap_delay) {
-            printf("BIT delays cannot be greater than 31!\n");
+        if (delay > max_delay and not cap_delay) {
+            printf("Delays cannot be greater than %d!\n", max_delay);
             assert(false);
         }
-        delays[weight_index] = MIN(31, delay);
+        delays[weight_index] = MIN(max_delay, delay);
     }
 }
 #endif
@@ -1364,7 +1523,7 @@ void WeightMatrix::get_delays(int base_delay) {
 void WeightMatrix::get_delays(OutputType output_type,
         float from_spacing, float to_spacing,
         float x_offset, float y_offset,
-        float velocity, bool cap_delay) {
+        float velocity, bool cap_delay, int max_delay) {
 
     // If delays is already set, delays have already been retrieved
     if (not this->delays.is_null()) return;
@@ -1390,7 +1549,7 @@ void WeightMatrix::get_delays(OutputType output_type,
         compute_delays_SERIAL(num_weights,
             this->delays.get(), this->distances.get(),
             from_spacing, to_spacing, x_offset, y_offset,
-            velocity, cap_delay, conn->delay);
+            velocity, cap_delay, conn->delay, max_delay);
     } else {
 #ifdef __CUDACC__
         DeviceID device_id = *res_man->get_devices().begin();
@@ -1420,7 +1579,7 @@ void WeightMatrix::get_delays(OutputType output_type,
                 this->delays.get_unsafe(), this->distances.get_unsafe(),
                 from_spacing, to_spacing,
                 x_offset, y_offset,
-                velocity, cap_delay, conn->delay);
+                velocity, cap_delay, conn->delay, max_delay);
         device_synchronize();
         device_check_error("Failed to compute delays!");
 
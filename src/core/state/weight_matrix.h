@@ -2,6 +2,7 @@
 #define weight_matrix_h
 
 #include "util/constants.h"
+#include "util/property_config.h"
 #include "util/resources/pointer.h"
 
 class Connection;
@@ -14,6 +15,9 @@ class WeightMatrix {
         // Build function
         static WeightMatrix *build(Connection *conn);
 
+        // Constructs without initializing (see estimate_memory())
+        static WeightMatrix *probe(Connection *conn);
+
         // Getters
         Pointer<float> get_weights() const { return weights; }
         Pointer<float> get_weights_transposed() const
@@ -28,8 +32,18 @@ class WeightMatrix {
         // Pointer sets and transfer functions
         std::vector<BasePointer*> get_pointers();
         std::map<PointerKey, BasePointer*> get_pointer_map();
+        std::map<std::string, BasePointer*> get_named_pointers();
         void transfer(DeviceID new_device);
 
+        /* Memory accounting
+         * Reports bytes for each allocated array, and the total.
+         * Estimates are computed from the connection alone.  Subclass
+         *   variables are measured on a probe with a single weight, and
+         *   subclasses report what they allocate during processing.
+         *   Sparse matrices are estimated at full size. */
+        PropertyConfig get_memory_report();
+        static PropertyConfig estimate_memory(Connection *conn);
+
         // Transposition
         void transpose();
         void set_transpose_flag(bool t);
@@ -38,6 +52,16 @@ class WeightMatrix {
         // Subclasses implement this for variable registration
         virtual void register_variables() { }
 
+        // Subclasses that allocate arrays while being processed by their
+        //   attributes (eg. delays) report them here for memory estimates
+        virtual void estimate_processing(
+            std::map<std::string, size_t>& arrays) { }
+
+        // Subclasses that allocate arrays outside of their registered
+        //   variables (eg. lazily built tables) add them to memory reports
+        virtual void get_extra_memory(
+            std::map<std::string, BasePointer*>& pointers) { }
+
         // Auto-resize for sparse matrices, which may need to be resized
         //   after a state save/load
         void resize();
@@ -58,11 +82,13 @@ class WeightMatrix {
         /* Stores uniform delays */
         void get_delays(int base_delay);
 
-        /* Stores delays in array according to spatial organization */
+        /* Stores delays in array according to spatial organization
+         * Delays beyond |max_delay| are an error unless |cap_delay| is set.
+         * The default is the history held by a single BIT output word. */
         void get_delays(OutputType output_type,
             float from_spacing, float to_spacing,
             float x_offset, float y_offset,
-            float velocity, bool cap_delay);
+            float velocity, bool cap_delay, int max_delay=31);
 
         // Pointer to this object
         // If parallel, this will point to the device copy
@@ -91,6 +117,16 @@ class WeightMatrix {
         // Transmission delays for each weight
         Pointer<int> delays;
 
+        // Boundary tables for convergent connections
+        // Destinations in the interior region see their whole field in
+        //   bounds, and are computed with constant strides.  Border rows
+        //   and columns look up source rows and columns for each kernel
+        //   element, already wrapped, or -1 if out of bounds.
+        int interior_row_start, interior_row_end;
+        int interior_column_start, interior_column_end;
+        Pointer<int> convergent_row_table;
+        Pointer<int> convergent_column_table;
+
         Connection* const connection;
 
     protected:
@@ -110,12 +146,22 @@ class WeightMatrix {
         // Initialization
         void init();
 
+        // Adds the bytes of index arrays kept after initialization
+        void estimate_indices(std::map<std::string, size_t>& arrays);
+
+        // Adds the bytes of delays computed by get_delays() with the
+        //   "myelinated" and "random delay" conventions of spiking models
+        void estimate_delays(std::map<std::string, size_t>& arrays);
+
         // Randomizes spatial locations of connections
         void randomize_projection();
 
         // Sparsify functionality
         void sparsify();
 
+        // Computes interior bounds and border tables for convergent kernels
+        void build_convergent_tables();
+
         virtual int get_object_size() { return sizeof(WeightMatrix); }
 };
 
@@ -126,26 +172,30 @@ CLASS_NAME::CLASS_NAME(Connection *conn) \
     : WeightMatrix(conn) { } \
 static bool __mat_dummy = \
     NeuralModelBank::register_weight_matrix( \
-        STRING, CLASS_NAME::build); \
+        STRING, CLASS_NAME::build, CLASS_NAME::probe); \
 int CLASS_NAME::get_object_size() { return sizeof(CLASS_NAME); } \
 \
 WeightMatrix *CLASS_NAME::build(Connection *conn) { \
     auto mat = new CLASS_NAME(conn); \
     mat->init(); \
     return mat; \
+} \
+WeightMatrix *CLASS_NAME::probe(Connection *conn) { \
+    return new CLASS_NAME(conn); \
 }
 
 // Use this if you want to reuse a defined weight matrix class
 #define USE_WEIGHT_MATRIX(CLASS_NAME, STRING) \
 static bool __mat_dummy = \
     NeuralModelBank::register_weight_matrix( \
-        STRING, CLASS_NAME::build);
+        STRING, CLASS_NAME::build, CLASS_NAME::probe);
 
 // Put this one in .h at bottom of class definition
 #define WEIGHT_MATRIX_MEMBERS(CLASS_NAME) \
     public: \
         CLASS_NAME(Connection *conn); \
         static WeightMatrix *build(Connection *conn); \
+        static WeightMatrix *probe(Connection *conn); \
     protected: \
         virtual int get_object_size();
 
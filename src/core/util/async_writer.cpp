@@ -0,0 +1,107 @@
+#include <chrono>
+
+#include "util/async_writer.h"
+#include "util/logger.h"
+
+AsyncWriter::AsyncWriter(std::string filename, const std::string& header,
+        size_t capacity, size_t max_frame_bytes, bool drop)
+        : capacity(capacity),
+          max_frame_bytes(max_frame_bytes),
+          drop(drop),
+          data(capacity * max_frame_bytes),
+          sizes(capacity, 0),
+          head(0),
+          tail(0),
+          running(true),
+          failed(false),
+          dropped(0),
+          stalls(0),
+          bytes_written(0) {
+    if (capacity == 0)
+        LOG_ERROR("AsyncWriter requires a non-empty ring!");
+
+    file = fopen(filename.c_str(), "wb");
+    if (file == nullptr)
+        LOG_ERROR("Could not open file for writing: " + filename);
+
+    // Frames are written in large chunks
+    setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    write(header.data(), header.size());
+
+    thread = std::thread(&AsyncWriter::writer_loop, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+    finish();
+    fclose(file);
+}
+
+char* AsyncWriter::reserve() {
+    size_t curr = head.load(std::memory_order_relaxed);
+
+    if (curr - tail.load(std::memory_order_acquire) == capacity) {
+        if (drop) {
+            ++dropped;
+            return nullptr;
+        }
+
+        ++stalls;
+        while (curr - tail.load(std::memory_order_acquire) == capacity)
+            std::this_thread::yield();
+    }
+
+    return data.data() + (curr % capacity) * max_frame_bytes;
+}
+
+void AsyncWriter::commit(size_t bytes) {
+    if (bytes > max_frame_bytes)
+        LOG_ERROR("AsyncWriter frame exceeds maximum size!");
+
+    size_t curr = head.load(std::memory_order_relaxed);
+    sizes[curr % capacity] = bytes;
+    head.store(curr + 1, std::memory_order_release);
+}
+
+void AsyncWriter::finish() {
+    if (not running) return;
+    running = false;
+    if (thread.joinable()) thread.join();
+    fflush(file);
+}
+
+void AsyncWriter::write(const void* data, size_t bytes) {
+    if (not write_bytes(data, bytes))
+        LOG_ERROR("AsyncWriter failed to write to file!");
+}
+
+bool AsyncWriter::write_bytes(const void* data, size_t bytes) {
+    if (fwrite(data, 1, bytes, file) != bytes) {
+        failed = true;
+        return false;
+    }
+    bytes_written += bytes;
+    return true;
+}
+
+void AsyncWriter::writer_loop() {
+    while (true) {
+        size_t curr = tail.load(std::memory_order_relaxed);
+
+        // Only stop once the producer is done and the ring is empty
+        // The producer commits before finishing, so check the head again
+        //   after seeing that it is done
+        if (curr == head.load(std::memory_order_acquire)) {
+            if (not running and curr == head.load(std::memory_order_acquire))
+                return;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+
+        // Errors can't be thrown from here, so frames are skipped instead
+        size_t index = curr % capacity;
+        uint64_t offset = bytes_written;
+        if (write_bytes(data.data() + index * max_frame_bytes, sizes[index]))
+            frame_offsets.push_back(offset);
+        tail.store(curr + 1, std::memory_order_release);
+    }
+}
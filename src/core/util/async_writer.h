@@ -0,0 +1,76 @@
+#ifndef async_writer_h
+#define async_writer_h
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* AsyncWriter class.
+ * Writes frames to a file on a background thread.
+ *
+ * The producer reserves a frame slot in a single producer, single consumer
+ *   ring, fills it, and commits it.  Neither side takes a lock; the writer
+ *   thread polls the ring and sleeps briefly when it is empty.
+ * If the ring is full, reserve() either waits for the writer (stall) or
+ *   returns nullptr so the frame can be dropped, according to |drop|.
+ *
+ * The header is written before the writer thread starts.  After finish(),
+ *   the ring is drained and write() may be used for trailing data (eg. an
+ *   index built from get_frame_offsets()).
+ */
+class AsyncWriter {
+    public:
+        AsyncWriter(std::string filename, const std::string& header,
+            size_t capacity, size_t max_frame_bytes, bool drop);
+        virtual ~AsyncWriter();
+
+        /* Producer interface */
+        char* reserve();
+        void commit(size_t bytes);
+
+        /* Drains the ring and stops the writer thread */
+        void finish();
+
+        /* Synchronous write, only valid after finish() */
+        void write(const void* data, size_t bytes);
+
+        /* File offsets of committed frames, only valid after finish() */
+        const std::vector<uint64_t>& get_frame_offsets() const
+            { return frame_offsets; }
+
+        size_t get_max_frame_bytes() const { return max_frame_bytes; }
+        size_t get_frames() const { return frame_offsets.size(); }
+        size_t get_dropped() const { return dropped; }
+        size_t get_stalls() const { return stalls; }
+        bool has_failed() const { return failed; }
+        uint64_t get_bytes() const { return bytes_written; }
+
+    protected:
+        void writer_loop();
+        bool write_bytes(const void* data, size_t bytes);
+
+        FILE *file;
+        const size_t capacity;
+        const size_t max_frame_bytes;
+        const bool drop;
+
+        // Ring of frame slots
+        std::vector<char> data;
+        std::vector<size_t> sizes;
+        std::atomic<size_t> head;
+        std::atomic<size_t> tail;
+        std::atomic<bool> running;
+        std::atomic<bool> failed;
+        std::thread thread;
+
+        // Statistics
+        size_t dropped;
+        size_t stalls;
+        uint64_t bytes_written;
+        std::vector<uint64_t> frame_offsets;
+};
+
+#endif
@@ -4,6 +4,8 @@
 CallbackManager *CallbackManager::instance = nullptr;
 
 CallbackManager *CallbackManager::get_instance() {
+    static std::mutex instance_mutex;
+    std::lock_guard<std::mutex> lock(instance_mutex);
     if (CallbackManager::instance == nullptr)
         CallbackManager::instance = new CallbackManager();
     return CallbackManager::instance;
@@ -11,30 +13,36 @@ CallbackManager *CallbackManager::get_instance() {
 
 void CallbackManager::add_io_callback(std::string name,
         void (*addr)(int, int, void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
     io_callbacks[name] = addr;
 }
 
 void CallbackManager::add_weight_callback(std::string name,
         void (*addr)(int, int, void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
     weight_callbacks[name] = addr;
 }
 
 void CallbackManager::add_indices_weight_callback(std::string name,
         void (*addr)(int, int, void*, void*, void*, void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
     indices_weight_callbacks[name] = addr;
 }
 
 void CallbackManager::add_distance_weight_callback(std::string name,
         void (*addr)(int, int, void*, void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
     distance_weight_callbacks[name] = addr;
 }
 
 void CallbackManager::add_delay_weight_callback(std::string name,
         void (*addr)(int, int, void*, void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
     delay_weight_callbacks[name] = addr;
 }
 
 void (*CallbackManager::get_io_callback(std::string name))(int, int, void*) {
+    std::lock_guard<std::mutex> lock(mutex);
     try {
         return io_callbacks.at(name);
     } catch (std::out_of_range) {
@@ -44,6 +52,7 @@ void (*CallbackManager::get_io_callback(std::string name))(int, int, void*) {
 
 void (*CallbackManager::get_weight_callback(std::string name))
         (int, int, void*) {
+    std::lock_guard<std::mutex> lock(mutex);
     try {
         return weight_callbacks.at(name);
     } catch (std::out_of_range) {
@@ -53,6 +62,7 @@ void (*CallbackManager::get_weight_callback(std::string name))
 
 void (*CallbackManager::get_indices_weight_callback(std::string name))
         (int, int, void*, void*, void*, void*) {
+    std::lock_guard<std::mutex> lock(mutex);
     try {
         return indices_weight_callbacks.at(name);
     } catch (std::out_of_range) {
@@ -62,6 +72,7 @@ void (*CallbackManager::get_indices_weight_callback(std::string name))
 
 void (*CallbackManager::get_distance_weight_callback(std::string name))
         (int, int, void*, void*) {
+    std::lock_guard<std::mutex> lock(mutex);
     try {
         return distance_weight_callbacks.at(name);
     } catch (std::out_of_range) {
@@ -72,9 +83,32 @@ void (*CallbackManager::get_distance_weight_callback(std::string name))
 
 void (*CallbackManager::get_delay_weight_callback(std::string name))
         (int, int, void*, void*) {
+    std::lock_guard<std::mutex> lock(mutex);
     try {
         return delay_weight_callbacks.at(name);
     } catch (std::out_of_range) {
         LOG_ERROR("Could not find delay weight callback: " + name);
     }
 }
+
+void CallbackManager::add_io_view(std::string name, int id, std::string key,
+        BasePointer* ptr) {
+    std::lock_guard<std::mutex> lock(mutex);
+    io_views[std::make_tuple(name, id, key)] = ptr;
+}
+
+void CallbackManager::remove_io_view(std::string name, int id,
+        std::string key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    io_views.erase(std::make_tuple(name, id, key));
+}
+
+BasePointer* CallbackManager::get_io_view(std::string name, int id,
+        std::string key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    try {
+        return io_views.at(std::make_tuple(name, id, key));
+    } catch (std::out_of_range) {
+        return nullptr;
+    }
+}
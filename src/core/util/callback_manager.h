@@ -2,7 +2,11 @@
 #define callback_manager_h
 
 #include <string>
+#include <tuple>
 #include <map>
+#include <mutex>
+
+class BasePointer;
 
 class CallbackManager {
     public:
@@ -37,10 +41,20 @@ class CallbackManager {
         void (*get_delay_weight_callback(std::string name))
             (int, int, void*, void*);
 
+        /* IO views are stable host blocks published by callback modules.
+         * They remain valid until the owning module is destroyed. */
+        void add_io_view(std::string name, int id, std::string key,
+            BasePointer* ptr);
+        void remove_io_view(std::string name, int id, std::string key);
+        BasePointer* get_io_view(std::string name, int id, std::string key);
+
     private:
         static CallbackManager *instance;
         CallbackManager() { }
 
+        // Engines in different threads may add and remove views at once
+        std::mutex mutex;
+
         std::map<std::string, void (*)(int, int, void*)> io_callbacks;
         std::map<std::string, void (*)(int, int, void*)>
             weight_callbacks;
@@ -50,6 +64,8 @@ class CallbackManager {
             distance_weight_callbacks;
         std::map<std::string, void (*)(int, int, void*, void*)>
             delay_weight_callbacks;
+        std::map<std::tuple<std::string, int, std::string>, BasePointer*>
+            io_views;
 };
 
 #endif
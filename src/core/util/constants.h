@@ -47,6 +47,51 @@ union Output {
     unsigned int i;
 };
 
+/* Output accumulation enumeration.
+ * With an environment rate above one, outputs can be accumulated over the
+ *   iterations between environment reads instead of being sampled.
+ * Sums keep the output type, except that spikes (BIT) are summed as counts.
+ * Averages are FLOAT (spike rates for BIT outputs).
+ * Counts tally spikes or nonzero outputs as INT.
+ */
+typedef enum {
+    NO_ACCUMULATION,
+    SUM_ACCUMULATION,
+    AVERAGE_ACCUMULATION,
+    COUNT_ACCUMULATION
+} OutputAccumulation;
+
+static std::map<std::string, OutputAccumulation> OutputAccumulations = {
+    {"none", NO_ACCUMULATION},
+    {"sum", SUM_ACCUMULATION},
+    {"average", AVERAGE_ACCUMULATION},
+    {"count", COUNT_ACCUMULATION},
+};
+
+inline OutputAccumulation get_output_accumulation(std::string name) {
+    try {
+        return OutputAccumulations.at(name);
+    } catch (...) {
+        LOG_ERROR(
+            "Unrecognized OutputAccumulation: " + name);
+    }
+}
+
+/* Gets the type of accumulated outputs of a given output type */
+inline OutputType get_accumulated_output_type(OutputType output_type,
+        OutputAccumulation accumulation) {
+    switch (accumulation) {
+        case NO_ACCUMULATION:
+            return output_type;
+        case SUM_ACCUMULATION:
+            return (output_type == BIT) ? INT : output_type;
+        case AVERAGE_ACCUMULATION:
+            return FLOAT;
+        case COUNT_ACCUMULATION:
+            return INT;
+    }
+}
+
 /* IO type enumeration.
  * Indicates sensorimotor connectivity.
  * Input layers receive sensory input from the environment.
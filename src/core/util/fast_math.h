@@ -0,0 +1,146 @@
+#ifndef fast_math_h
+#define fast_math_h
+
+#include <cmath>
+
+#include "util/parallel.h"
+
+/* Vectorizable transcendental functions for neuron state updates
+ *
+ * libm calls inside attribute kernels prevent the compiler from vectorizing
+ *   the per-neuron loop.  These are branch-free polynomial approximations
+ *   built only from arithmetic, comparisons and bit casts, so the loop can
+ *   be unrolled into SIMD instructions.
+ *
+ * FAST_MATH_PRECISION selects the tradeoff (see FAST_MATH in the makefile):
+ *   0 : libm (default)
+ *   1 : relative error below ~8e-7
+ *   2 : relative error below ~3e-3
+ * Bounds are measured over float inputs against double precision libm.
+ *   fast_pow error additionally scales with |y * log(x)|.
+ */
+
+#ifndef FAST_MATH_PRECISION
+#define FAST_MATH_PRECISION 0
+#endif
+
+#define FAST_MATH_LOG2E    1.44269504088896341f
+#define FAST_MATH_LN2_HI   0.693359375f
+#define FAST_MATH_LN2_LO  -2.12194440e-4f
+#define FAST_MATH_ROUNDER  12582912.0f  /* 1.5 * 2^23 */
+
+HOST DEVICE inline float fast_bits_to_float(int bits) {
+    union { int i; float f; } u;
+    u.i = bits;
+    return u.f;
+}
+
+HOST DEVICE inline int fast_float_to_bits(float f) {
+    union { int i; float f; } u;
+    u.f = f;
+    return u.i;
+}
+
+HOST DEVICE inline float fast_exp(float x) {
+#if FAST_MATH_PRECISION == 0
+    return std::exp(x);
+#else
+    // Clamp to the range of normalized floats
+    x = (x > 88.3f) ? 88.3f : x;
+    x = (x < -87.3f) ? -87.3f : x;
+
+    // Range reduction: x = n * ln(2) + r, |r| <= ln(2) / 2
+    // Adding and subtracting the rounder rounds to the nearest integer
+    float n = (x * FAST_MATH_LOG2E + FAST_MATH_ROUNDER) - FAST_MATH_ROUNDER;
+    float r = x - n * FAST_MATH_LN2_HI;
+    r = r - n * FAST_MATH_LN2_LO;
+
+    // Taylor expansion of e^r
+#if FAST_MATH_PRECISION == 1
+    float p = 1.0f + r * (1.0f + r * (0.5f + r * (1.6666667e-1f
+        + r * (4.1666668e-2f + r * (8.3333338e-3f + r * 1.3888889e-3f)))));
+#else
+    float p = 1.0f + r * (1.0f + r * (0.5f + r * 1.6666667e-1f));
+#endif
+
+    // Scale by 2^n by constructing the exponent bits directly
+    return p * fast_bits_to_float(((int)n + 127) << 23);
+#endif
+}
+
+HOST DEVICE inline float fast_log(float x) {
+#if FAST_MATH_PRECISION == 0
+    return std::log(x);
+#else
+    // Split into exponent and mantissa in [sqrt(1/2), sqrt(2))
+    int bits = fast_float_to_bits(x);
+    int e = ((bits >> 23) & 0xff) - 127;
+    float m = fast_bits_to_float((bits & 0x007fffff) | 0x3f800000);
+    bool high = m > 1.41421356f;
+    m = high ? m * 0.5f : m;
+    e = high ? e + 1 : e;
+
+    // log(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.172
+    float s = (m - 1.0f) / (m + 1.0f);
+    float s2 = s * s;
+#if FAST_MATH_PRECISION == 1
+    float p = 2.0f * s * (1.0f + s2 * (3.3333334e-1f
+        + s2 * (2.0e-1f + s2 * (1.4285715e-1f + s2 * 1.1111111e-1f))));
+#else
+    float p = 2.0f * s * (1.0f + s2 * (3.3333334e-1f + s2 * 2.0e-1f));
+#endif
+
+    return e * 0.693147181f + p;
+#endif
+}
+
+/* Only defined for non-negative bases */
+HOST DEVICE inline float fast_pow(float x, float y) {
+#if FAST_MATH_PRECISION == 0
+    return std::pow(x, y);
+#else
+    float p = fast_exp(y * fast_log(x));
+    return (x == 0.0f) ? ((y == 0.0f) ? 1.0f : 0.0f) : p;
+#endif
+}
+
+HOST DEVICE inline float fast_tanh(float x) {
+#if FAST_MATH_PRECISION == 0
+    return std::tanh(x);
+#else
+    float ax = (x < 0.0f) ? -x : x;
+
+    // tanh(|x|) = (1 - e^-2|x|) / (1 + e^-2|x|)
+    float e = fast_exp(-2.0f * ax);
+    float t = (1.0f - e) / (1.0f + e);
+
+    // Taylor series near zero avoids cancellation in 1 - e
+    // Cancellation still costs ~7e-7 at 0.17, so the series (truncation
+    //   error ~4e-7 at 0.25) is used up to 0.25
+    float x2 = ax * ax;
+    float small = ax * (1.0f + x2 * (-3.3333334e-1f
+        + x2 * (1.3333334e-1f + x2 * -5.3968254e-2f)));
+    t = (ax < 0.25f) ? small : t;
+
+    return (x < 0.0f) ? -t : t;
+#endif
+}
+
+HOST DEVICE inline float fast_sigmoid(float x) {
+    return 1.0f / (1.0f + fast_exp(-x));
+}
+
+/* (e^x - 1) / x, continuous through x = 0
+ * Used by exponential integrators: x' = ax + b advances over a step h as
+ *   x += h * fast_exprel(a * h) * (a * x + b) */
+HOST DEVICE inline float fast_exprel(float x) {
+    float ax = (x < 0.0f) ? -x : x;
+    float r = (fast_exp(x) - 1.0f) / x;
+
+    // Taylor series near zero avoids cancellation in e^x - 1
+    float small = 1.0f + x * (0.5f + x * (1.6666667e-1f
+        + x * (4.1666668e-2f + x * 8.3333338e-3f)));
+    return (ax < 0.125f) ? small : r;
+}
+
+#endif
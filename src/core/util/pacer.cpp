@@ -0,0 +1,88 @@
+#include <ctime>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#include "util/pacer.h"
+#include "util/property_config.h"
+#include "util/logger.h"
+
+#define NS_PER_SEC 1000000000LL
+
+static inline int64_t monotonic_now() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static inline void sleep_until(int64_t time) {
+    timespec ts;
+    ts.tv_sec = time / NS_PER_SEC;
+    ts.tv_nsec = time % NS_PER_SEC;
+
+    // Resume after signals until the deadline is reached
+    // Other errors are not transient, so the caller spins instead
+    int error;
+    while ((error = clock_nanosleep(
+            CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) == EINTR);
+    if (error != 0)
+        LOG_WARNING(
+            "Pacer sleep failed: " + std::string(std::strerror(error)));
+}
+
+Pacer::Pacer() {
+    start(0.0);
+}
+
+void Pacer::start(float period, float spin) {
+    this->period = (int64_t)(period * NS_PER_SEC);
+    this->spin = std::max((int64_t)0, (int64_t)(spin * NS_PER_SEC));
+    this->deadline = monotonic_now() + this->period;
+
+    iterations = 0;
+    overruns = 0;
+    total_overrun = 0;
+    max_overrun = 0;
+    total_lateness = 0;
+    max_lateness = 0;
+}
+
+void Pacer::wait() {
+    ++iterations;
+    int64_t now = monotonic_now();
+
+    if (now > deadline) {
+        // Overrun: restart the schedule from now
+        int64_t overrun = now - deadline;
+        ++overruns;
+        total_overrun += overrun;
+        max_overrun = std::max(max_overrun, overrun);
+        deadline = now;
+    } else {
+        // Sleep through most of the wait, then spin to the deadline
+        if (deadline - now > spin)
+            sleep_until(deadline - spin);
+        do { now = monotonic_now(); } while (now < deadline);
+
+        int64_t lateness = now - deadline;
+        total_lateness += lateness;
+        max_lateness = std::max(max_lateness, lateness);
+    }
+
+    deadline += period;
+}
+
+void Pacer::report(PropertyConfig *report) const {
+    size_t on_time = iterations - overruns;
+
+    PropertyConfig pacing;
+    pacing.set("period", (float)period / NS_PER_SEC);
+    pacing.set("overruns", std::to_string(overruns));
+    pacing.set("max overrun", (float)max_overrun / NS_PER_SEC);
+    pacing.set("average overrun", (overruns == 0)
+        ? 0.0f : (float)total_overrun / overruns / NS_PER_SEC);
+    pacing.set("max lateness", (float)max_lateness / NS_PER_SEC);
+    pacing.set("average lateness", (on_time == 0)
+        ? 0.0f : (float)total_lateness / on_time / NS_PER_SEC);
+    report->set_child("pacing", &pacing);
+}
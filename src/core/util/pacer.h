@@ -0,0 +1,48 @@
+#ifndef pacer_h
+#define pacer_h
+
+#include <cstdint>
+
+class PropertyConfig;
+
+/* Pacer class.
+ * Paces iterations to a fixed period using absolute deadlines.
+ * Call start() with the period before the first iteration.
+ * Call wait() at the end of each iteration.
+ *
+ * Deadlines advance by exactly one period, so time spent in the iteration
+ *   and sleep latency do not accumulate as drift.  The thread sleeps with
+ *   clock_nanosleep until shortly before the deadline, then spins for the
+ *   remaining |spin| to absorb wakeup latency.
+ * An iteration that finishes after its deadline is an overrun.  Overruns
+ *   restart the schedule from the current time, rather than bursting
+ *   through the missed deadlines.
+ */
+class Pacer {
+    public:
+        Pacer();
+
+        /* Starts pacing with the given period and spin window (seconds) */
+        void start(float period, float spin=0.0001);
+
+        /* Waits for the next deadline */
+        void wait();
+
+        /* Adds overrun and wakeup lateness statistics to |report| */
+        void report(PropertyConfig *report) const;
+
+    private:
+        int64_t period;
+        int64_t spin;
+        int64_t deadline;
+
+        // Statistics (nanoseconds)
+        size_t iterations;
+        size_t overruns;
+        int64_t total_overrun;
+        int64_t max_overrun;
+        int64_t total_lateness;
+        int64_t max_lateness;
+};
+
+#endif
@@ -1,13 +1,32 @@
+#include <mutex>
+#include <vector>
+
 #include "util/parallel.h"
 #include "util/resources/pointer.h"
 
+/* Random states are shared by the engines in the process
+ * They are allocated for the largest layer of any open engine, and freed
+ *   when the last engine releases them */
+static std::mutex rand_mutex;
+static int rand_users = 0;
+static int rand_count = 0;
+
 void init_rand(int count) {
-    init_cuda_rand(count);
+    std::unique_lock<std::mutex> lock(rand_mutex);
+    ++rand_users;
+    if (count > rand_count) {
+        init_cuda_rand(count);
+        rand_count = count;
+    }
     init_openmp_rand();
 }
 
 void free_rand() {
-    free_cuda_rand();
+    std::unique_lock<std::mutex> lock(rand_mutex);
+    if (rand_users > 0 and --rand_users == 0) {
+        free_cuda_rand();
+        rand_count = 0;
+    }
 }
 
 #ifdef _OPENMP
@@ -110,16 +129,21 @@ GLOBAL void init_curand(int count){
         curand_init(clock64(), idx, 0, &cuda_rand_states[idx]);
 }
 
-void init_cuda_rand(int count) {
-    // Free existing random generators
-    free_cuda_rand();
+// States replaced by larger ones may still be in use by running engines,
+//   so they are kept until the random generators are freed
+static std::vector<std::pair<int, curandState_t*>> retired_rand_states;
 
+void init_cuda_rand(int count) {
     // Initialize CUDA random generators
     int prev_device;
     cudaGetDevice(&prev_device);
     for (int i = 0; i < get_num_cuda_devices(); ++i) {
         cudaSetDevice(i);
         curandState_t* states;
+        cudaMemcpyFromSymbol(&states, cuda_rand_states, sizeof(void *));
+        if (states != nullptr)
+            retired_rand_states.push_back({i, states});
+
         cudaMalloc((void**) &states, count * sizeof(curandState_t));
         cudaMemcpyToSymbol(cuda_rand_states, &states, sizeof(void *));
         init_curand<<<calc_blocks(count), calc_threads(count)>>>(count);
@@ -139,6 +163,11 @@ void free_cuda_rand() {
         states = nullptr;
         cudaMemcpyToSymbol(cuda_rand_states, &states, sizeof(void *));
     }
+    for (auto pair : retired_rand_states) {
+        cudaSetDevice(pair.first);
+        cudaFree(pair.second);
+    }
+    retired_rand_states.clear();
     cudaSetDevice(prev_device);
 }
 
@@ -0,0 +1,208 @@
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "util/perf_counters.h"
+#include "util/property_config.h"
+
+PerfCounts::PerfCounts() {
+    for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i) values[i] = 0;
+}
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+    for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i) values[i] += other.values[i];
+    return *this;
+}
+
+PerfCounts PerfCounts::operator-(const PerfCounts& other) const {
+    PerfCounts diff;
+    for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i)
+        diff.values[i] = values[i] - other.values[i];
+    return diff;
+}
+
+/******************************************************************************/
+/****************************** COUNTER GROUP *********************************/
+/******************************************************************************/
+
+static bool hardware_supported = false;
+
+#ifdef __linux__
+/* Counter group for one thread
+ * The task clock leads the group, and hardware counters are added to it
+ *   if they can be opened.  |slots| maps counters to positions in the
+ *   values read from the group (-1 if unavailable). */
+class CounterGroup {
+    public:
+        CounterGroup() : leader(-1), num_open(0) {
+            for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i) {
+                fds[i] = -1;
+                slots[i] = -1;
+            }
+
+            open(PERF_TASK_CLOCK,
+                PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK);
+            if (leader == -1) return;
+
+            open(PERF_CYCLES,
+                PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            open(PERF_INSTRUCTIONS,
+                PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            // Generic cache misses are last level misses on most CPUs
+            open(PERF_LLC_MISSES,
+                PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+            open(PERF_BRANCH_MISSES,
+                PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+            if (num_open > 1) hardware_supported = true;
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        virtual ~CounterGroup() {
+            for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i)
+                if (fds[i] != -1) close(fds[i]);
+        }
+
+        PerfCounts read() {
+            PerfCounts counts;
+            if (leader == -1) return counts;
+
+            // Group format: { nr, values[nr] }
+            uint64_t data[1 + PERF_NUM_COUNTERS];
+            if (::read(leader, data, sizeof(data)) <= 0) return counts;
+
+            for (int i = 0 ; i < PERF_NUM_COUNTERS ; ++i)
+                if (slots[i] != -1 and slots[i] < data[0])
+                    counts.values[i] = data[1 + slots[i]];
+            return counts;
+        }
+
+    private:
+        void open(PerfCounter counter, uint32_t type, uint64_t config) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = (leader == -1);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            int fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+            if (fd == -1) return;
+
+            if (leader == -1) leader = fd;
+            fds[counter] = fd;
+            slots[counter] = num_open++;
+        }
+
+        int leader;
+        int num_open;
+        int fds[PERF_NUM_COUNTERS];
+        int slots[PERF_NUM_COUNTERS];
+};
+#else
+class CounterGroup {
+    public:
+        PerfCounts read() { return PerfCounts(); }
+};
+#endif
+
+static CounterGroup& get_group() {
+    static thread_local CounterGroup group;
+    return group;
+}
+
+static thread_local PerfRegion *current_region = nullptr;
+
+/******************************************************************************/
+/****************************** PERF COUNTERS *********************************/
+/******************************************************************************/
+
+PerfCounts PerfCounters::read() {
+    return get_group().read();
+}
+
+PerfCounts PerfCounters::read_team() {
+#ifdef _OPENMP
+    // Team threads are pooled per calling thread, so the same threads are
+    //   summed before and after a computation
+    PerfCounts total;
+    #pragma omp parallel
+    {
+        PerfCounts counts = get_group().read();
+        #pragma omp critical
+        total += counts;
+    }
+    return total;
+#else
+    return read();
+#endif
+}
+
+bool PerfCounters::has_hardware() {
+    get_group();
+    return hardware_supported;
+}
+
+void PerfCounters::set_region(PerfRegion *region) {
+    current_region = region;
+}
+
+PerfRegion *PerfCounters::get_region() {
+    return current_region;
+}
+
+std::function<void()> PerfCounters::wrap(std::function<void()> f) {
+    PerfRegion *region = current_region;
+    if (region == nullptr) return f;
+
+    return [f, region]() {
+        PerfCounts start = PerfCounters::read_team();
+        f();
+        region->add(PerfCounters::read_team() - start);
+    };
+}
+
+/******************************************************************************/
+/******************************* PERF REGION **********************************/
+/******************************************************************************/
+
+void PerfRegion::add(const PerfCounts& counts) {
+    std::unique_lock<std::mutex> lock(mutex);
+    totals += counts;
+    ++samples;
+}
+
+void PerfRegion::report(PropertyConfig *report) {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    PropertyConfig entry;
+    entry.set("region", name);
+    entry.set("samples", std::to_string(samples));
+    entry.set("task clock", (float)totals.values[PERF_TASK_CLOCK] / 1e9f);
+
+    if (PerfCounters::has_hardware()) {
+        uint64_t cycles = totals.values[PERF_CYCLES];
+        uint64_t instructions = totals.values[PERF_INSTRUCTIONS];
+        entry.set("cycles", std::to_string(cycles));
+        entry.set("instructions", std::to_string(instructions));
+        entry.set("llc misses",
+            std::to_string(totals.values[PERF_LLC_MISSES]));
+        entry.set("branch misses",
+            std::to_string(totals.values[PERF_BRANCH_MISSES]));
+        entry.set("ipc", (cycles == 0) ? 0.0f : (float)instructions / cycles);
+    }
+    report->add_to_child_array("perf counters", &entry);
+}
@@ -0,0 +1,98 @@
+#ifndef perf_counters_h
+#define perf_counters_h
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+class PropertyConfig;
+
+/* Counter indices */
+enum PerfCounter {
+    PERF_TASK_CLOCK,
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NUM_COUNTERS
+};
+
+struct PerfCounts {
+    PerfCounts();
+
+    PerfCounts& operator+=(const PerfCounts& other);
+    PerfCounts operator-(const PerfCounts& other) const;
+
+    uint64_t values[PERF_NUM_COUNTERS];
+};
+
+/* Named region that aggregates counts from any thread */
+class PerfRegion {
+    public:
+        PerfRegion(std::string name) : name(name), samples(0) { }
+
+        void add(const PerfCounts& counts);
+
+        /* Adds a report entry to |report| under "perf counters" */
+        void report(PropertyConfig *report);
+
+        const std::string name;
+
+    protected:
+        std::mutex mutex;
+        PerfCounts totals;
+        size_t samples;
+};
+
+/* PerfCounters class.
+ * Per-thread hardware counters from Linux perf_event_open.
+ * Counters are opened lazily on each thread that reads them, and count
+ *   user space only, so they work with the default perf_event_paranoid.
+ * Counters that the kernel or hardware does not support (eg. in virtual
+ *   machines) are left at zero; the task clock is always available.
+ *
+ * Computations are attributed to the region that was current on the
+ *   thread that scheduled them (see Stream::schedule()), since they may be
+ *   executed later by a Scheduler worker thread.  Device computations only
+ *   count the host side of the kernel launch.
+ *
+ * Counters are per thread (inherit is incompatible with group reads, and
+ *   would miss pooled threads created before the counters were opened).
+ *   Kernels split their loops over the OpenMP team of the executing thread,
+ *   so computations are measured by summing the counters of every team
+ *   thread (see read_team()).  The sums include the cost of the two extra
+ *   parallel regions, and any time team threads spend actively waiting at
+ *   the end of each region (see OMP_WAIT_POLICY).
+ */
+class PerfCounters {
+    public:
+        /* Reads the calling thread's counters */
+        static PerfCounts read();
+
+        /* Sums the counters of the calling thread's OpenMP team */
+        static PerfCounts read_team();
+
+        /* Returns whether hardware counters are supported */
+        static bool has_hardware();
+
+        /* Sets the region for computations scheduled on this thread */
+        static void set_region(PerfRegion *region);
+        static PerfRegion *get_region();
+
+        /* Wraps |f| to count its execution toward the current region */
+        static std::function<void()> wrap(std::function<void()> f);
+};
+
+/* Sets the current region for the lifetime of the scope */
+class PerfScope {
+    public:
+        PerfScope(PerfRegion *region) : prev(PerfCounters::get_region())
+            { PerfCounters::set_region(region); }
+        ~PerfScope() { PerfCounters::set_region(prev); }
+
+    private:
+        PerfRegion *prev;
+};
+
+#endif
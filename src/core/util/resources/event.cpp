@@ -2,8 +2,9 @@
 #include "util/resources/scheduler.h"
 
 Event::Event(DeviceID device_id, bool host_flag)
-        : device_id(device_id), host_flag(host_flag) {
-    Scheduler::get_instance()->add(this);
+        : device_id(device_id), host_flag(host_flag),
+          scheduler(Scheduler::get_instance()) {
+    scheduler->add(this);
 #ifdef __CUDACC__
     if (not host_flag) {
         cudaSetDevice(device_id);
@@ -13,7 +14,7 @@ Event::Event(DeviceID device_id, bool host_flag)
 }
 
 Event::~Event() {
-    Scheduler::get_instance()->remove(this);
+    scheduler->remove(this);
 #ifdef __CUDACC__
     if (not host_flag) {
         cudaSetDevice(device_id);
@@ -21,3 +22,7 @@ Event::~Event() {
     }
 #endif
 }
+
+void Event::synchronize() {
+    scheduler->synchronize(this);
+}
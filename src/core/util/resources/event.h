@@ -4,6 +4,7 @@
 #include "util/parallel.h"
 
 class Stream;
+class Scheduler;
 
 class Event {
     public:
@@ -12,6 +13,10 @@ class Event {
 
         bool is_host() { return host_flag; }
         DeviceID get_device_id() { return device_id; }
+        Scheduler *get_scheduler() { return scheduler; }
+
+        /* Blocks the caller until the event is recorded */
+        void synchronize();
 
     protected:
         friend class Stream;
@@ -20,6 +25,9 @@ class Event {
         DeviceID device_id;
         bool host_flag;
 
+        // Scheduler bound to the creating thread (see SchedulerScope)
+        Scheduler *scheduler;
+
 #ifdef __CUDACC__
         cudaEvent_t cuda_event;
 #endif
@@ -154,7 +154,7 @@ class Pointer : public BasePointer {
                 and device_id == other.device_id;
         }
 
-        bool operator!=(const Pointer<T> &other) const { !(*this == other); }
+        bool operator!=(const Pointer<T> &other) const { return !(*this == other); }
 
 
         /*************************/
@@ -8,6 +8,7 @@
 #include "util/resources/stream.h"
 #include "util/resources/event.h"
 #include "util/resources/pointer.h"
+#include "util/resources/scheduler.h"
 
 Memstat::Memstat(DeviceID device_id, size_t free, size_t total,
     size_t used, size_t used_by_this)
@@ -57,6 +58,8 @@ PropertyConfig Memstat::to_config() {
 ResourceManager *ResourceManager::instance = nullptr;
 
 ResourceManager *ResourceManager::get_instance() {
+    static std::mutex instance_mutex;
+    std::unique_lock<std::mutex> lock(instance_mutex);
     if (ResourceManager::instance == nullptr) {
         // Take opportunity to seed random generator
         srand(time(nullptr));
@@ -105,6 +108,7 @@ void ResourceManager::flush_host() {
 }
 
 void ResourceManager::flush(DeviceID device_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     try {
         auto pointers = managed_pointers.at(device_id);
         if (is_host(device_id))
@@ -168,6 +172,7 @@ void* ResourceManager::allocate_host(size_t count, size_t size) {
             "Failed to allocate space on host for neuron state!");
 
     // Update bookkeeping
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     managed_pointers[get_host_id()][ptr] = count * size;
     pointer_counts[get_host_id()][ptr] = 0;
     this->memory_usage[get_host_id()] += count * size;
@@ -187,11 +192,14 @@ void* ResourceManager::allocate_host_pinned(size_t count, size_t size) {
             "Failed to allocate pinned space on host for neuron state!");
 
     // Update bookkeeping
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     managed_pointers[get_host_id()][ptr] = count * size;
     pointer_counts[get_host_id()][ptr] = 0;
     this->memory_usage[get_host_id()] += count * size;
 
     return ptr;
+#else
+    return allocate_host(count, size);
 #endif
 }
 
@@ -205,6 +213,7 @@ void* ResourceManager::allocate_device(size_t count, size_t size,
     void* ptr = cuda_allocate_device(device_id, count, size, source_data);
 
     // Update bookkeeping
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     managed_pointers[device_id][ptr] = count * size;
     pointer_counts[device_id][ptr] = 0;
     this->memory_usage[device_id] += count * size;
@@ -213,6 +222,7 @@ void* ResourceManager::allocate_device(size_t count, size_t size,
 }
 
 void ResourceManager::drop_pointer(void* ptr, DeviceID device_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     if (device_id >= get_num_devices())
         LOG_ERROR(
             "Attempted to drop pointer from non-existent device!");
@@ -236,10 +246,12 @@ void ResourceManager::drop_pointer(void* ptr, DeviceID device_id) {
 }
 
 void ResourceManager::increment_pointer_count(void* ptr, DeviceID device_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     pointer_counts[device_id][ptr] += 1;
 }
 
 void ResourceManager::decrement_pointer_count(void* ptr, DeviceID device_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     pointer_counts[device_id][ptr] -= 1;
 }
 
@@ -255,8 +267,10 @@ std::vector<PropertyConfig> ResourceManager::get_memory_usage(bool verbose) {
         } else {
             device_check_memory(id, &free, &total);
         }
+        std::unique_lock<std::recursive_mutex> lock(mutex);
         Memstat stat = Memstat(
             id, free, total, total-free, memory_usage[id]);
+        lock.unlock();
         if (verbose) stat.print();
         stats.push_back(stat.to_config());
     }
@@ -265,6 +279,7 @@ std::vector<PropertyConfig> ResourceManager::get_memory_usage(bool verbose) {
 
 BasePointer* ResourceManager::transfer(DeviceID device_id,
         std::vector<BasePointer*> ptrs) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     char* data = nullptr;
     size_t size = 0;
     for (auto ptr : ptrs)
@@ -300,13 +315,15 @@ Stream *ResourceManager::get_inter_device_stream(DeviceID device_id) {
         LOG_ERROR(
             "Attempted to retrieve inter-device stream"
             " for non-existent device!");
-    return devices[device_id]->inter_device_stream;
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return devices[device_id]->get_inter_device_stream();
 }
 
 Stream *ResourceManager::create_stream(DeviceID device_id) {
     if (device_id >= get_num_devices())
         LOG_ERROR(
             "Attempted to create stream on non-existent device!");
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     return devices[device_id]->create_stream();
 }
 
@@ -314,50 +331,81 @@ Event *ResourceManager::create_event(DeviceID device_id) {
     if (device_id >= get_num_devices())
         LOG_ERROR(
             "Attempted to create event on non-existent device!");
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     return devices[device_id]->create_event();
 }
 
 void ResourceManager::remove(Stream* stream) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     devices[stream->get_device_id()]->remove(stream);
     delete stream;
 }
 
 void ResourceManager::remove(Event* event) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
     devices[event->get_device_id()]->remove(event);
     delete event;
 }
 
-void ResourceManager::delete_streams() {
-    for (auto device : devices) device->delete_streams();
+void ResourceManager::delete_streams(Scheduler *scheduler) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (auto device : devices) device->delete_streams(scheduler);
 }
 
-void ResourceManager::delete_events() {
-    for (auto device : devices) device->delete_events();
+void ResourceManager::delete_events(Scheduler *scheduler) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    for (auto device : devices) device->delete_events(scheduler);
 }
 
 ResourceManager::Device::Device(DeviceID device_id, bool host_flag, bool solo)
         : device_id(device_id),
           host_flag(host_flag),
-          default_stream(new DefaultStream(device_id, host_flag)),
-          inter_device_stream((solo)
-              ? nullptr
-              : new Stream(device_id, host_flag)) { }
+          solo(solo),
+          default_stream(new DefaultStream(device_id, host_flag)) { }
 
 ResourceManager::Device::~Device() {
     delete default_stream;
-    if (inter_device_stream != nullptr) delete inter_device_stream;
     delete_streams();
     delete_events();
 }
 
-void ResourceManager::Device::delete_streams() {
-    for (auto stream : streams) delete stream;
-    streams.clear();
+void ResourceManager::Device::delete_streams(Scheduler *scheduler) {
+    std::vector<Stream*> kept;
+    for (auto stream : streams) {
+        if (scheduler == nullptr or stream->get_scheduler() == scheduler)
+            delete stream;
+        else
+            kept.push_back(stream);
+    }
+    streams = kept;
+
+    if (scheduler == nullptr) inter_device_streams.clear();
+    else inter_device_streams.erase(scheduler);
+}
+
+void ResourceManager::Device::delete_events(Scheduler *scheduler) {
+    std::vector<Event*> kept;
+    for (auto event : events) {
+        if (scheduler == nullptr or event->get_scheduler() == scheduler)
+            delete event;
+        else
+            kept.push_back(event);
+    }
+    events = kept;
 }
 
-void ResourceManager::Device::delete_events() {
-    for (auto event : events) delete event;
-    events.clear();
+Stream *ResourceManager::Device::get_inter_device_stream() {
+    if (solo) return nullptr;
+
+    // Transfers are serialized on one stream per scheduler, which is
+    //   deleted along with the scheduler's other streams
+    auto scheduler = Scheduler::get_instance();
+    auto it = inter_device_streams.find(scheduler);
+    if (it != inter_device_streams.end()) return it->second;
+
+    auto stream = create_stream();
+    inter_device_streams[scheduler] = stream;
+    return stream;
 }
 
 Stream *ResourceManager::Device::create_stream() {
@@ -2,6 +2,7 @@
 #define resource_manager_h
 
 #include <thread>
+#include <mutex>
 #include <vector>
 #include <set>
 #include <map>
@@ -28,6 +29,7 @@ class Memstat {
 
 
 class BasePointer;
+class Scheduler;
 
 class ResourceManager {
     public:
@@ -40,9 +42,11 @@ class ResourceManager {
         void flush_host();
         void flush(DeviceID device_id);
 
-        /* Delete resources */
-        void delete_streams();
-        void delete_events();
+        /* Delete resources
+         * If a scheduler is provided, only the streams and events it manages
+         *   are deleted (see SchedulerScope), leaving those of other engines */
+        void delete_streams(Scheduler *scheduler=nullptr);
+        void delete_events(Scheduler *scheduler=nullptr);
 
         /* Getters */
         unsigned int get_num_cores() { return num_cores; }
@@ -73,7 +77,8 @@ class ResourceManager {
         BasePointer* transfer(DeviceID device_id,
             std::vector<BasePointer*> ptrs);
 
-        /* Stream / event functions */
+        /* Stream / event functions
+         * Inter-device streams are created for each scheduler */
         Stream *get_default_stream(DeviceID id);
         Stream *get_inter_device_stream(DeviceID id);
         Stream *create_stream(DeviceID id);
@@ -92,23 +97,28 @@ class ResourceManager {
 
                 bool is_host() const { return host_flag; }
 
+                Stream *get_inter_device_stream();
                 Stream *create_stream();
                 Event *create_event();
                 void remove(Stream* stream);
                 void remove(Event* event);
 
-                void delete_streams();
-                void delete_events();
+                void delete_streams(Scheduler *scheduler=nullptr);
+                void delete_events(Scheduler *scheduler=nullptr);
 
                 const DeviceID device_id;
                 const bool host_flag;
+                const bool solo;
 
                 Stream* const default_stream;
-                Stream* const inter_device_stream;
+                std::map<Scheduler*, Stream*> inter_device_streams;
                 std::vector<Stream*> streams;
                 std::vector<Event*> events;
         };
 
+        // Engines may allocate and build concurrently
+        std::recursive_mutex mutex;
+
         int num_cores;
         std::vector<Device*> devices;
         std::set<DeviceID> device_ids;
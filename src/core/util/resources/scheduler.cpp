@@ -3,8 +3,14 @@
 #include "util/resources/scheduler.h"
 
 Scheduler *Scheduler::instance = 0;
+thread_local Scheduler *Scheduler::bound = nullptr;
 
 Scheduler* Scheduler::get_instance() {
+    if (Scheduler::bound != nullptr)
+        return Scheduler::bound;
+
+    static std::mutex instance_mutex;
+    std::unique_lock<std::mutex> lock(instance_mutex);
     if (Scheduler::instance == nullptr)
         Scheduler::instance = new Scheduler();
     return Scheduler::instance;
@@ -12,7 +18,8 @@ Scheduler* Scheduler::get_instance() {
 
 Scheduler::~Scheduler() {
     shutdown_thread_pool();
-    Scheduler::instance = nullptr;
+    if (Scheduler::instance == this)
+        Scheduler::instance = nullptr;
 }
 
 /******************************************************************************/
@@ -142,6 +149,10 @@ void Scheduler::wait_for_completion() {
             total_completed = 0;
             for (auto c : completed)
                 total_completed += c;
+
+            // Yield so that workers can progress (this also keeps the
+            //   compiler from treating the loop as side-effect free)
+            std::this_thread::yield();
         }
     }
 }
@@ -15,9 +15,19 @@
 
 class Scheduler {
     public:
-        static Scheduler *get_instance();
+        Scheduler()
+            : index(0),
+              pool_running(false),
+              dormant(false),
+              single_thread(true) { }
         virtual ~Scheduler();
 
+        /* Returns the scheduler bound to the calling thread (see
+         *   SchedulerScope), or the process default if none is bound
+         * Streams and events are managed by the scheduler returned here
+         *   when they are created */
+        static Scheduler *get_instance();
+
         /* Launches a thread pool
          *
          * If size is 0, the scheduler will immediately run operations
@@ -39,13 +49,10 @@ class Scheduler {
         void wait_for_completion();
 
     protected:
-        static Scheduler *instance;
+        friend class SchedulerScope;
 
-        Scheduler()
-            : index(0),
-              pool_running(false),
-              dormant(false),
-              single_thread(true) { }
+        static Scheduler *instance;
+        static thread_local Scheduler *bound;
 
         /* Worker functions */
         Stream* worker_get_stream(int id);
@@ -129,4 +136,19 @@ class Scheduler {
         void remove(Event *event);
 };
 
+/* Binds a scheduler to the calling thread for the lifetime of the object
+ * Engines bind their own scheduler while building and running, so that
+ *   several engines can run in one process with separate thread pools */
+class SchedulerScope {
+    public:
+        SchedulerScope(Scheduler *scheduler)
+                : prev(Scheduler::bound) {
+            Scheduler::bound = scheduler;
+        }
+        virtual ~SchedulerScope() { Scheduler::bound = prev; }
+
+    protected:
+        Scheduler *prev;
+};
+
 #endif
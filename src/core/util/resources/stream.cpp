@@ -2,10 +2,12 @@
 #include "util/resources/event.h"
 #include "util/resources/pointer.h"
 #include "util/resources/scheduler.h"
+#include "util/perf_counters.h"
 
 Stream::Stream(DeviceID device_id, bool host_flag)
-        : device_id(device_id), host_flag(host_flag) {
-    Scheduler::get_instance()->add(this);
+        : device_id(device_id), host_flag(host_flag),
+          scheduler(Scheduler::get_instance()) {
+    scheduler->add(this);
 #ifdef __CUDACC__
     // Device streams use CUDA streams
     if (not host_flag) {
@@ -18,7 +20,7 @@ Stream::Stream(DeviceID device_id, bool host_flag)
 }
 
 Stream::~Stream() {
-    Scheduler::get_instance()->remove(this);
+    scheduler->remove(this);
 #ifdef __CUDACC__
     if (not host_flag and cuda_stream != 0) {
         cudaSetDevice(device_id);
@@ -28,13 +30,15 @@ Stream::~Stream() {
 }
 
 void Stream::schedule(std::function<void()> f) {
-    Scheduler::get_instance()->enqueue_compute(this, f);
+    // Host computations are counted where they are executed
+    if (host_flag) f = PerfCounters::wrap(f);
+    scheduler->enqueue_compute(this, f);
 }
 
 void Stream::record(Event *event) {
-    Scheduler::get_instance()->enqueue_record(this, event);
+    scheduler->enqueue_record(this, event);
 }
 
 void Stream::wait(Event *event) {
-    Scheduler::get_instance()->enqueue_wait(this, event);
+    scheduler->enqueue_wait(this, event);
 }
@@ -6,6 +6,7 @@
 #include "util/parallel.h"
 
 class Event;
+class Scheduler;
 
 class Stream {
     public:
@@ -18,6 +19,7 @@ class Stream {
 
         bool is_host() { return host_flag; }
         DeviceID get_device_id() { return device_id; }
+        Scheduler *get_scheduler() { return scheduler; }
 
 #ifdef __CUDACC__
         cudaStream_t get_cuda_stream() { return cuda_stream; }
@@ -27,10 +29,13 @@ class Stream {
         friend class Event;
         friend class Scheduler;
 
-        Stream() { }
+        Stream() : scheduler(nullptr) { }
         DeviceID device_id;
         bool host_flag;
 
+        // Scheduler bound to the creating thread (see SchedulerScope)
+        Scheduler *scheduler;
+
 #ifdef __CUDACC__
         cudaStream_t cuda_stream;
 #endif
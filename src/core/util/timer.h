@@ -7,11 +7,11 @@
 // Timer namespaces
 using CClock = std::chrono::high_resolution_clock;
 using TimePoint = CClock::time_point;
-using std::chrono::milliseconds;
+using std::chrono::microseconds;
 using std::chrono::duration_cast;
 
 static inline float get_diff(TimePoint a, TimePoint b)
-    { return (float)duration_cast<milliseconds>(a - b).count() / 1000; }
+    { return (float)duration_cast<microseconds>(a - b).count() / 1000000; }
 
 /* Timer class.
  * Can be used to keep track of runtimes.
@@ -1,6 +1,8 @@
 #include "util/tools.h"
 
-float fSet(float* arr, int size, float val, float fraction) {
+thread_local std::mt19937 generator(std::random_device{}());
+
+void fSet(float* arr, int size, float val, float fraction) {
     if (fraction == 1.0) {
         _Pragma("omp parallel for")
         for (int i = 0 ; i < size ; ++i) arr[i] = val;
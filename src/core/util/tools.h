@@ -5,10 +5,12 @@
 #include <random>
 
 // Random number generator
-static std::mt19937 generator(std::random_device{}());
+// Each thread has its own generator, so engines running concurrently (and
+//   their worker threads) never share random state
+extern thread_local std::mt19937 generator;
 
 // Float array setter
-float fSet(float* arr, int size, float val, float fraction=1.0);
+void fSet(float* arr, int size, float val, float fraction=1.0);
 
 // Clears float array
 void fClear(float* arr, int size);
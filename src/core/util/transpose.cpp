@@ -1,9 +1,25 @@
+#include <algorithm>
+
 #include "util/transpose.h"
 #include "util/resources/pointer.h"
 
+#if not defined(__CUDA_ARCH__)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define TRANSPOSE_AVX
+#elif defined(__SSE__)
+#include <xmmintrin.h>
+#define TRANSPOSE_SSE
+#endif
+#endif
+
 const int TRANSPOSE_TILE_DIM = 32;
 const int TRANSPOSE_BLOCK_ROWS = 8;
 
+// Host tiles of 64x64 4-byte elements (16KB) fit comfortably in L1/L2
+const int TRANSPOSE_HOST_TILE_DIM = 64;
+const int TRANSPOSE_HOST_BLOCK_DIM = 8;
+
 template void transpose_matrix_in_place<float>(
     float* data, int original_rows, int original_cols, DeviceID device_id);
 template void transpose_matrix_in_place<int>(
@@ -21,6 +37,11 @@ template void transpose_matrix_out_of_place<int>(
     int* data, int* dest,
     int original_rows, int original_cols, DeviceID device_id);
 
+template void transpose_matrix_host<float>(
+    const float* data, float* dest, int original_rows, int original_cols);
+template void transpose_matrix_host<int>(
+    const int* data, int* dest, int original_rows, int original_cols);
+
 #ifdef __CUDACC__
 template GLOBAL void transpose_matrix_parallel<float>(
 	const Pointer<float> idata, Pointer<float> odata,
@@ -35,37 +56,200 @@ template GLOBAL void transpose_matrix_parallel<int>(
  *  transpose algorithm by Christian Ammer:
  * https://stackoverflow.com/questions/9227747/
  *     in-place-transposition-of-a-matrix
+ *
+ * Cycles are disjoint, so they are identified up front (using a bitmap of
+ *   visited indices) and then rotated in parallel.  The cycle leaders only
+ *   depend on the matrix dimensions, so they can be reused for several
+ *   matrices of the same shape.
  */
 
-template<class RandomIterator>
-static void transpose_in_place_impl(RandomIterator first, RandomIterator last,
-        long desired_rows) {
-    const long mn1 = (last - first - 1);
-    const long n   = (last - first) / desired_rows;
-    std::vector<bool> visited(last - first);
-    RandomIterator cycle = first;
-    while (++cycle != last) {
-        if (visited[cycle - first]) continue;
-        long a = cycle - first;
+static std::vector<long> find_transpose_cycles(long size, long original_rows) {
+    const long mn1 = size - 1;
+    std::vector<unsigned long long> visited((size + 63) / 64, 0);
+    std::vector<long> leaders;
+
+    for (long cycle = 1 ; cycle < mn1 ; ++cycle) {
+        if (visited[cycle / 64] & (1ULL << (cycle % 64))) continue;
+        leaders.push_back(cycle);
+
+        long a = cycle;
         do {
-            a = a == mn1 ? mn1 : (n * a) % mn1;
-            std::swap(*(first + a), *cycle);
-            visited[a] = true;
-        } while ((first + a) != cycle);
+            a = (original_rows * a) % mn1;
+            visited[a / 64] |= (1ULL << (a % 64));
+        } while (a != cycle);
+    }
+    return leaders;
+}
+
+template <typename T>
+static void transpose_cycles(T* data, long size, long original_rows,
+        const std::vector<long>& leaders) {
+    const long mn1 = size - 1;
+    const long num_leaders = leaders.size();
+
+    _Pragma("omp parallel for schedule(dynamic, 64)")
+    for (long l = 0 ; l < num_leaders ; ++l) {
+        const long cycle = leaders[l];
+        long a = cycle;
+        do {
+            a = (original_rows * a) % mn1;
+            std::swap(data[a], data[cycle]);
+        } while (a != cycle);
+    }
+}
+
+/* Square matrices are transposed by swapping pairs of tiles across the
+ *   diagonal, with each row of tiles handled by one thread */
+template <typename T>
+static void transpose_square_in_place(T* data, int dim) {
+    const int tile = TRANSPOSE_HOST_TILE_DIM;
+    const int num_tiles = (dim + tile - 1) / tile;
+
+    _Pragma("omp parallel for schedule(dynamic)")
+    for (int ti = 0 ; ti < num_tiles ; ++ti) {
+        const int row_end = std::min((ti + 1) * tile, dim);
+        for (int tj = ti ; tj < num_tiles ; ++tj) {
+            const int col_end = std::min((tj + 1) * tile, dim);
+            for (int i = ti * tile ; i < row_end ; ++i)
+                for (int j = std::max(tj * tile, i + 1) ; j < col_end ; ++j)
+                    std::swap(data[(long)i * dim + j], data[(long)j * dim + i]);
+        }
+    }
+}
+
+template <typename T>
+static void transpose_host_in_place(std::vector<T*> data,
+        int original_rows, int original_cols) {
+    if (original_rows == original_cols) {
+        for (auto ptr : data)
+            transpose_square_in_place(ptr, original_rows);
+    } else {
+        long size = (long)original_rows * original_cols;
+        auto leaders = find_transpose_cycles(size, original_rows);
+        for (auto ptr : data)
+            transpose_cycles(ptr, size, original_rows, leaders);
     }
 }
 
+/* Transposes an 8x8 block of 4-byte elements
+ * SIMD paths only move bits, so ints are safely handled as floats */
+template <typename T>
+static inline void transpose_block(const T* in, T* out,
+        long in_stride, long out_stride) {
+#if defined(TRANSPOSE_AVX)
+    static_assert(sizeof(T) == sizeof(float), "Unsupported transpose type!");
+    const float* fin = reinterpret_cast<const float*>(in);
+    float* fout = reinterpret_cast<float*>(out);
+
+    __m256 r0 = _mm256_loadu_ps(fin + 0 * in_stride);
+    __m256 r1 = _mm256_loadu_ps(fin + 1 * in_stride);
+    __m256 r2 = _mm256_loadu_ps(fin + 2 * in_stride);
+    __m256 r3 = _mm256_loadu_ps(fin + 3 * in_stride);
+    __m256 r4 = _mm256_loadu_ps(fin + 4 * in_stride);
+    __m256 r5 = _mm256_loadu_ps(fin + 5 * in_stride);
+    __m256 r6 = _mm256_loadu_ps(fin + 6 * in_stride);
+    __m256 r7 = _mm256_loadu_ps(fin + 7 * in_stride);
+
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1,0,1,0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3,2,3,2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1,0,1,0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3,2,3,2));
+    r4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1,0,1,0));
+    r5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3,2,3,2));
+    r6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1,0,1,0));
+    r7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3,2,3,2));
+
+    _mm256_storeu_ps(fout + 0 * out_stride, _mm256_permute2f128_ps(r0, r4, 0x20));
+    _mm256_storeu_ps(fout + 1 * out_stride, _mm256_permute2f128_ps(r1, r5, 0x20));
+    _mm256_storeu_ps(fout + 2 * out_stride, _mm256_permute2f128_ps(r2, r6, 0x20));
+    _mm256_storeu_ps(fout + 3 * out_stride, _mm256_permute2f128_ps(r3, r7, 0x20));
+    _mm256_storeu_ps(fout + 4 * out_stride, _mm256_permute2f128_ps(r0, r4, 0x31));
+    _mm256_storeu_ps(fout + 5 * out_stride, _mm256_permute2f128_ps(r1, r5, 0x31));
+    _mm256_storeu_ps(fout + 6 * out_stride, _mm256_permute2f128_ps(r2, r6, 0x31));
+    _mm256_storeu_ps(fout + 7 * out_stride, _mm256_permute2f128_ps(r3, r7, 0x31));
+#elif defined(TRANSPOSE_SSE)
+    static_assert(sizeof(T) == sizeof(float), "Unsupported transpose type!");
+    const float* fin = reinterpret_cast<const float*>(in);
+    float* fout = reinterpret_cast<float*>(out);
+
+    // Four 4x4 register transposes
+    for (int bi = 0 ; bi < 8 ; bi += 4) {
+        for (int bj = 0 ; bj < 8 ; bj += 4) {
+            __m128 r0 = _mm_loadu_ps(fin + (bi + 0) * in_stride + bj);
+            __m128 r1 = _mm_loadu_ps(fin + (bi + 1) * in_stride + bj);
+            __m128 r2 = _mm_loadu_ps(fin + (bi + 2) * in_stride + bj);
+            __m128 r3 = _mm_loadu_ps(fin + (bi + 3) * in_stride + bj);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(fout + (bj + 0) * out_stride + bi, r0);
+            _mm_storeu_ps(fout + (bj + 1) * out_stride + bi, r1);
+            _mm_storeu_ps(fout + (bj + 2) * out_stride + bi, r2);
+            _mm_storeu_ps(fout + (bj + 3) * out_stride + bi, r3);
+        }
+    }
+#else
+    for (int i = 0 ; i < TRANSPOSE_HOST_BLOCK_DIM ; ++i)
+        for (int j = 0 ; j < TRANSPOSE_HOST_BLOCK_DIM ; ++j)
+            out[j * out_stride + i] = in[i * in_stride + j];
+#endif
+}
+
+template <typename T>
+void transpose_matrix_host(const T* data, T* dest,
+        int original_rows, int original_cols) {
+    const int tile = TRANSPOSE_HOST_TILE_DIM;
+    const int block = TRANSPOSE_HOST_BLOCK_DIM;
+    const int row_tiles = (original_rows + tile - 1) / tile;
+    const int col_tiles = (original_cols + tile - 1) / tile;
+    const long rows = original_rows;
+    const long cols = original_cols;
+
+    _Pragma("omp parallel for schedule(static)")
+    for (int t = 0 ; t < row_tiles * col_tiles ; ++t) {
+        const int row_start = (t / col_tiles) * tile;
+        const int col_start = (t % col_tiles) * tile;
+        const int row_end = std::min(row_start + tile, original_rows);
+        const int col_end = std::min(col_start + tile, original_cols);
+
+        // Full blocks within the tile
+        const int row_block_end =
+            row_start + ((row_end - row_start) / block) * block;
+        const int col_block_end =
+            col_start + ((col_end - col_start) / block) * block;
+
+        for (int i = row_start ; i < row_block_end ; i += block)
+            for (int j = col_start ; j < col_block_end ; j += block)
+                transpose_block(data + i * cols + j, dest + j * rows + i,
+                    cols, rows);
+
+        // Ragged edges
+        for (int i = row_start ; i < row_end ; ++i)
+            for (int j = (i < row_block_end) ? col_block_end : col_start ;
+                    j < col_end ; ++j)
+                dest[j * rows + i] = data[i * cols + j];
+    }
+}
 
 template <typename T>
 void transpose_matrix_in_place(T* data,
         int original_rows, int original_cols, DeviceID device_id) {
     auto res_man = ResourceManager::get_instance();
-    int size = original_rows * original_cols;
 
     if (res_man->is_host(device_id)) {
-        transpose_in_place_impl(data, data + size, original_cols);
+        transpose_host_in_place(std::vector<T*>{ data },
+            original_rows, original_cols);
     } else {
 #ifdef __CUDACC__
+        int size = original_rows * original_cols;
+
         // Create temporary matrix
         Pointer<T> temp = Pointer<T>::device_pointer(
             device_id, size);
@@ -86,13 +270,13 @@ template <typename T>
 void transpose_matrices_in_place(std::vector<T*> data,
         int original_rows, int original_cols, DeviceID device_id) {
     auto res_man = ResourceManager::get_instance();
-    int size = original_rows * original_cols;
 
     if (res_man->is_host(device_id)) {
-        for (auto ptr : data)
-            transpose_in_place_impl(ptr, ptr + size, original_cols);
+        transpose_host_in_place(data, original_rows, original_cols);
     } else {
 #ifdef __CUDACC__
+        int size = original_rows * original_cols;
+
         // Create temporary matrix
         Pointer<T> temp = Pointer<T>::device_pointer(device_id, size);
 
@@ -117,10 +301,7 @@ void transpose_matrix_out_of_place(T* data, T* dest,
         int original_rows, int original_cols, DeviceID device_id) {
     auto res_man = ResourceManager::get_instance();
     if (res_man->is_host(device_id)) {
-        for (int row = 0 ; row < original_rows ; ++row)
-            for (int col = 0 ; col < original_cols ; ++col)
-                dest[col * original_rows + row]
-                    = data[row * original_cols + col];
+        transpose_matrix_host(data, dest, original_rows, original_cols);
     } else {
 #ifdef __CUDACC__
         dim3 dimGrid = calc_transpose_blocks(original_rows, original_cols);
@@ -22,6 +22,13 @@ template <typename T>
 void transpose_matrix_out_of_place(T* data, T* dest,
     int original_rows, int original_cols, DeviceID device_id);
 
+/* Transposes a host matrix out of place
+ * Works on cache-sized tiles split over OpenMP threads, and transposes
+ *   8x8 blocks in SIMD registers when available */
+template <typename T>
+void transpose_matrix_host(const T* data, T* dest,
+    int original_rows, int original_cols);
+
 
 dim3 calc_transpose_threads(int original_rows, int original_columns);
 dim3 calc_transpose_blocks(int original_rows, int original_columns);
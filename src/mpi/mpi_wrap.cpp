@@ -123,4 +123,15 @@ void mpi_wrap_irecv(int arr, int index, void *buf, int count, int source, int ta
         LOG_ERROR("Failed to call MPI_Irecv!");
 }
 
+void mpi_wrap_cancel(int arr, int index) {
+    MPI_Request* req = request_arrays[arr] + index;
+    if (*req == MPI_REQUEST_NULL) return;
+
+    // Cancelled (or already matched) requests must still be completed
+    if (MPI_SUCCESS != MPI_Cancel(req))
+        LOG_ERROR("Failed to call MPI_Cancel!");
+    if (MPI_SUCCESS != MPI_Wait(req, MPI_STATUS_IGNORE))
+        LOG_ERROR("Failed to call MPI_Wait!");
+}
+
 #endif
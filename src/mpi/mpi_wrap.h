@@ -21,6 +21,7 @@ void mpi_wrap_wait(void* req);
 int mpi_wrap_wait_any(int size, int arr);
 void mpi_wrap_recv(void *buf, int count, int source, int tag);
 void mpi_wrap_irecv(int arr, int index, void *buf, int count, int source, int tag);
+void mpi_wrap_cancel(int arr, int index);
 
 #else
 
@@ -42,6 +43,7 @@ inline void mpi_wrap_wait(void* req) { }
 inline int mpi_wrap_wait_any(int size, int arr) { return 0; }
 inline void mpi_wrap_recv(void *buf, int count, int source, int tag) { }
 inline void mpi_wrap_irecv(int arr, int index, void *buf, int count, int source, int tag) { }
+inline void mpi_wrap_cancel(int arr, int index) { }
 
 #endif
 